@@ -156,6 +156,50 @@ static const unsigned MaxColorTargets = 8;
 static const unsigned FetchShaderInternalBufferBinding = 5;
 static const unsigned MaxFetchShaderInternalBufferSize = 16 * MaxVertexAttribs;
 
+/// Represents one entry of the vertex attribute table read by the uber fetch shader.
+///
+/// When GraphicsPipelineBuildInfo::enableUberFetchShader is set, the vertex input state is not compiled into the
+/// vertex shader. Instead, the client provides a table of these entries, indexed by vertex input location, in the
+/// buffer described by the resource mapping node at (InternalDescriptorSetId, FetchShaderInternalBufferBinding). The
+/// stride of each binding is taken from the descriptor in the vertex buffer table, as for the normal fetch path, and
+/// an offset that is not less than the stride is handled by advancing the vertex buffer index.
+///
+/// bufferFormat is DWORD3 of a buffer descriptor: its destination swizzle and format fields are used, and the format
+/// field is the combined 7-bit format in bits [18:12] (NUM_FORMAT and DATA_FORMAT before GFX10, FORMAT on GFX10). The
+/// hardware has no 64-bit formats, so a 64-bit attribute is described by the 32-bit format with twice the components:
+/// 32_32 for R64, and 32_32_32_32 for R64G64, R64G64B64 and R64G64B64A64. For the latter two, the dwords after the
+/// first four are fetched with the same format from the next 16 bytes.
+///
+/// If the offset or the stride is not a multiple of the element size of the format (or the format is 8_8, 8_8_8_8,
+/// 16_16 or 16_16_16_16, which can not be fetched as a whole from an unaligned address), isPacked must be set, and
+/// the attribute is fetched one component at a time with componentFormat (the format of a single component, encoded
+/// as the format field of bufferFormat). componentCount and componentSize then describe the components in memory,
+/// counting dwords for 64-bit attributes, and isBgra requests swapping the first and third components, as the
+/// destination swizzle of bufferFormat is not applied to the component fetches.
+///
+/// Before GFX9, vertex fetches return the alpha channel of the signed 2_10_10_10 formats (SNORM, SSCALED and SINT) as
+/// unsigned. isSignedA2 must be set for an attribute of such a format, and the shader then fixes up the alpha channel
+/// according to the NUM_FORMAT field of bufferFormat. It is ignored on GFX9+.
+struct UberFetchShaderAttribInfo {
+  uint32_t binding : 8;         ///< Vertex buffer binding, i.e. index of the descriptor in the vertex buffer table
+  uint32_t perInstance : 1;     ///< Whether the attribute is indexed by instance rather than by vertex
+  uint32_t isPacked : 1;        ///< Whether the attribute is not aligned and is fetched one component at a time
+  uint32_t isBgra : 1;          ///< Whether the components of a packed attribute are in BGRA order
+  uint32_t componentCount : 4;  ///< Number of components of a packed attribute
+  uint32_t componentSize : 4;   ///< Byte size of each component of a packed attribute
+  uint32_t componentFormat : 7; ///< Format of each component of a packed attribute
+  uint32_t isSignedA2 : 1;      ///< Whether the format is a signed 2_10_10_10 format, whose alpha needs a fixup
+  uint32_t reserved : 5;        ///< Reserved bits, must be zero
+  uint32_t offset;              ///< Byte offset of the attribute in the vertex
+  uint32_t instanceDivisor;     ///< Number of instances that share one element of a per-instance attribute (0 means
+                                ///  all instances use the element of the base instance)
+  uint32_t bufferFormat;        ///< DWORD3 of a buffer descriptor encoding the format and destination swizzle of the
+                                ///  attribute; it replaces DWORD3 of the vertex buffer descriptor for the fetch
+};
+
+static_assert(sizeof(UberFetchShaderAttribInfo) * MaxVertexAttribs == MaxFetchShaderInternalBufferSize,
+              "Unexpected size of uber fetch shader attribute table");
+
 // Forward declarations
 class IShaderCache;
 class ICache;
@@ -445,6 +489,8 @@ struct ShaderModuleUsage {
   bool keepUnusedFunctions;    ///< Whether to keep unused function
   bool useIsNan;               ///< Whether IsNan is used
   bool useInvariant;           ///< Whether invariant variable is used
+  uint64_t inputLocationMask;  ///< Mask of generic input locations that may be read (all ones if unknown)
+  uint64_t outputLocationMask; ///< Mask of generic output locations that may be written (all ones if unknown)
 };
 
 /// Represents common part of shader module data
@@ -806,7 +852,8 @@ struct GraphicsPipelineBuildInfo {
   bool unlinked;            ///< True to build an "unlinked" half-pipeline ELF
   bool dynamicVertexStride; ///< Dynamic Vertex input Stride is enabled.
   bool enableUberFetchShader; ///< Use uber fetch shader
-  bool enableEarlyCompile;  ///< Whether enable early compile
+  bool enableEarlyCompile;  ///< Whether enable early compile. If set, each stage is built as a relocatable shader
+                            ///  ELF and cached, so the pipeline build only needs to link them once they are cached
 };
 
 /// Represents info to build a compute pipeline.
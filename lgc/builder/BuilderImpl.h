@@ -33,6 +33,9 @@
 #include "lgc/Builder.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/util/BuilderBase.h"
+#include "llvm/IR/ValueHandle.h"
+#include <map>
+#include <tuple>
 
 namespace lgc {
 
@@ -409,7 +412,11 @@ private:
   ImageBuilder &operator=(const ImageBuilder &) = delete;
 
   // Implement pre-GFX9 integer gather workaround to patch descriptor or coordinate before the gather
-  llvm::Value *preprocessIntegerImageGather(unsigned dim, llvm::Value *&imageDesc, llvm::Value *&coord);
+  llvm::Value *preprocessIntegerImageGather(unsigned dim, unsigned flags, llvm::Value *&imageDesc,
+                                            llvm::Value *&coord);
+
+  // Get the coordinate offset used by the pre-GFX9 integer gather workaround
+  llvm::Value *getIntegerGatherCoordOffset(unsigned dim, unsigned flags, llvm::Value *imageDesc);
 
   // Implement pre-GFX9 integer gather workaround to modify result.
   llvm::Value *postprocessIntegerImageGather(llvm::Value *needDescPatch, unsigned flags, llvm::Value *imageDesc,
@@ -448,6 +455,9 @@ private:
   // Fix image descriptor before an operation that reads the image
   llvm::Value *fixImageDescForRead(llvm::Value *imageDesc);
 
+  // Set the insert point to just after the definition of a descriptor, for a fixup of the descriptor
+  void setInsertPointAfterDesc(llvm::Value *desc);
+
   // Enforce readfirstlane on the image or sampler descriptors
   void enforceReadFirstLane(llvm::Instruction *imageInst, unsigned descIdx);
 
@@ -534,6 +544,7 @@ private:
 
   // Modify aux interp value according to custom interp mode, and its helper functions.
   llvm::Value *modifyAuxInterpValue(llvm::Value *auxInterpValue, InOutInfo inputInfo);
+  llvm::Value *evalIj(llvm::Value *auxInterpValue, InOutInfo inputInfo);
   llvm::Value *evalIjOffsetNoPersp(llvm::Value *offset);
   llvm::Value *evalIjOffsetSmooth(llvm::Value *offset);
   llvm::Value *adjustIj(llvm::Value *value, llvm::Value *offset);
@@ -570,6 +581,14 @@ private:
   // Determine whether a built-in is an output for a particular shader stage.
   bool isBuiltInOutput(BuiltInKind builtIn);
 #endif
+
+  // I/J values already evaluated for interpolation functions, so that inputs interpolated with the same mode and
+  // offset (or sample) in the same block share them. Keyed by {block, no-perspective, interp loc, aux interp value}.
+  struct EvaluatedIj {
+    llvm::WeakVH auxInterpValue; // Aux interp value the I/J were evaluated for (null if since deleted)
+    llvm::WeakVH ij;             // Evaluated I/J
+  };
+  std::map<std::tuple<llvm::BasicBlock *, unsigned, unsigned, llvm::Value *>, EvaluatedIj> m_evaluatedIjMap;
 };
 
 // =====================================================================================================================
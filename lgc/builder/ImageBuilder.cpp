@@ -835,7 +835,7 @@ Value *ImageBuilder::CreateImageGather(Type *resultTy, unsigned dim, unsigned fl
       gatherTy = StructType::get(getContext(), {gatherTy, getInt32Ty()});
 
     // For integer gather on pre-GFX9, patch descriptor or coordinate.
-    needDescPatch = preprocessIntegerImageGather(dim, imageDesc, coord);
+    needDescPatch = preprocessIntegerImageGather(dim, flags, imageDesc, coord);
   }
 
   // Only the first 4 dwords are sampler descriptor, we need to extract these values under any condition
@@ -899,7 +899,7 @@ Value *ImageBuilder::CreateImageGather(Type *resultTy, unsigned dim, unsigned fl
 // @param dim : Image dimension
 // @param [in/out] imageDesc : Image descriptor
 // @param [in/out] coord : Coordinate
-Value *ImageBuilder::preprocessIntegerImageGather(unsigned dim, Value *&imageDesc, Value *&coord) {
+Value *ImageBuilder::preprocessIntegerImageGather(unsigned dim, unsigned flags, Value *&imageDesc, Value *&coord) {
   if (getPipelineState()->getTargetInfo().getGfxIpVersion().major >= 9) {
     // GFX9+: Workaround not needed.
     return nullptr;
@@ -907,15 +907,7 @@ Value *ImageBuilder::preprocessIntegerImageGather(unsigned dim, Value *&imageDes
 
   if (dim != DimCube && dim != DimCubeArray) {
     // If not cube/cube array, just add (-0.5/width, -0.5/height) to the x,y coordinates
-    Value *zero = getInt32(0);
-    Value *resInfo =
-        CreateIntrinsic(ImageGetResInfoIntrinsicTable[dim], {FixedVectorType::get(getFloatTy(), 4), getInt32Ty()},
-                        {getInt32(15), zero, imageDesc, zero, zero});
-    resInfo = CreateBitCast(resInfo, FixedVectorType::get(getInt32Ty(), 4));
-
-    Value *widthHeight = CreateShuffleVector(resInfo, resInfo, ArrayRef<int>{0, 1});
-    widthHeight = CreateSIToFP(widthHeight, FixedVectorType::get(getFloatTy(), 2));
-    Value *valueToAdd = CreateFDiv(ConstantFP::get(widthHeight->getType(), -0.5), widthHeight);
+    Value *valueToAdd = getIntegerGatherCoordOffset(dim, flags, imageDesc);
     unsigned coordCount = cast<FixedVectorType>(coord->getType())->getNumElements();
     if (coordCount > 2) {
       valueToAdd = CreateShuffleVector(valueToAdd, Constant::getNullValue(valueToAdd->getType()),
@@ -927,36 +919,33 @@ Value *ImageBuilder::preprocessIntegerImageGather(unsigned dim, Value *&imageDes
   }
 
   // Check whether the descriptor needs patching. It does if it does not have format 32, 32_32 or 32_32_32_32.
-  Value *descDword1 = CreateExtractElement(imageDesc, 1);
-  Value *dataFormat = CreateIntrinsic(Intrinsic::amdgcn_ubfe, getInt32Ty(), {descDword1, getInt32(20), getInt32(6)});
-  Value *isDataFormat32 = CreateICmpEQ(dataFormat, getInt32(IMG_DATA_FORMAT_32));
-  Value *isDataFormat3232 = CreateICmpEQ(dataFormat, getInt32(IMG_DATA_FORMAT_32_32));
-  Value *isDataFormat32323232 = CreateICmpEQ(dataFormat, getInt32(IMG_DATA_FORMAT_32_32_32_32));
-  Value *cond = CreateOr(isDataFormat3232, isDataFormat32);
-  cond = CreateOr(isDataFormat32323232, cond);
-  Value *needDescPatch = CreateNot(cond);
-
-  // Create the if..else..endif, where the condition is whether the descriptor needs patching.
+  // This, and the patched descriptor, only depend on the descriptor, so compute them once where it is defined.
+  Value *needDescPatch = nullptr;
+  Value *patchedImageDesc = nullptr;
+  {
+    IRBuilderBase::InsertPointGuard guard(*this);
+    setInsertPointAfterDesc(imageDesc);
+    Value *descDword1 = CreateExtractElement(imageDesc, 1);
+    Value *dataFormat = CreateIntrinsic(Intrinsic::amdgcn_ubfe, getInt32Ty(), {descDword1, getInt32(20), getInt32(6)});
+    Value *isDataFormat32 = CreateICmpEQ(dataFormat, getInt32(IMG_DATA_FORMAT_32));
+    Value *isDataFormat3232 = CreateICmpEQ(dataFormat, getInt32(IMG_DATA_FORMAT_32_32));
+    Value *isDataFormat32323232 = CreateICmpEQ(dataFormat, getInt32(IMG_DATA_FORMAT_32_32_32_32));
+    Value *cond = CreateOr(isDataFormat3232, isDataFormat32);
+    cond = CreateOr(isDataFormat32323232, cond);
+    needDescPatch = CreateNot(cond);
+
+    // The patched descriptor changes NUM_FORMAT from SINT to SSCALE.
+    patchedImageDesc = CreateInsertElement(imageDesc, CreateSub(descDword1, getInt32(0x08000000)), 1);
+  }
+
+  // Create the if..else..endif, where the condition is whether the descriptor needs patching. The "then" uses the
+  // patched descriptor.
   InsertPoint savedInsertPoint = saveIP();
   BranchInst *branch = createIf(needDescPatch, true, "before.int.gather");
 
-  // Inside the "then": patch the descriptor: change NUM_FORMAT from SINT to SSCALE.
-  Value *descDword1A = CreateExtractElement(imageDesc, 1);
-  descDword1A = CreateSub(descDword1A, getInt32(0x08000000));
-  Value *patchedImageDesc = CreateInsertElement(imageDesc, descDword1A, 1);
-
   // On to the "else": patch the coordinates: add (-0.5/width, -0.5/height) to the x,y coordinates.
   SetInsertPoint(branch->getSuccessor(1)->getTerminator());
-  Value *zero = getInt32(0);
-  dim = dim == DimCubeArray ? DimCube : dim;
-  Value *resInfo =
-      CreateIntrinsic(ImageGetResInfoIntrinsicTable[dim], {FixedVectorType::get(getFloatTy(), 4), getInt32Ty()},
-                      {getInt32(15), zero, imageDesc, zero, zero});
-  resInfo = CreateBitCast(resInfo, FixedVectorType::get(getInt32Ty(), 4));
-
-  Value *widthHeight = CreateShuffleVector(resInfo, resInfo, ArrayRef<int>{0, 1});
-  widthHeight = CreateSIToFP(widthHeight, FixedVectorType::get(getFloatTy(), 2));
-  Value *valueToAdd = CreateFDiv(ConstantFP::get(widthHeight->getType(), -0.5), widthHeight);
+  Value *valueToAdd = getIntegerGatherCoordOffset(dim == DimCubeArray ? DimCube : dim, flags, imageDesc);
   unsigned coordCount = cast<FixedVectorType>(coord->getType())->getNumElements();
   if (coordCount > 2) {
     valueToAdd = CreateShuffleVector(valueToAdd, Constant::getNullValue(valueToAdd->getType()),
@@ -979,6 +968,32 @@ Value *ImageBuilder::preprocessIntegerImageGather(unsigned dim, Value *&imageDes
   return needDescPatch;
 }
 
+// =====================================================================================================================
+// Get the (-0.5/width, -0.5/height) offset that the pre-GFX9 integer gather workaround adds to the coordinate.
+//
+// The size query only depends on the descriptor, so for a uniform descriptor it is issued once just after the
+// descriptor is defined, where it is shared by all gathers from that image. A non-uniform descriptor keeps the query
+// at the gather, so as not to add a query (that needs its own waterfall loop) to paths that do not gather.
+//
+// @param dim : Image dimension
+// @param flags : Flags passed to CreateImageGather
+// @param imageDesc : Image descriptor
+Value *ImageBuilder::getIntegerGatherCoordOffset(unsigned dim, unsigned flags, Value *imageDesc) {
+  IRBuilderBase::InsertPointGuard guard(*this);
+  if ((flags & ImageFlagNonUniformImage) == 0)
+    setInsertPointAfterDesc(imageDesc);
+
+  Value *zero = getInt32(0);
+  Value *resInfo =
+      CreateIntrinsic(ImageGetResInfoIntrinsicTable[dim], {FixedVectorType::get(getFloatTy(), 4), getInt32Ty()},
+                      {getInt32(15), zero, imageDesc, zero, zero});
+  resInfo = CreateBitCast(resInfo, FixedVectorType::get(getInt32Ty(), 4));
+
+  Value *widthHeight = CreateShuffleVector(resInfo, resInfo, ArrayRef<int>{0, 1});
+  widthHeight = CreateSIToFP(widthHeight, FixedVectorType::get(getFloatTy(), 2));
+  return CreateFDiv(ConstantFP::get(widthHeight->getType(), -0.5), widthHeight);
+}
+
 // =====================================================================================================================
 // Implement pre-GFX9 integer gather workaround to modify result.
 // Returns possibly modified result.
@@ -1853,6 +1868,9 @@ Value *ImageBuilder::patchCubeDescriptor(Value *desc, unsigned dim) {
   if ((dim != DimCube && dim != DimCubeArray) || getPipelineState()->getTargetInfo().getGfxIpVersion().major >= 9)
     return desc;
 
+  IRBuilderBase::InsertPointGuard guard(*this);
+  setInsertPointAfterDesc(desc);
+
   // Extract the depth.
   Value *elem4 = CreateExtractElement(desc, 4);
   Value *depth = CreateAnd(elem4, getInt32(0x1FFF));
@@ -1973,6 +1991,8 @@ Value *ImageBuilder::fixImageDescForRead(Value *imageDesc) {
     if (cast<FixedVectorType>(imageDesc->getType())->getNumElements() == 8) {
       // Need to clear the write_compress_enable bit, which is bit 212, or bit 20 of dword 6.
       // I am hard-coding it here as it is only needed on a limited range of chips.
+      IRBuilderBase::InsertPointGuard guard(*this);
+      setInsertPointAfterDesc(imageDesc);
       Value *dword6 = CreateExtractElement(imageDesc, 6);
       dword6 = CreateAnd(dword6, getInt32(0xFFEFFFFF));
       imageDesc = CreateInsertElement(imageDesc, dword6, 6);
@@ -1981,6 +2001,24 @@ Value *ImageBuilder::fixImageDescForRead(Value *imageDesc) {
   return imageDesc;
 }
 
+// =====================================================================================================================
+// Set the insert point to just after the definition of a descriptor. A fixup that depends only on the descriptor is
+// created there, so that it dominates every image operation using the descriptor, and the copies created for those
+// operations are merged by CSE into one. The fixup is lane-wise, so this is also valid for a non-uniform descriptor,
+// whose waterfall loop is built around the image operation later.
+//
+// @param desc : Descriptor
+void ImageBuilder::setInsertPointAfterDesc(Value *desc) {
+  if (auto inst = dyn_cast<Instruction>(desc)) {
+    if (isa<PHINode>(inst))
+      SetInsertPoint(&*inst->getParent()->getFirstInsertionPt());
+    else
+      SetInsertPoint(inst->getNextNode());
+  } else if (isa<Argument>(desc)) {
+    SetInsertPoint(&*GetInsertBlock()->getParent()->getEntryBlock().getFirstInsertionPt());
+  }
+}
+
 // =====================================================================================================================
 // Enforce readfirstlane on the given descriptor.
 //
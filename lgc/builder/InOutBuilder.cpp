@@ -591,42 +591,85 @@ void InOutBuilder::markFsOutputType(Type *outputTy, unsigned location, InOutInfo
 // @param auxInterpValue : Aux interp value from CreateReadInput (ignored for centroid location)
 // @param inputInfo : InOutInfo containing interp mode and location
 Value *InOutBuilder::modifyAuxInterpValue(Value *auxInterpValue, InOutInfo inputInfo) {
-  if (inputInfo.getInterpLoc() != InOutInfo::InterpLocExplicit) {
-    // Add intrinsic to calculate I/J for interpolation function
-    std::string evalInstName;
-    auto resUsage = getPipelineState()->getShaderResourceUsage(ShaderStageFragment);
-
-    if (inputInfo.getInterpLoc() == InOutInfo::InterpLocCentroid) {
-      Value *evalArg = nullptr;
-
-      evalInstName = lgcName::InputImportBuiltIn;
-      if (inputInfo.getInterpMode() == InOutInfo::InterpModeNoPersp) {
-        evalInstName += "InterpLinearCentroid";
-        evalArg = getInt32(BuiltInInterpLinearCentroid);
-        resUsage->builtInUsage.fs.noperspective = true;
-        resUsage->builtInUsage.fs.centroid = true;
-      } else {
-        evalInstName += "InterpPerspCentroid";
-        evalArg = getInt32(BuiltInInterpPerspCentroid);
-        resUsage->builtInUsage.fs.smooth = true;
-        resUsage->builtInUsage.fs.centroid = true;
-      }
+  if (inputInfo.getInterpLoc() == InOutInfo::InterpLocExplicit) {
+    assert(inputInfo.getInterpMode() == InOutInfo::InterpModeCustom);
+    return auxInterpValue;
+  }
+
+  // Reuse the I,J already evaluated for the same interp mode and offset (or sample) earlier in this block, so that
+  // interpolating many inputs with them does not repeat the derivatives and the reciprocal for each input.
+  BasicBlock *block = GetInsertBlock();
+  // Smooth and flat inputs are interpolated with the same (perspective) I,J.
+  const bool isNoPersp = inputInfo.getInterpMode() == InOutInfo::InterpModeNoPersp;
+  auto key = std::make_tuple(block, unsigned(isNoPersp), unsigned(inputInfo.getInterpLoc()), auxInterpValue);
+  auto evaluatedIjIt = m_evaluatedIjMap.find(key);
+  if (evaluatedIjIt != m_evaluatedIjMap.end() && evaluatedIjIt->second.auxInterpValue == auxInterpValue) {
+    auto ij = dyn_cast_or_null<Instruction>(evaluatedIjIt->second.ij);
+    if (ij && ij->getParent() == block && (GetInsertPoint() == block->end() || ij->comesBefore(&*GetInsertPoint())))
+      return ij;
+  }
+
+  Value *ij = evalIj(auxInterpValue, inputInfo);
+  m_evaluatedIjMap[key] = {auxInterpValue, ij};
+  return ij;
+}
+
+// =====================================================================================================================
+// Check whether a value is the sample ID of the current fragment shader invocation (gl_SampleID).
+//
+// @param value : Value to check
+static bool isCurrentSampleId(Value *value) {
+  auto call = dyn_cast_or_null<CallInst>(value);
+  if (!call || !call->getCalledFunction() ||
+      !call->getCalledFunction()->getName().startswith(lgcName::InputImportBuiltIn))
+    return false;
+  auto builtInId = dyn_cast<ConstantInt>(call->getArgOperand(0));
+  return builtInId && builtInId->getZExtValue() == BuiltInSampleId;
+}
 
-      auxInterpValue = emitCall(evalInstName, FixedVectorType::get(getFloatTy(), 2), {evalArg}, Attribute::ReadOnly,
-                                &*GetInsertPoint());
+// =====================================================================================================================
+// Evaluate I,J for an interpolation function
+//
+// @param auxInterpValue : Aux interp value from CreateReadInput (ignored for centroid location)
+// @param inputInfo : InOutInfo containing interp mode and location
+Value *InOutBuilder::evalIj(Value *auxInterpValue, InOutInfo inputInfo) {
+  std::string evalInstName;
+  auto resUsage = getPipelineState()->getShaderResourceUsage(ShaderStageFragment);
+
+  // Reading gl_SampleID makes the fragment shader run at sample rate, so interpolating at the current sample can use
+  // the I,J the hardware provides for the iterated sample rather than adjusting the center ones by its offset.
+  const bool useHwSampleIj =
+      inputInfo.getInterpLoc() == InOutInfo::InterpLocSample && isCurrentSampleId(auxInterpValue);
+
+  if (inputInfo.getInterpLoc() == InOutInfo::InterpLocCentroid || useHwSampleIj) {
+    Value *evalArg = nullptr;
+    const bool isCentroid = inputInfo.getInterpLoc() == InOutInfo::InterpLocCentroid;
+
+    evalInstName = lgcName::InputImportBuiltIn;
+    if (inputInfo.getInterpMode() == InOutInfo::InterpModeNoPersp) {
+      evalInstName += isCentroid ? "InterpLinearCentroid" : "InterpLinearSample";
+      evalArg = getInt32(isCentroid ? BuiltInInterpLinearCentroid : BuiltInInterpLinearSample);
+      resUsage->builtInUsage.fs.noperspective = true;
     } else {
-      // Generate code to evaluate the I,J coordinates.
-      if (inputInfo.getInterpLoc() == InOutInfo::InterpLocSample)
-        auxInterpValue = readBuiltIn(false, BuiltInSamplePosOffset, {}, auxInterpValue, nullptr, "");
-      if (inputInfo.getInterpMode() == InOutInfo::InterpModeNoPersp)
-        auxInterpValue = evalIjOffsetNoPersp(auxInterpValue);
-      else
-        auxInterpValue = evalIjOffsetSmooth(auxInterpValue);
+      evalInstName += isCentroid ? "InterpPerspCentroid" : "InterpPerspSample";
+      evalArg = getInt32(isCentroid ? BuiltInInterpPerspCentroid : BuiltInInterpPerspSample);
+      resUsage->builtInUsage.fs.smooth = true;
     }
-  } else {
-    assert(inputInfo.getInterpMode() == InOutInfo::InterpModeCustom);
+    if (isCentroid)
+      resUsage->builtInUsage.fs.centroid = true;
+    else
+      resUsage->builtInUsage.fs.sample = true;
+
+    return emitCall(evalInstName, FixedVectorType::get(getFloatTy(), 2), {evalArg}, Attribute::ReadOnly,
+                    &*GetInsertPoint());
   }
-  return auxInterpValue;
+
+  // Generate code to evaluate the I,J coordinates.
+  if (inputInfo.getInterpLoc() == InOutInfo::InterpLocSample)
+    auxInterpValue = readBuiltIn(false, BuiltInSamplePosOffset, {}, auxInterpValue, nullptr, "");
+  if (inputInfo.getInterpMode() == InOutInfo::InterpModeNoPersp)
+    return evalIjOffsetNoPersp(auxInterpValue);
+  return evalIjOffsetSmooth(auxInterpValue);
 }
 
 // =====================================================================================================================
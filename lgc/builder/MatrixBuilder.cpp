@@ -683,6 +683,13 @@ void MatrixBuilder::calcCooperativeMatrixInfo(CooperativeMatrixInfo &coopMatInfo
 // =====================================================================================================================
 // Load or store a contiguous elements from the specified location of the memory.
 //
+// Lanes 0-15 hold the 16 rows (or columns) of the matrix, and the other lanes hold copies of them. Rather than have
+// every copy repeat the same access, a row is split into parts that are accessed by different copies:
+// - A store needs no data exchange, so each of the waveSize / 16 copies of a row stores its own part of it.
+// - A load is split between the two 16-lane halves of each 32-lane row of the wave, which then swap their parts with
+//   v_permlanex16 (GFX10+). Lanes 32-63 of a wave64 still repeat the loads of lanes 0-31, as exchanging data across
+//   the two halves of a wave64 is not available.
+//
 // @param dataPtr : The pointer to a data array.
 // @param stride : The number of elements in the array in memory between the first component of consecutive rows (or
 // columns) in the result.
@@ -691,12 +698,21 @@ void MatrixBuilder::calcCooperativeMatrixInfo(CooperativeMatrixInfo &coopMatInfo
 void MatrixBuilder::doMemoryAccess(Value *dataPtr, Value *stride, Value *alignment, Value *&vecVal) {
   assert(isa<GetElementPtrInst>(dataPtr));
   auto getElemPtrInst = dyn_cast<GetElementPtrInst>(dataPtr);
+  const bool isStore = vecVal != nullptr;
 
   // Lanes 0-15 data is replicated into lanes 16-31 (for wave64: also lanes 32-47 into 48-63).
-  Value *threadId = CreateGetLaneNumber();
+  Value *laneId = CreateGetLaneNumber();
   constexpr unsigned numOfData = 16;
-  threadId =
-      CreateSelect(CreateICmpULT(threadId, getInt32(numOfData)), threadId, CreateSMod(threadId, getInt32(numOfData)));
+  Value *threadId = CreateAnd(laneId, getInt32(numOfData - 1));
+
+  // Decide how many parts a row is split into, and which part this lane accesses.
+  unsigned partCount = 1;
+  if (isStore)
+    partCount = getPipelineState()->getShaderWaveSize(m_shaderStage) / numOfData;
+  else if (supportPermLaneDpp())
+    partCount = 2;
+  const unsigned partSize = numOfData / partCount;
+  Value *partIdx = CreateAnd(CreateLShr(laneId, getInt32(4)), getInt32(partCount - 1));
 
   // The elements stored (or loaded) into (or from) LDS (or buffer) in order to contiguous locations starting at
   // dataPtr[element + threadId * stride].
@@ -708,6 +724,8 @@ void MatrixBuilder::doMemoryAccess(Value *dataPtr, Value *stride, Value *alignme
   Value *elemOffset = *(getElemPtrInst->idx_begin() + elemIdx);
   elemOffset = CreateTrunc(elemOffset, getInt32Ty());
   startLoc = CreateAdd(startLoc, elemOffset);
+  if (partCount > 1)
+    startLoc = CreateAdd(startLoc, CreateMul(partIdx, getInt32(partSize)));
 
   // Calculate the alignment for the store or load operation.
   assert(isa<ConstantInt>(alignment));
@@ -720,13 +738,61 @@ void MatrixBuilder::doMemoryAccess(Value *dataPtr, Value *stride, Value *alignme
   }
 
   // Calculate the pointer to store/load the contiguous elements as a vector
+  Type *elemTy = dataPtr->getType()->getPointerElementType();
   Value *basePtr = getElemPtrInst->getPointerOperand();
   Value *vecPtr = CreateGEP(basePtr->getType()->getPointerElementType(), basePtr,
                             ArrayRef<Value *>{getInt32(0), getInt32(0), startLoc});
-  Type *vecTy = FixedVectorType::get(dataPtr->getType()->getPointerElementType(), numOfData);
+  Type *vecTy = FixedVectorType::get(elemTy, partSize);
   vecPtr = CreateBitCast(vecPtr, PointerType::get(vecTy, cast<PointerType>(vecPtr->getType())->getAddressSpace()));
-  if (vecVal)
-    CreateAlignedStore(vecVal, vecPtr, Align(align * numOfData));
-  else
-    vecVal = CreateAlignedLoad(vecTy, vecPtr, Align(align * numOfData));
+
+  if (isStore) {
+    // Select the part of the row that this lane stores.
+    Value *partVal = vecVal;
+    if (partCount > 1) {
+      SmallVector<int, numOfData> partMask;
+      for (unsigned part = 0; part < partCount; ++part) {
+        partMask.clear();
+        for (unsigned idx = 0; idx < partSize; ++idx)
+          partMask.push_back(part * partSize + idx);
+        Value *partOfRow = CreateShuffleVector(vecVal, vecVal, partMask);
+        partVal = part == 0 ? partOfRow : CreateSelect(CreateICmpEQ(partIdx, getInt32(part)), partOfRow, partVal);
+      }
+    }
+    CreateAlignedStore(partVal, vecPtr, Align(align * partSize));
+    return;
+  }
+
+  Value *loadVal = CreateAlignedLoad(vecTy, vecPtr, Align(align * partSize));
+  if (partCount == 1) {
+    vecVal = loadVal;
+    return;
+  }
+
+  // Swap the loaded halves between lanes N and N ^ 16, one dword at a time.
+  auto mapFunc = [](BuilderBase &builder, ArrayRef<Value *> mappedArgs, ArrayRef<Value *> passthroughArgs) -> Value * {
+    Module *const module = builder.GetInsertBlock()->getModule();
+
+    Type *const int1Ty = builder.getInt1Ty();
+    Type *const int32Ty = builder.getInt32Ty();
+
+    FunctionCallee function = module->getOrInsertFunction("llvm.amdgcn.permlanex16", int32Ty, int32Ty, int32Ty, int32Ty,
+                                                          int32Ty, int1Ty, int1Ty);
+    return builder.CreateCall(function, {mappedArgs[0], mappedArgs[1], passthroughArgs[0], passthroughArgs[1],
+                                         passthroughArgs[2], passthroughArgs[3]});
+  };
+
+  const unsigned dwordCount = partSize * elemTy->getScalarSizeInBits() / 32;
+  Type *dwordsTy = FixedVectorType::get(getInt32Ty(), dwordCount);
+  Value *ownPart = CreateBitCast(loadVal, dwordsTy);
+  Value *otherPart = CreateMapToInt32(mapFunc, {ownPart, ownPart},
+                                      {getInt32(0x76543210), getInt32(0xFEDCBA98), getInt1(false), getInt1(false)});
+  otherPart = CreateBitCast(otherPart, vecTy);
+
+  Value *isUpperHalf = CreateICmpNE(partIdx, getInt32(0));
+  Value *lowerPart = CreateSelect(isUpperHalf, otherPart, loadVal);
+  Value *upperPart = CreateSelect(isUpperHalf, loadVal, otherPart);
+  SmallVector<int, numOfData> rowMask;
+  for (unsigned idx = 0; idx < numOfData; ++idx)
+    rowMask.push_back(idx);
+  vecVal = CreateShuffleVector(lowerPart, upperPart, rowMask);
 }
@@ -195,6 +195,33 @@ Value *YCbCrConverter::reconstructLinearXYChromaSample(XYChromaSampleInfo &xyChr
                                    ConstantFP::get(m_builder->getFloatTy(), 0.75));
   }
 
+  if (canGatherChroma() && (xyChromaInfo.planeCount == 2 || xyChromaInfo.planeCount == 3)) {
+    // A gather returns one channel of the 2x2 texel footprint around its coordinate, in the order BL, BR, TR, TL.
+    // Placing the coordinate on the corner shared by the four chroma texels selects exactly the TL/TR/BL/BR texels
+    // that would otherwise be point sampled one at a time, so one gather per output channel replaces four samples.
+    SmallVector<Value *, 4> coordsChroma;
+    coordsChroma.push_back(
+        m_builder->CreateFDiv(m_builder->CreateFAdd(subCoordI, ConstantFP::get(m_builder->getFloatTy(), 1.0)), width));
+    coordsChroma.push_back(
+        m_builder->CreateFDiv(m_builder->CreateFAdd(subCoordJ, ConstantFP::get(m_builder->getFloatTy(), 1.0)), height));
+
+    // Gather the same channels the sample path below keeps: channels 0 and 2 of the interleaved chroma plane, or
+    // channel 0 of the second chroma plane and channel 2 of the first one.
+    Value *imageDescFirst = xyChromaInfo.planeCount == 2 ? xyChromaInfo.imageDesc1 : xyChromaInfo.imageDesc2;
+    sampleInfo->imageDesc = imageDescFirst;
+    Value *gatherFirst = createImageGatherInternal(coordsChroma, 0, sampleInfo);
+    sampleInfo->imageDesc = xyChromaInfo.imageDesc1;
+    Value *gatherSecond = createImageGatherInternal(coordsChroma, 2, sampleInfo);
+
+    Value *coordTL = m_builder->CreateShuffleVector(gatherFirst, gatherSecond, ArrayRef<int>{3, 7});
+    Value *coordTR = m_builder->CreateShuffleVector(gatherFirst, gatherSecond, ArrayRef<int>{2, 6});
+    Value *coordBL = m_builder->CreateShuffleVector(gatherFirst, gatherSecond, ArrayRef<int>{0, 4});
+    Value *coordBR = m_builder->CreateShuffleVector(gatherFirst, gatherSecond, ArrayRef<int>{1, 5});
+
+    // Linear interpolate
+    return bilinearBlend(alpha, beta, coordTL, coordTR, coordBL, coordBR);
+  }
+
   SmallVector<Value *, 4> coordsChromaTL;
   SmallVector<Value *, 4> coordsChromaTR;
   SmallVector<Value *, 4> coordsChromaBL;
@@ -302,6 +329,47 @@ Value *YCbCrConverter::createImageSampleInternal(SmallVectorImpl<Value *> &coord
                                             ycbcrInfo->instNameStr, ycbcrInfo->isSample);
 }
 
+// =====================================================================================================================
+// Create YCbCr image gather internal
+//
+// @param coords : The ST coordinates
+// @param component : The channel to gather
+// @param ycbcrInfo : YCbCr sample information
+Value *YCbCrConverter::createImageGatherInternal(SmallVectorImpl<Value *> &coordsIn, unsigned component,
+                                                 YCbCrSampleInfo *ycbcrInfo) {
+  unsigned imageDim = ycbcrInfo->dim;
+
+  Value *coords = UndefValue::get(FixedVectorType::get(coordsIn[0]->getType(), m_builder->getImageNumCoords(imageDim)));
+  coords = m_builder->CreateInsertElement(coords, coordsIn[0], uint64_t(0));
+  coords = m_builder->CreateInsertElement(coords, coordsIn[1], uint64_t(1));
+
+  if (imageDim == Builder::Dim2DArray)
+    coords = m_builder->CreateInsertElement(coords, m_coordZ, uint64_t(2));
+
+  SmallVector<Value *, Builder::ImageAddressCount> address(ycbcrInfo->address.begin(), ycbcrInfo->address.end());
+  address[Builder::ImageAddressIdxComponent] = m_builder->getInt32(component);
+
+  return m_builder->CreateImageSampleGather(ycbcrInfo->resultTy, ycbcrInfo->dim, ycbcrInfo->flags, coords,
+                                            ycbcrInfo->imageDesc, ycbcrInfo->samplerDesc, address,
+                                            ycbcrInfo->instNameStr, false);
+}
+
+// =====================================================================================================================
+// Check whether neighbouring chroma texels for explicit reconstruction can be fetched with image gathers. A gather
+// ignores the sampler filter and has no derivative form, so it matches the individual samples only when the chroma
+// sampler is point filtered and the sample uses no explicit gradients or depth compare.
+bool YCbCrConverter::canGatherChroma() const {
+  if (!m_metaData.word0.forceExplicitReconstruct)
+    return false;
+
+  if (m_ycbcrSampleInfo->dim != Builder::Dim2D && m_ycbcrSampleInfo->dim != Builder::Dim2DArray)
+    return false;
+
+  ArrayRef<Value *> address = m_ycbcrSampleInfo->address;
+  return !address[Builder::ImageAddressIdxDerivativeX] && !address[Builder::ImageAddressIdxDerivativeY] &&
+         !address[Builder::ImageAddressIdxZCompare];
+}
+
 // =====================================================================================================================
 // YCbCrConverter
 //
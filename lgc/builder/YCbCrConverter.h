@@ -283,6 +283,13 @@ private:
   // Implement internal image sample for YCbCr conversion
   llvm::Value *createImageSampleInternal(llvm::SmallVectorImpl<llvm::Value *> &coords, YCbCrSampleInfo *ycbcrInfo);
 
+  // Implement internal image gather of one chroma channel for YCbCr conversion
+  llvm::Value *createImageGatherInternal(llvm::SmallVectorImpl<llvm::Value *> &coords, unsigned component,
+                                         YCbCrSampleInfo *ycbcrInfo);
+
+  // Check whether explicit chroma reconstruction can fetch neighbouring texels with image gathers
+  bool canGatherChroma() const;
+
   // Generate sampler descriptor for YCbCr conversion
   llvm::Value *generateSamplerDesc(llvm::Value *samplerDesc, SamplerFilter filter, bool forceExplicitReconstruction);
 
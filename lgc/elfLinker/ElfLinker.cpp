@@ -30,6 +30,7 @@
  */
 #include "lgc/ElfLinker.h"
 #include "GlueShader.h"
+#include "ParsedElf.h"
 #include "RelocHandler.h"
 #include "lgc/state/AbiMetadata.h"
 #include "lgc/state/PalMetadata.h"
@@ -38,7 +39,6 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Object/ELFObjectFile.h"
-#include "llvm/Object/SymbolicFile.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -55,7 +55,8 @@ class ElfLinkerImpl;
 // =====================================================================================================================
 // An ELF input to the linker
 struct ElfInput {
-  std::unique_ptr<object::ObjectFile> objectFile;
+  std::shared_ptr<const ParsedElf> parsedElf; // Pre-parsed ELF, possibly shared with other links
+  std::string fileName;                       // Name of the input
   SmallVector<std::pair<unsigned, unsigned>, 4> sectionMap;
   StringRef reduceAlign; // If non-empty, the name of a text section to reduce the alignment to 0x40
 };
@@ -63,10 +64,10 @@ struct ElfInput {
 // =====================================================================================================================
 // A single input section
 struct InputSection {
-  InputSection(object::SectionRef sectionRef) : sectionRef(sectionRef), size(sectionRef.getSize()) {}
-  object::SectionRef sectionRef; // Section from the input ELF
-  size_t offset = 0;             // Offset within the output ELF section
-  uint64_t size;                 // Size, possibly after removing s_end_code padding
+  InputSection(const ParsedElfSection &section) : section(&section), size(section.size) {}
+  const ParsedElfSection *section; // Section from the input ELF
+  size_t offset = 0;               // Offset within the output ELF section
+  uint64_t size;                   // Size, possibly after removing s_end_code padding
 };
 
 // =====================================================================================================================
@@ -78,7 +79,7 @@ public:
       : m_linker(linker), m_name(name), m_type(type) {}
 
   // Add an input section
-  void addInputSection(ElfInput &elfInput, object::SectionRef inputSection, bool reduceAlign = false);
+  void addInputSection(ElfInput &elfInput, unsigned sectionIndex, bool reduceAlign = false);
 
   // Get name of output section
   StringRef getName();
@@ -90,10 +91,10 @@ public:
   void layout();
 
   // Add a symbol to the output symbol table
-  void addSymbol(const object::ELFSymbolRef &elfSymRef, unsigned inputSectIdx);
+  void addSymbol(const ParsedElfSymbol &symbol, unsigned inputSectIdx);
 
   // Add a relocation to the output elf
-  void addRelocation(object::ELFRelocationRef relocRef, StringRef id, unsigned int relocSectionOffset,
+  void addRelocation(const ParsedElfReloc &reloc, StringRef id, unsigned int relocSectionOffset,
                      unsigned int targetSectionOffset);
 
   // Get the output file offset of a particular input section in the output section
@@ -194,13 +195,13 @@ private:
   void doneInputs();
 
   // Get the value of the symbol referenced in a reloc
-  bool getRelocValue(object::RelocationRef reloc, uint64_t &value);
+  bool getRelocValue(const ParsedElfReloc &reloc, uint64_t &value);
 
   // Find where an input section contributes to an output section
-  std::pair<unsigned, unsigned> findInputSection(ElfInput &elfInput, object::SectionRef section);
+  std::pair<unsigned, unsigned> findInputSection(ElfInput &elfInput, unsigned sectionIndex);
 
   // Read PAL metadata from an ELF file and merge it in to the PAL metadata that we already have
-  void mergePalMetadataFromElf(object::ObjectFile &objectFile, bool isGlueCode);
+  void mergePalMetadataFromElf(const ParsedElf &parsedElf, bool isGlueCode);
 
   // Write the PAL metadata out into the .note section.
   void writePalMetadata();
@@ -270,15 +271,16 @@ ElfLinkerImpl::~ElfLinkerImpl() {
 }
 
 // =====================================================================================================================
-// Add another input ELF to the link.
+// Add another input ELF to the link. The ELF is parsed into link-ready form, or found already parsed in the
+// shared in-memory cache if the same ELF was linked before (typically into another pipeline sharing the shader).
 void ElfLinkerImpl::addInputElf(MemoryBufferRef inputElf, bool addAtStart) {
   assert(!m_doneInputs && "Cannot use ElfLinker::addInputElf after other ElfLinker calls");
-  ElfInput elfInput = {cantFail(object::ObjectFile::createELFObjectFile(inputElf))};
+  ElfInput elfInput = {ParsedElf::get(inputElf), inputElf.getBufferIdentifier().str()};
   // Populate output ELF header if this is the first one to be added.
   if (m_elfInputs.empty())
     memcpy(&m_ehdr, inputElf.getBuffer().data(), sizeof(ELF::Elf64_Ehdr));
   // Add the ELF.
-  mergePalMetadataFromElf(*elfInput.objectFile, false);
+  mergePalMetadataFromElf(*elfInput.parsedElf, false);
   m_elfInputs.insert(addAtStart ? m_elfInputs.begin() : m_elfInputs.end(), std::move(elfInput));
 }
 
@@ -416,22 +418,22 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
 
   // Allocate input sections to output sections.
   for (auto &elfInput : m_elfInputs) {
-    for (const object::SectionRef &section : elfInput.objectFile->sections()) {
-      object::ELFSectionRef elfSection(section);
-      if (elfSection.getType() == ELF::SHT_PROGBITS) {
+    ArrayRef<ParsedElfSection> sections = elfInput.parsedElf->getSections();
+    for (unsigned sectionIndex = 0; sectionIndex != sections.size(); ++sectionIndex) {
+      if (sections[sectionIndex].type == ELF::SHT_PROGBITS) {
         // Put same-named sections together (excluding symbol table, string table, reloc sections).
-        StringRef name = cantFail(section.getName());
+        StringRef name = sections[sectionIndex].name;
         bool reduceAlign = false;
         if (elfInput.reduceAlign != "")
           reduceAlign = name == elfInput.reduceAlign;
         for (unsigned idx = 1;; ++idx) {
           if (idx == m_outputSections.size()) {
             m_outputSections.push_back(OutputSection(this));
-            m_outputSections[idx].addInputSection(elfInput, section, reduceAlign);
+            m_outputSections[idx].addInputSection(elfInput, sectionIndex, reduceAlign);
             break;
           }
           if (name == m_outputSections[idx].getName()) {
-            m_outputSections[idx].addInputSection(elfInput, section, reduceAlign);
+            m_outputSections[idx].addInputSection(elfInput, sectionIndex, reduceAlign);
             break;
           }
         }
@@ -456,15 +458,11 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
 
   // Find public symbols in the input ELFs, and add them to the output ELF.
   for (auto &elfInput : m_elfInputs) {
-    for (object::SymbolRef symRef : elfInput.objectFile->symbols()) {
-      object::ELFSymbolRef elfSymRef(symRef);
-      if (elfSymRef.getBinding() == ELF::STB_GLOBAL) {
-        object::section_iterator containingSect = cantFail(elfSymRef.getSection());
-        if (containingSect != elfInput.objectFile->section_end()) {
-          auto outputIndices = findInputSection(elfInput, *containingSect);
-          if (outputIndices.first != UINT_MAX)
-            m_outputSections[outputIndices.first].addSymbol(elfSymRef, outputIndices.second);
-        }
+    for (const ParsedElfSymbol &symbol : elfInput.parsedElf->getSymbols()) {
+      if (symbol.binding == ELF::STB_GLOBAL && symbol.sectionIndex != UINT_MAX) {
+        auto outputIndices = findInputSection(elfInput, symbol.sectionIndex);
+        if (outputIndices.first != UINT_MAX)
+          m_outputSections[outputIndices.first].addSymbol(symbol, outputIndices.second);
       }
     }
   }
@@ -494,32 +492,25 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
 
   // Add relocations that cannot be applied at this stage.
   for (auto &elfInput : m_elfInputs) {
-    for (const object::SectionRef section : elfInput.objectFile->sections()) {
-      unsigned sectType = object::ELFSectionRef(section).getType();
-      if (sectType == ELF::SHT_REL || sectType == ELF::SHT_RELA) {
-        for (object::RelocationRef reloc : section.relocations()) {
-          unsigned targetSectionIdx = UINT_MAX;
-          unsigned targetIdxInSection = UINT_MAX;
-          std::tie(targetSectionIdx, targetIdxInSection) =
-              findInputSection(elfInput, *cantFail(section.getRelocatedSection()));
-          if (targetSectionIdx != UINT_MAX) {
-            uint64_t value = 0;
-            if (getRelocValue(reloc, value)) {
-              continue;
-            }
-            (void)(textSectionIdx);
-            assert(targetSectionIdx == textSectionIdx && "We assume all relocations are applied to the text section");
-            assert(sectType == ELF::SHT_REL && "We do not output a RELA section yet");
-            object::SectionRef relocSection = *cantFail(reloc.getSymbol()->getSection());
-            unsigned relocSectionId = UINT_MAX;
-            unsigned relocIdxInSection = UINT_MAX;
-            std::tie(relocSectionId, relocIdxInSection) = findInputSection(elfInput, relocSection);
-            uint64_t relocSectionOffset = m_outputSections[relocSectionId].getOutputOffset(relocIdxInSection);
-            uint64_t targetSectionOffset = m_outputSections[targetSectionIdx].getOutputOffset(targetIdxInSection);
-            StringRef id = sys::path::filename(elfInput.objectFile->getFileName());
-            m_outputSections[relocSectionId].addRelocation(reloc, id, relocSectionOffset, targetSectionOffset);
-          }
+    for (const ParsedElfReloc &reloc : elfInput.parsedElf->getRelocs()) {
+      unsigned targetSectionIdx = UINT_MAX;
+      unsigned targetIdxInSection = UINT_MAX;
+      std::tie(targetSectionIdx, targetIdxInSection) = findInputSection(elfInput, reloc.targetSectionIndex);
+      if (targetSectionIdx != UINT_MAX) {
+        uint64_t value = 0;
+        if (getRelocValue(reloc, value)) {
+          continue;
         }
+        (void)(textSectionIdx);
+        assert(targetSectionIdx == textSectionIdx && "We assume all relocations are applied to the text section");
+        assert(!reloc.isRela && "We do not output a RELA section yet");
+        unsigned relocSectionId = UINT_MAX;
+        unsigned relocIdxInSection = UINT_MAX;
+        std::tie(relocSectionId, relocIdxInSection) = findInputSection(elfInput, reloc.symbol.sectionIndex);
+        uint64_t relocSectionOffset = m_outputSections[relocSectionId].getOutputOffset(relocIdxInSection);
+        uint64_t targetSectionOffset = m_outputSections[targetSectionIdx].getOutputOffset(targetIdxInSection);
+        StringRef id = sys::path::filename(elfInput.fileName);
+        m_outputSections[relocSectionId].addRelocation(reloc, id, relocSectionOffset, targetSectionOffset);
       }
     }
   }
@@ -540,42 +531,29 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
     outputSection.write(outStream, &shdrs[sectionIndex]);
   }
 
-  // Apply the relocs
+  // Apply the relocs. The addend was already read from the input ELF when it was parsed.
   for (auto &elfInput : m_elfInputs) {
-    for (const object::SectionRef section : elfInput.objectFile->sections()) {
-      unsigned sectType = object::ELFSectionRef(section).getType();
-      if (sectType == ELF::SHT_REL || sectType == ELF::SHT_RELA) {
-        for (object::RelocationRef reloc : section.relocations()) {
-          unsigned outputSectIdx = UINT_MAX;
-          unsigned withinSectIdx = UINT_MAX;
-          std::tie(outputSectIdx, withinSectIdx) = findInputSection(elfInput, *cantFail(section.getRelocatedSection()));
-          if (outputSectIdx != UINT_MAX) {
-            uint64_t value = 0;
-            if (!getRelocValue(reloc, value)) {
-              continue;
-            }
+    for (const ParsedElfReloc &reloc : elfInput.parsedElf->getRelocs()) {
+      unsigned outputSectIdx = UINT_MAX;
+      unsigned withinSectIdx = UINT_MAX;
+      std::tie(outputSectIdx, withinSectIdx) = findInputSection(elfInput, reloc.targetSectionIndex);
+      if (outputSectIdx != UINT_MAX) {
+        uint64_t value = 0;
+        if (!getRelocValue(reloc, value)) {
+          continue;
+        }
 
-            uint64_t inputOffset = reloc.getOffset();
-            uint64_t outputOffset = m_outputSections[outputSectIdx].getOutputOffset(withinSectIdx) + inputOffset;
-            uint64_t addend = 0;
-            if (sectType == ELF::SHT_RELA)
-              addend = cantFail(object::ELFRelocationRef(reloc).getAddend());
-            switch (reloc.getType()) {
-
-            case ELF::R_AMDGPU_ABS32: {
-              StringRef contents = cantFail(cantFail(section.getRelocatedSection())->getContents());
-              assert(inputOffset + sizeof(uint32_t) <= contents.size() && "Out of range reloc offset");
-              if (sectType == ELF::SHT_REL)
-                addend = *reinterpret_cast<const uint32_t *>(contents.data() + inputOffset);
-              uint32_t inst = addend + value;
-              outStream.pwrite(reinterpret_cast<const char *>(&inst), sizeof(inst), outputOffset);
-              break;
-            }
+        uint64_t outputOffset = m_outputSections[outputSectIdx].getOutputOffset(withinSectIdx) + reloc.offset;
+        switch (reloc.type) {
 
-            default:
-              report_fatal_error("Reloc not supported");
-            }
-          }
+        case ELF::R_AMDGPU_ABS32: {
+          uint32_t inst = reloc.addend + value;
+          outStream.pwrite(reinterpret_cast<const char *>(&inst), sizeof(inst), outputOffset);
+          break;
+        }
+
+        default:
+          report_fatal_error("Reloc not supported");
         }
       }
     }
@@ -655,8 +633,8 @@ unsigned ElfLinkerImpl::findSymbol(StringRef name) {
 // @param reloc : The relocation for which to find the value.
 // @param [out] value: The value for the relocation if it is found.
 // @returns : True if the value for the relocation was found.  False otherwise.
-bool ElfLinkerImpl::getRelocValue(object::RelocationRef reloc, uint64_t &value) {
-  StringRef name = cantFail(reloc.getSymbol()->getName());
+bool ElfLinkerImpl::getRelocValue(const ParsedElfReloc &reloc, uint64_t &value) {
+  StringRef name = reloc.symbol.name;
 
   // Handle the special case relocs from pipeline state
   if (m_relocHandler.getValue(name, value))
@@ -668,10 +646,10 @@ bool ElfLinkerImpl::getRelocValue(object::RelocationRef reloc, uint64_t &value)
 // Find where an input section contributes to an output section
 //
 // @param elfInput : ElfInput object for the ELF input
-// @param section : Section from that input
+// @param sectionIndex : Index of section in that input
 // @returns : {outputSectionIdx,withinIdx} pair, both elements UINT_MAX if no contribution to an output section
-std::pair<unsigned, unsigned> ElfLinkerImpl::findInputSection(ElfInput &elfInput, object::SectionRef section) {
-  unsigned idx = section.getIndex();
+std::pair<unsigned, unsigned> ElfLinkerImpl::findInputSection(ElfInput &elfInput, unsigned sectionIndex) {
+  unsigned idx = sectionIndex;
   if (idx >= elfInput.sectionMap.size())
     return {UINT_MAX, UINT_MAX};
   return elfInput.sectionMap[idx];
@@ -680,25 +658,11 @@ std::pair<unsigned, unsigned> ElfLinkerImpl::findInputSection(ElfInput &elfInput
 // =====================================================================================================================
 // Read PAL metadata from an ELF file and merge it in to the PAL metadata that we already have
 //
-// @param objectFile : The ELF input
-void ElfLinkerImpl::mergePalMetadataFromElf(object::ObjectFile &objectFile, bool isGlueCode) {
-  for (const object::SectionRef &section : objectFile.sections()) {
-    object::ELFSectionRef elfSection(section);
-    if (elfSection.getType() == ELF::SHT_NOTE) {
-      // This is a .note section. Find the PAL metadata note and merge it into the PalMetadata object
-      // in the PipelineState.
-      Error err = ErrorSuccess();
-      auto &elfFile = cast<object::ELFObjectFile<object::ELF64LE>>(&objectFile)->getELFFile();
-      auto shdr = cantFail(elfFile.getSection(elfSection.getIndex()));
-      for (auto note : elfFile.notes(*shdr, err)) {
-        if (note.getName() == Util::Abi::AmdGpuArchName && note.getType() == ELF::NT_AMDGPU_METADATA) {
-          ArrayRef<uint8_t> desc = note.getDesc();
-          m_pipelineState->mergePalMetadataFromBlob(StringRef(reinterpret_cast<const char *>(desc.data()), desc.size()),
-                                                    isGlueCode);
-        }
-      }
-    }
-  }
+// @param parsedElf : The ELF input
+void ElfLinkerImpl::mergePalMetadataFromElf(const ParsedElf &parsedElf, bool isGlueCode) {
+  // The PAL metadata notes were found in the .note sections when the ELF was parsed.
+  for (StringRef blob : parsedElf.getPalMetadataBlobs())
+    m_pipelineState->mergePalMetadataFromBlob(blob, isGlueCode);
 }
 
 // =====================================================================================================================
@@ -741,7 +705,7 @@ bool ElfLinkerImpl::insertGlueShaders() {
     // Compile the glue shader (if not already done), and parse the ELF.
     StringRef elfBlob = glueShader->getElfBlob();
     MemoryBufferRef elfBuffer(elfBlob, glueShader->getName());
-    ElfInput glueElfInput = {cantFail(object::ObjectFile::createELFObjectFile(elfBuffer))};
+    ElfInput glueElfInput = {ParsedElf::get(elfBuffer), elfBuffer.getBufferIdentifier().str()};
 
     // Find the input ELF containing the main shader that the glue shader wants to attach to.
     StringRef mainName = glueShader->getMainShaderName();
@@ -749,24 +713,26 @@ bool ElfLinkerImpl::insertGlueShaders() {
 
     if (mainName == glueShader->getGlueShaderName()) {
       // In this case, the glue shader is a stand alone shader.  The null fragment shader is an example.
-      mergePalMetadataFromElf(*glueElfInput.objectFile, false);
+      mergePalMetadataFromElf(*glueElfInput.parsedElf, false);
       m_elfInputs.push_back(std::move(glueElfInput));
       return true;
     }
 
     for (unsigned idx = 0; idx != m_elfInputs.size(); ++idx) {
       ElfInput &elfInput = m_elfInputs[idx];
-      for (auto sym : elfInput.objectFile->symbols()) {
-        if (cantFail(sym.getName()) == mainName) {
+      ArrayRef<ParsedElfSymbol> symbols = elfInput.parsedElf->getSymbols();
+      for (const ParsedElfSymbol &sym : symbols) {
+        if (sym.name == mainName) {
           // Found it. Find other STT_FUNC symbols in the same text section so we can check the validity of
           // gluing the glue shader on.
-          uint64_t symValue = cantFail(sym.getValue()), maxValue = symValue;
-          auto section = cantFail(sym.getSection());
-          auto type = cantFail(sym.getType());
-          for (auto otherSym : elfInput.objectFile->symbols()) {
-            if (cantFail(otherSym.getSection()) == section && cantFail(otherSym.getType()) == type)
-              maxValue = std::max(maxValue, cantFail(otherSym.getValue()));
+          uint64_t symValue = sym.value, maxValue = symValue;
+          for (const ParsedElfSymbol &otherSym : symbols) {
+            if (otherSym.sectionIndex == sym.sectionIndex && otherSym.type == sym.type)
+              maxValue = std::max(maxValue, otherSym.value);
           }
+          StringRef sectionName;
+          if (sym.sectionIndex != UINT_MAX)
+            sectionName = elfInput.parsedElf->getSections()[sym.sectionIndex].name;
           if (glueShader->isProlog()) {
             // For a prolog glue shader, we can only cope if the main shader is at the start of its text section.
             // We can reduce the alignment of the main shader from 0x100 to 0x40, but only if there are no
@@ -779,7 +745,7 @@ bool ElfLinkerImpl::insertGlueShaders() {
             // You cannot reduce the alignment if the elfInput has more than one
             // shader.  Otherwise the other shaders could be misaligned.
             if (containsASingleShader(elfInput))
-              elfInput.reduceAlign = cantFail(section->getName());
+              elfInput.reduceAlign = sectionName;
             insertPos = idx;
           } else {
             // For an epilog glue shader, we can only cope if the main shader is the last one in its text section.
@@ -788,7 +754,7 @@ bool ElfLinkerImpl::insertGlueShaders() {
               getPipelineState()->setError("Shader " + mainName + " is not at the end of its text section");
               return false;
             }
-            glueElfInput.reduceAlign = cantFail(section->getName());
+            glueElfInput.reduceAlign = sectionName;
             insertPos = idx + 1;
           }
           break;
@@ -799,7 +765,7 @@ bool ElfLinkerImpl::insertGlueShaders() {
     // Merge PAL metadata from glue ELF.
     // Note that the merger callback in PalMetadata.cpp relies on the PAL metadata for the shader/part-pipeline
     // ELFs being read first, and the glue shaders being merged in afterwards.
-    mergePalMetadataFromElf(*glueElfInput.objectFile, true);
+    mergePalMetadataFromElf(*glueElfInput.parsedElf, true);
 
     // Insert the glue shader in the appropriate place in the list of ELFs.
     assert(insertPos != UINT_MAX && "Main shader not found for glue shader");
@@ -811,32 +777,24 @@ bool ElfLinkerImpl::insertGlueShaders() {
 // =====================================================================================================================
 // Returns true of the given elf contains just 1 shader.
 bool ElfLinkerImpl::containsASingleShader(ElfInput &elf) {
-  bool foundAFunction = false;
-  for (auto sym : elf.objectFile->symbols()) {
-    if (cantFail(sym.getType()) != llvm::object::SymbolRef::Type::ST_Function)
-      continue;
-    if (foundAFunction)
-      return false;
-    foundAFunction = true;
-  }
-  return true;
+  return elf.parsedElf->getFunctionCount() <= 1;
 }
 
 // =====================================================================================================================
 // Add an input section to this output section
 //
 // @param elfInput : ELF input that the section comes from
-// @param inputSection : Input section to add to this output section
+// @param sectionIndex : Index of input section to add to this output section
 // @param reduceAlign : Reduce the alignment of the section (for gluing code together)
-void OutputSection::addInputSection(ElfInput &elfInput, object::SectionRef inputSection, bool reduceAlign) {
+void OutputSection::addInputSection(ElfInput &elfInput, unsigned sectionIndex, bool reduceAlign) {
   // Add the input section.
-  m_inputSections.push_back(inputSection);
+  m_inputSections.push_back(InputSection(elfInput.parsedElf->getSections()[sectionIndex]));
   // Remember reduceAlign request.
   if (reduceAlign)
     setReduceAlign(m_inputSections.back());
   // Add an entry to the ElfInput's sectionMap, so we can get from an input section to where it contributes
   // to an output section.
-  unsigned idx = inputSection.getIndex();
+  unsigned idx = sectionIndex;
   if (idx >= elfInput.sectionMap.size())
     elfInput.sectionMap.resize(idx + 1, {UINT_MAX, UINT_MAX});
   elfInput.sectionMap[idx] = {getIndex(), m_inputSections.size() - 1};
@@ -849,7 +807,7 @@ StringRef OutputSection::getName() {
     return m_name;
   if (m_inputSections.empty())
     return "";
-  return cantFail(m_inputSections[0].sectionRef.getName());
+  return m_inputSections[0].section->name;
 }
 
 // =====================================================================================================================
@@ -866,21 +824,9 @@ unsigned OutputSection::getIndex() {
 void OutputSection::layout() {
   uint64_t size = 0;
   for (InputSection &inputSection : m_inputSections) {
-    if (object::ELFSectionRef(inputSection.sectionRef).getFlags() & ELF::SHF_EXECINSTR) {
-      // Remove GFX10 s_end_code padding by removing any suffix of the section that is not inside a function symbol.
-      inputSection.size = 0;
-      for (auto &sym : inputSection.sectionRef.getObject()->symbols()) {
-        if (cantFail(sym.getSection()) == inputSection.sectionRef &&
-            cantFail(sym.getType()) == object::SymbolRef::ST_Function) {
-          inputSection.size =
-              std::max(inputSection.size, cantFail(sym.getValue()) + object::ELFSymbolRef(sym).getSize());
-        }
-      }
-      if (inputSection.size == 0) {
-        // No function symbols found. We'd better restore the size to the size of the whole section.
-        inputSection.size = inputSection.sectionRef.getSize();
-      }
-    }
+    // Remove GFX10 s_end_code padding by removing any suffix of the section that is not inside a function symbol.
+    // The end of the last function was found when the input ELF was parsed.
+    inputSection.size = inputSection.section->codeSize;
 
     // Gain alignment as required for the next input section.
     uint64_t alignment = getAlignment(inputSection);
@@ -901,7 +847,7 @@ void OutputSection::layout() {
 //
 // @param inputSection : InputSection
 uint64_t OutputSection::getAlignment(const InputSection &inputSection) {
-  uint64_t alignment = inputSection.sectionRef.getAlignment();
+  uint64_t alignment = inputSection.section->alignment;
   // Check if alignment is reduced for this section
   // for gluing code together.
   if (alignment > 0x40 && getReduceAlign(inputSection))
@@ -912,29 +858,29 @@ uint64_t OutputSection::getAlignment(const InputSection &inputSection) {
 // =====================================================================================================================
 // Add a symbol to the output symbol table
 //
-// @param elfSymRef : The symbol from an input ELF
+// @param symbol : The symbol from an input ELF
 // @param inputSectIdx : Index of input section within this output section that the symbol refers to
-void OutputSection::addSymbol(const object::ELFSymbolRef &elfSymRef, unsigned inputSectIdx) {
+void OutputSection::addSymbol(const ParsedElfSymbol &symbol, unsigned inputSectIdx) {
   const InputSection &inputSection = m_inputSections[inputSectIdx];
-  StringRef name = cantFail(elfSymRef.getName());
+  StringRef name = symbol.name;
   ELF::Elf64_Sym newSym = {};
   newSym.st_name = m_linker->getStringIndex(name);
-  newSym.setBinding(elfSymRef.getBinding());
-  newSym.setType(cantFail(elfSymRef.getType()));
+  newSym.setBinding(symbol.binding);
+  newSym.setType(symbol.type);
   newSym.st_shndx = getIndex();
-  newSym.st_value = cantFail(elfSymRef.getValue()) + inputSection.offset;
-  newSym.st_size = elfSymRef.getSize();
+  newSym.st_value = symbol.value + inputSection.offset;
+  newSym.st_size = symbol.size;
   if (m_linker->findSymbol(newSym.st_name) != 0)
     report_fatal_error("Duplicate symbol '" + name + "'");
   m_linker->getSymbols().push_back(newSym);
 }
 
 // Add a relocation to the output elf
-void OutputSection::addRelocation(object::ELFRelocationRef relocRef, StringRef id, unsigned int relocSectionOffset,
+void OutputSection::addRelocation(const ParsedElfReloc &reloc, StringRef id, unsigned int relocSectionOffset,
                                   unsigned int targetSectionOffset) {
   ELF::Elf64_Rel newReloc = {};
-  object::ELFSymbolRef relocSymRef(*relocRef.getSymbol());
-  std::string rodataSymName = cantFail(relocSymRef.getName()).str();
+  const ParsedElfSymbol &relocSym = reloc.symbol;
+  std::string rodataSymName = relocSym.name.str();
   rodataSymName += ".";
   rodataSymName += id;
   unsigned rodataSymIdx = m_linker->findSymbol(rodataSymName);
@@ -945,13 +891,13 @@ void OutputSection::addRelocation(object::ELFRelocationRef relocRef, StringRef i
     newSym.setBinding(ELF::STB_LOCAL);
     newSym.setType(cantFail(object::SymbolRef::ST_Data));
     newSym.st_shndx = getIndex();
-    newSym.st_value = relocSectionOffset + cantFail(relocSymRef.getValue());
-    newSym.st_size = relocSymRef.getSize();
+    newSym.st_value = relocSectionOffset + relocSym.value;
+    newSym.st_size = relocSym.size;
     rodataSymIdx = m_linker->getSymbols().size();
     m_linker->getSymbols().push_back(newSym);
   }
-  newReloc.setSymbolAndType(rodataSymIdx, relocRef.getType());
-  newReloc.r_offset = targetSectionOffset + relocRef.getOffset();
+  newReloc.setSymbolAndType(rodataSymIdx, reloc.type);
+  newReloc.r_offset = targetSectionOffset + reloc.offset;
   m_linker->getRelocations().push_back(newReloc);
 }
 
@@ -1007,8 +953,8 @@ void OutputSection::write(raw_pwrite_stream &outStream, ELF::Elf64_Shdr *shdr) {
     return;
 
   // This section has contributions from input sections. Get the type and flags from the first input section.
-  shdr->sh_type = object::ELFSectionRef(m_inputSections[0].sectionRef).getType();
-  shdr->sh_flags = object::ELFSectionRef(m_inputSections[0].sectionRef).getFlags();
+  shdr->sh_type = m_inputSections[0].section->type;
+  shdr->sh_flags = m_inputSections[0].section->flags;
 
   // Set up the pattern we will use for alignment padding.
   const size_t paddingUnit = 16;
@@ -1034,7 +980,7 @@ void OutputSection::write(raw_pwrite_stream &outStream, ELF::Elf64_Shdr *shdr) {
     }
 
     // Write the input section
-    StringRef contents = cantFail(inputSection.sectionRef.getContents());
+    StringRef contents = inputSection.section->contents;
     outStream << contents.slice(0, inputSection.size);
     size += inputSection.size;
   }
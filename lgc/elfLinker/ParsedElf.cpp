@@ -0,0 +1,259 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  ParsedElf.cpp
+ * @brief LGC source file: Pre-parsed, link-ready form of an input ELF to the ELF linker, with a shared cache
+ ***********************************************************************************************************************
+ */
+#include "ParsedElf.h"
+#include "lgc/state/AbiMetadata.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/xxhash.h"
+#include <list>
+#include <mutex>
+
+#define DEBUG_TYPE "lgc-elf-linker"
+
+using namespace lgc;
+using namespace llvm;
+
+// -elf-linker-cache-size: maximum number of pre-parsed input ELFs kept by the ELF linker
+static cl::opt<unsigned>
+    ElfLinkerCacheSize("elf-linker-cache-size",
+                       cl::desc("Maximum number of pre-parsed input ELFs kept in memory by the ELF linker (0 to "
+                                "disable)"),
+                       cl::init(256));
+
+namespace llvm {
+// =====================================================================================================================
+// Temporary cantFail override to cope with a forthcoming change of the return type of ELFSymbolRef::getValue
+// from uint64_t to Expected<uint64_t>.
+inline uint64_t cantFail(uint64_t value, const char *Msg = nullptr) {
+  return value;
+}
+} // namespace llvm
+
+namespace {
+
+// =====================================================================================================================
+// Shared in-memory cache of pre-parsed ELFs, keyed by a hash of the ELF contents, with least-recently-used eviction.
+class ParsedElfCache {
+public:
+  // Get the pre-parsed ELF for the given contents, parsing and adding it to the cache if not found.
+  std::shared_ptr<const ParsedElf> get(MemoryBufferRef elf);
+
+  // Clear the cache.
+  void clear();
+
+private:
+  typedef std::list<std::pair<uint64_t, std::shared_ptr<const ParsedElf>>> LruList;
+
+  std::mutex m_mutex;                          // Lock for all accesses to the cache
+  LruList m_lruList;                           // Entries, most recently used first
+  DenseMap<uint64_t, LruList::iterator> m_map; // Map from content hash to entry
+};
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Get the pre-parsed ELF for the given contents, parsing and adding it to the cache if not found.
+//
+// @param elf : ELF contents
+std::shared_ptr<const ParsedElf> ParsedElfCache::get(MemoryBufferRef elf) {
+  const unsigned capacity = ElfLinkerCacheSize;
+  if (capacity == 0)
+    return ParsedElf::parse(elf);
+
+  const uint64_t hash = xxHash64(elf.getBuffer());
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_map.find(hash);
+    if (it != m_map.end()) {
+      // Compare the contents too, so a hash collision cannot give a wrong ELF.
+      std::shared_ptr<const ParsedElf> parsedElf = it->second->second;
+      if (parsedElf->getBuffer() != elf.getBuffer())
+        return ParsedElf::parse(elf);
+      m_lruList.splice(m_lruList.begin(), m_lruList, it->second);
+      LLVM_DEBUG(dbgs() << "ELF linker cache hit: " << format_hex(hash, 18) << "\n");
+      return parsedElf;
+    }
+  }
+
+  // Parse outside the lock, so other links are not held up.
+  LLVM_DEBUG(dbgs() << "ELF linker cache miss: " << format_hex(hash, 18) << "\n");
+  std::shared_ptr<const ParsedElf> parsedElf = ParsedElf::parse(elf);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_map.count(hash) == 0) {
+    m_lruList.emplace_front(hash, parsedElf);
+    m_map[hash] = m_lruList.begin();
+    while (m_lruList.size() > capacity) {
+      // Evict the least recently used entry. Any link still using it keeps it alive through its shared_ptr.
+      m_map.erase(m_lruList.back().first);
+      m_lruList.pop_back();
+    }
+  }
+  return parsedElf;
+}
+
+// =====================================================================================================================
+// Clear the cache.
+void ParsedElfCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_map.clear();
+  m_lruList.clear();
+}
+
+// =====================================================================================================================
+// Get the shared cache
+static ParsedElfCache &getParsedElfCache() {
+  static ParsedElfCache cache;
+  return cache;
+}
+
+// =====================================================================================================================
+// Get the pre-parsed form of the given ELF, using the shared in-memory cache keyed by ELF content.
+//
+// @param elf : ELF contents
+std::shared_ptr<const ParsedElf> ParsedElf::get(MemoryBufferRef elf) {
+  return getParsedElfCache().get(elf);
+}
+
+// =====================================================================================================================
+// Parse the given ELF without using the cache.
+//
+// @param elf : ELF contents
+std::shared_ptr<const ParsedElf> ParsedElf::parse(MemoryBufferRef elf) {
+  return std::shared_ptr<const ParsedElf>(new ParsedElf(elf));
+}
+
+// =====================================================================================================================
+// Clear the shared cache.
+void ParsedElf::clearCache() {
+  getParsedElfCache().clear();
+}
+
+// =====================================================================================================================
+// Constructor: copy and parse the given ELF.
+//
+// @param elf : ELF contents
+ParsedElf::ParsedElf(MemoryBufferRef elf)
+    : m_buffer(MemoryBuffer::getMemBufferCopy(elf.getBuffer(), elf.getBufferIdentifier())) {
+  std::unique_ptr<object::ObjectFile> objectFile =
+      cantFail(object::ObjectFile::createELFObjectFile(m_buffer->getMemBufferRef()));
+  auto &elfFile = cast<object::ELFObjectFile<object::ELF64LE>>(&*objectFile)->getELFFile();
+
+  // Sections, and PAL metadata from .note sections.
+  for (const object::SectionRef &section : objectFile->sections()) {
+    object::ELFSectionRef elfSection(section);
+    unsigned idx = section.getIndex();
+    if (idx >= m_sections.size())
+      m_sections.resize(idx + 1);
+    ParsedElfSection &parsedSection = m_sections[idx];
+    parsedSection.type = elfSection.getType();
+    parsedSection.flags = elfSection.getFlags();
+    parsedSection.alignment = section.getAlignment();
+    parsedSection.size = section.getSize();
+    parsedSection.codeSize = parsedSection.size;
+    parsedSection.name = cantFail(section.getName());
+    if (parsedSection.type != ELF::SHT_NOBITS)
+      parsedSection.contents = cantFail(section.getContents());
+
+    if (parsedSection.type == ELF::SHT_NOTE) {
+      Error err = ErrorSuccess();
+      auto shdr = cantFail(elfFile.getSection(idx));
+      for (auto note : elfFile.notes(*shdr, err)) {
+        if (note.getName() == Util::Abi::AmdGpuArchName && note.getType() == ELF::NT_AMDGPU_METADATA) {
+          ArrayRef<uint8_t> desc = note.getDesc();
+          m_palMetadataBlobs.push_back(StringRef(reinterpret_cast<const char *>(desc.data()), desc.size()));
+        }
+      }
+      cantFail(std::move(err));
+    }
+  }
+
+  // Gets the parsed form of a symbol.
+  auto parseSymbol = [&](const object::SymbolRef &symRef) {
+    object::ELFSymbolRef elfSymRef(symRef);
+    ParsedElfSymbol parsedSymbol;
+    parsedSymbol.name = cantFail(elfSymRef.getName());
+    object::section_iterator containingSect = cantFail(elfSymRef.getSection());
+    if (containingSect != objectFile->section_end())
+      parsedSymbol.sectionIndex = containingSect->getIndex();
+    parsedSymbol.value = cantFail(elfSymRef.getValue());
+    parsedSymbol.size = elfSymRef.getSize();
+    parsedSymbol.binding = elfSymRef.getBinding();
+    parsedSymbol.type = cantFail(elfSymRef.getType());
+    return parsedSymbol;
+  };
+
+  // Symbols. Also find the end of the last function in each executable section, so the linker can remove GFX10
+  // s_code_end padding without scanning the symbols again.
+  SmallVector<uint64_t, 8> codeSizes(m_sections.size());
+  for (const object::SymbolRef &symRef : objectFile->symbols()) {
+    m_symbols.push_back(parseSymbol(symRef));
+    const ParsedElfSymbol &parsedSymbol = m_symbols.back();
+    if (parsedSymbol.type == object::SymbolRef::ST_Function) {
+      ++m_functionCount;
+      if (parsedSymbol.sectionIndex != UINT_MAX)
+        codeSizes[parsedSymbol.sectionIndex] =
+            std::max(codeSizes[parsedSymbol.sectionIndex], parsedSymbol.value + parsedSymbol.size);
+    }
+  }
+  for (unsigned idx = 0; idx != m_sections.size(); ++idx) {
+    // If no function symbols are found, keep the size of the whole section.
+    if ((m_sections[idx].flags & ELF::SHF_EXECINSTR) && codeSizes[idx] != 0)
+      m_sections[idx].codeSize = codeSizes[idx];
+  }
+
+  // Relocs.
+  for (const object::SectionRef &section : objectFile->sections()) {
+    unsigned sectType = object::ELFSectionRef(section).getType();
+    if (sectType != ELF::SHT_REL && sectType != ELF::SHT_RELA)
+      continue;
+    object::section_iterator relocatedSection = cantFail(section.getRelocatedSection());
+    for (object::RelocationRef reloc : section.relocations()) {
+      ParsedElfReloc parsedReloc;
+      parsedReloc.targetSectionIndex = relocatedSection->getIndex();
+      parsedReloc.offset = reloc.getOffset();
+      parsedReloc.type = reloc.getType();
+      parsedReloc.isRela = sectType == ELF::SHT_RELA;
+      if (parsedReloc.isRela) {
+        parsedReloc.addend = cantFail(object::ELFRelocationRef(reloc).getAddend());
+      } else if (parsedReloc.type == ELF::R_AMDGPU_ABS32) {
+        StringRef contents = m_sections[parsedReloc.targetSectionIndex].contents;
+        assert(parsedReloc.offset + sizeof(uint32_t) <= contents.size() && "Out of range reloc offset");
+        parsedReloc.addend = *reinterpret_cast<const uint32_t *>(contents.data() + parsedReloc.offset);
+      }
+      parsedReloc.symbol = parseSymbol(*reloc.getSymbol());
+      m_relocs.push_back(parsedReloc);
+    }
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  ParsedElf.h
+ * @brief LGC header file: Pre-parsed, link-ready form of an input ELF to the ELF linker, with a shared cache
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <climits>
+#include <memory>
+
+namespace lgc {
+
+// =====================================================================================================================
+// A section of a pre-parsed ELF
+struct ParsedElfSection {
+  unsigned type = 0;        // SHT_* section type
+  uint64_t flags = 0;       // SHF_* section flags
+  uint64_t alignment = 0;   // Address alignment
+  uint64_t size = 0;        // Section size
+  uint64_t codeSize = 0;    // For an executable section, size without any suffix that is not inside a function
+                            //  symbol (such as GFX10 s_code_end padding); otherwise same as size
+  llvm::StringRef name;     // Section name
+  llvm::StringRef contents; // Section contents
+};
+
+// =====================================================================================================================
+// A symbol of a pre-parsed ELF
+struct ParsedElfSymbol {
+  llvm::StringRef name;                    // Symbol name
+  unsigned sectionIndex = UINT_MAX;        // Index of the section containing the symbol, UINT_MAX if none
+  uint64_t value = 0;                      // Symbol value
+  uint64_t size = 0;                       // Symbol size
+  unsigned binding = 0;                    // STB_* symbol binding
+  llvm::object::SymbolRef::Type type = {}; // Symbol type
+};
+
+// =====================================================================================================================
+// A relocation of a pre-parsed ELF
+struct ParsedElfReloc {
+  unsigned targetSectionIndex = UINT_MAX; // Index of the section that the reloc applies to
+  uint64_t offset = 0;                    // Offset within the target section
+  unsigned type = 0;                      // R_AMDGPU_* reloc type
+  bool isRela = false;                    // Whether the reloc is from a SHT_RELA section
+  uint64_t addend = 0;                    // Explicit addend (SHT_RELA), or implicit addend read from the target
+                                          //  section for a supported SHT_REL reloc type
+  ParsedElfSymbol symbol;                 // Symbol that the reloc refers to
+};
+
+// =====================================================================================================================
+// Pre-parsed, link-ready form of an input ELF to the ELF linker. It owns a copy of the ELF, and holds the section
+// table, symbols, relocs and PAL metadata blobs already extracted, so a link only does layout and relocation work.
+// A ParsedElf is immutable once created, so the same object can be shared by concurrent links.
+class ParsedElf {
+public:
+  // Get the pre-parsed form of the given ELF, using the shared in-memory cache keyed by ELF content.
+  static std::shared_ptr<const ParsedElf> get(llvm::MemoryBufferRef elf);
+
+  // Parse the given ELF without using the cache.
+  static std::shared_ptr<const ParsedElf> parse(llvm::MemoryBufferRef elf);
+
+  // Clear the shared cache.
+  static void clearCache();
+
+  // Get the ELF contents
+  llvm::StringRef getBuffer() const { return m_buffer->getBuffer(); }
+
+  // Get the sections, indexed by ELF section index
+  llvm::ArrayRef<ParsedElfSection> getSections() const { return m_sections; }
+
+  // Get the symbols, in the order of the ELF symbol table
+  llvm::ArrayRef<ParsedElfSymbol> getSymbols() const { return m_symbols; }
+
+  // Get the relocs from all SHT_REL and SHT_RELA sections
+  llvm::ArrayRef<ParsedElfReloc> getRelocs() const { return m_relocs; }
+
+  // Get the PAL metadata blobs from the .note sections
+  llvm::ArrayRef<llvm::StringRef> getPalMetadataBlobs() const { return m_palMetadataBlobs; }
+
+  // Get the number of function symbols
+  unsigned getFunctionCount() const { return m_functionCount; }
+
+private:
+  ParsedElf(llvm::MemoryBufferRef elf);
+
+  std::unique_ptr<llvm::MemoryBuffer> m_buffer;             // Copy of the ELF contents
+  llvm::SmallVector<ParsedElfSection, 8> m_sections;        // Sections, indexed by ELF section index
+  llvm::SmallVector<ParsedElfSymbol, 8> m_symbols;          // Symbols
+  llvm::SmallVector<ParsedElfReloc, 8> m_relocs;            // Relocs
+  llvm::SmallVector<llvm::StringRef, 1> m_palMetadataBlobs; // PAL metadata blobs
+  unsigned m_functionCount = 0;                             // Number of function symbols
+};
+
+} // namespace lgc
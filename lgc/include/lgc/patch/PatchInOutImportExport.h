@@ -99,7 +99,7 @@ private:
   void patchTesGenericOutputExport(llvm::Value *output, unsigned location, unsigned compIdx,
                                    llvm::Instruction *insertPos);
   void patchGsGenericOutputExport(llvm::Value *output, unsigned location, unsigned compIdx, unsigned streamId,
-                                  llvm::Instruction *insertPos);
+                                  bool isHighHalf, llvm::Instruction *insertPos);
 
   llvm::Value *patchVsBuiltInInputImport(llvm::Type *inputTy, unsigned builtInId, llvm::Instruction *insertPos);
   llvm::Value *patchTcsBuiltInInputImport(llvm::Type *inputTy, unsigned builtInId, llvm::Value *elemIdx,
@@ -149,7 +149,7 @@ private:
                                      llvm::Instruction *insertPos);
 
   void storeValueToGsVsRing(llvm::Value *storeValue, unsigned location, unsigned compIdx, unsigned streamId,
-                            llvm::Instruction *insertPos);
+                            bool isHighHalf, llvm::Instruction *insertPos);
 
   llvm::Value *calcEsGsRingOffsetForOutput(unsigned location, unsigned compIdx, llvm::Value *esGsOffset,
                                            llvm::Instruction *insertPos);
@@ -172,10 +172,6 @@ private:
 
   void createTessBufferStoreFunction(llvm::StringRef funcName, unsigned compCount, llvm::Type *tfValueTy);
 
-  unsigned calcPatchCountPerThreadGroup(unsigned inVertexCount, unsigned inVertexStride, unsigned outVertexCount,
-                                        unsigned outVertexStride, unsigned patchConstCount,
-                                        unsigned tessFactorStride) const;
-
   llvm::Value *calcLdsOffsetForVsOutput(llvm::Type *outputTy, unsigned location, unsigned compIdx,
                                         llvm::Instruction *insertPos);
 
@@ -205,6 +201,9 @@ private:
   void recordVertexAttribExport(unsigned location, llvm::ArrayRef<llvm::Value *> attribValues);
   void exportVertexAttribs(llvm::Instruction *insertPos);
 
+  void collectConstTessLevels(llvm::Function *tcsEntryPoint, llvm::Function *tesEntryPoint);
+  llvm::Constant *getConstTessLevel(unsigned builtInId, llvm::Type *tessLevelTy, llvm::Value *elemIdx);
+  bool isPatchUniform(llvm::Value *value, unsigned depth = 0);
   void storeTessFactors();
   void doTessFactorBufferStore(llvm::ArrayRef<llvm::Value *> outerTessFactors,
                                llvm::ArrayRef<llvm::Value *> innerTessFactors, llvm::Instruction *insertPos);
@@ -243,6 +242,11 @@ private:
 
   llvm::SmallVector<llvm::Instruction *, 4> m_tessLevelOuterInsts; // Collect the instructions of TessLevelOuter
   llvm::SmallVector<llvm::Instruction *, 2> m_tessLevelInnerInsts; // Collect the instructions of TessLevelInner
+
+  // Compile-time constant elements of gl_TessLevelOuter ([0]) and gl_TessLevelInner ([1]) written by TCS, or null if
+  // the element is not written or not a constant
+  llvm::Constant *m_constTessLevels[2][4] = {};
+  bool m_foldTessLevels[2] = {}; // Whether all TES reads of gl_TessLevelOuter/gl_TessLevelInner are folded
 };
 
 // =====================================================================================================================
@@ -48,6 +48,9 @@ public:
   static llvm::StringRef name() { return "Patch for initialize workgroup memory"; }
 
 private:
+  bool aliasWorkgroupGlobals(llvm::Module &module, llvm::ArrayRef<llvm::GlobalVariable *> globals);
+  bool collectWorkgroupAccesses(llvm::Value *pointer, llvm::SmallVectorImpl<llvm::Instruction *> &accesses,
+                                llvm::SmallPtrSetImpl<llvm::Value *> &visited);
   void initializeWithZero(llvm::GlobalVariable *lds, BuilderBase &builder);
   unsigned getTypeSizeInDwords(llvm::Type *inputTy);
 
@@ -35,6 +35,7 @@
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
 #include "llvm/IR/InstVisitor.h"
+#include <functional>
 
 namespace lgc {
 
@@ -47,13 +48,19 @@ public:
 
   llvm::PreservedAnalyses run(llvm::Function &function, llvm::FunctionAnalysisManager &analysisManager);
 
-  bool runImpl(llvm::Function &function, PipelineState *pipelineState);
+  // NOTE: Once the switch to the new pass manager is completed, the isDivergentUse argument can be removed and put
+  // back as a class attribute.
+  bool runImpl(llvm::Function &function, PipelineState *pipelineState,
+               std::function<bool(const llvm::Use &)> isDivergentUse);
 
   static llvm::StringRef name() { return "Patch LLVM for load scalarizer optimization"; }
 
   void visitLoadInst(llvm::LoadInst &loadInst);
 
 private:
+  bool isWholeVectorUsed(llvm::LoadInst &loadInst);
+
+  std::function<bool(const llvm::Use &)> m_isDivergentUse; // Function returning true if the given use is divergent
   llvm::SmallVector<llvm::Instruction *, 8> m_instsToErase; // Instructions to erase
   std::unique_ptr<llvm::IRBuilder<>> m_builder;             // The IRBuilder.
   unsigned m_scalarThreshold;                               // The threshold for load scalarizer
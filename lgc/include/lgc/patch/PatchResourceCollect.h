@@ -60,13 +60,20 @@ private:
   // Determines whether GS on-chip mode is valid for this pipeline, also computes ES-GS/GS-VS ring item size.
   bool checkGsOnChipValidity();
 
+  // Determines whether tessellation control outputs should be stored in the off-chip LDS buffer for this pipeline.
+  bool checkTessOffChipRequired();
+
   // Sets NGG control settings
   void setNggControl(llvm::Module *module);
   bool canUseNgg(llvm::Module *module);
   bool canUseNggCulling(llvm::Module *module);
+  bool isNggCullingProfitable(llvm::Module *module);
+  llvm::CallInst *findPositionExport(llvm::Module *module, ShaderStage shaderStage);
 
   void processShader();
   void processMissingFs();
+  void refineFsResourceWrite(llvm::Module &module);
+  void propagateConstantOutputs(llvm::Module &module);
 
   bool isVertexReuseDisabled();
 
@@ -49,6 +49,10 @@ public:
   // Generate code to fetch a vertex value
   virtual llvm::Value *fetchVertex(llvm::Type *inputTy, const VertexInputDescription *description, unsigned location,
                                    unsigned compIdx, BuilderBase &builder) = 0;
+
+  // Generate code to fetch a vertex value, reading the attribute description from the uber fetch shader table
+  virtual llvm::Value *fetchVertexUber(llvm::Type *inputTy, llvm::Value *attribTable, unsigned location,
+                                       unsigned compIdx, BuilderBase &builder) = 0;
 };
 
 // =====================================================================================================================
@@ -107,11 +107,18 @@ static constexpr char EsGsLdsSize[] = ".es_gs_lds_size";
 static constexpr char StreamOutTableAddress[] = ".stream_out_table_address";
 static constexpr char IndirectUserDataTableAddresses[] = ".indirect_user_data_table_addresses";
 static constexpr char NggSubgroupSize[] = ".nggSubgroupSize";
+static constexpr char NggCulling[] = ".ngg_culling";
 static constexpr char NumInterpolants[] = ".num_interpolants";
 static constexpr char Api[] = ".api";
 static constexpr char ApiCreateInfo[] = ".api_create_info";
 }; // namespace PipelineMetadataKey
 
+namespace NggCullingMetadataKey {
+static constexpr char Enabled[] = ".enabled";
+static constexpr char EstimatedCost[] = ".estimated_cost";
+static constexpr char EstimatedBenefit[] = ".estimated_benefit";
+}; // namespace NggCullingMetadataKey
+
 namespace HardwareStageMetadataKey {
 static constexpr char EntryPoint[] = ".entry_point";
 static constexpr char ScratchMemorySize[] = ".scratch_memory_size";
@@ -129,6 +136,8 @@ static constexpr char WritesUavs[] = ".writes_uavs";
 static constexpr char WritesDepth[] = ".writes_depth";
 static constexpr char UsesAppendConsume[] = ".uses_append_consume";
 static constexpr char MaxPrimsPerWave[] = ".max_prims_per_wave";
+static constexpr char OffchipLdsEn[] = ".offchip_lds_en";
+static constexpr char MaxWavesPerEu[] = ".max_waves_per_eu";
 }; // namespace HardwareStageMetadataKey
 
 namespace ShaderMetadataKey {
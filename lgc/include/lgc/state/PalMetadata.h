@@ -161,6 +161,10 @@ public:
   // Erase the color export info
   void eraseColorExportInfo();
 
+  // Set the occupancy ceiling (waves per SIMD) implied by LDS usage and workgroup size for the hardware stage that
+  // uses the given calling convention.
+  void setMaxWavesPerEu(unsigned callingConv, unsigned maxWavesPerEu);
+
   // Finalize PAL metadata for pipeline, part-pipeline or shader compilation.
   void finalizePipeline(bool isWholePipeline);
 
@@ -112,6 +112,8 @@ struct NggControl {
   unsigned vertsPerSubgroup; // Preferred number of vertices consumed by a primitive shader sub-group
 
   bool passthroughMode;                          // Whether NGG passthrough mode is enabled
+  unsigned cullingCost;                          // Estimated per-vertex overhead of NGG culling mode (0 if unknown)
+  unsigned cullingBenefit;                       // Estimated per-vertex saving of NGG culling mode (0 if unknown)
   Util::Abi::PrimShaderCbLayout primShaderTable; // Primitive shader table (only some registers are used)
 };
 
@@ -266,9 +268,20 @@ public:
   const RasterizerState &getRasterizerState() const { return m_rasterizerState; }
   const DepthStencilState &getDepthStencilState() const { return m_depthStencilState; }
 
+  // Set tessellation off-chip mode
+  void setTessOffChip(bool tessOffChip) { m_tessOffChip = tessOffChip; }
+
   // Determine whether to use off-chip tessellation mode
   bool isTessOffChip();
 
+  // Gets the stride (in dwords) of the tessellation factors of a patch
+  unsigned getTessFactorStride();
+
+  // Calculates the patch count per thread group of a tessellation pipeline
+  unsigned calcPatchCountPerThreadGroup(bool tessOffChip, unsigned inVertexCount, unsigned inVertexStride,
+                                        unsigned outVertexCount, unsigned outVertexStride, unsigned patchConstCount,
+                                        unsigned tessFactorStride);
+
   // Set GS on-chip mode
   void setGsOnChip(bool gsOnChip) { m_gsOnChip = gsOnChip; }
 
@@ -324,6 +337,9 @@ public:
   // Get whether the output locations of the specified shader stage can be packed
   bool canPackOutput(ShaderStage shaderStage);
 
+  // Get whether 8-bit/16-bit GS outputs are packed two per dword in the GS-VS ring
+  bool canPack16BitGsOutput();
+
   // Set the flag to pack the input locations of the specified shader stage
   void setPackInput(ShaderStage shaderStage, bool pack) { m_inputPackState[shaderStage] = pack; }
 
@@ -466,12 +482,13 @@ private:
   void recordColorExportState(llvm::Module *module);
   void readColorExportState(llvm::Module *module);
 
-  // Graphics state (iastate, vpstate, rsstate) handling
+  // Graphics state (iastate, vpstate, rsstate, dsstate) handling
   void recordGraphicsState(llvm::Module *module);
   void readGraphicsState(llvm::Module *module);
 
   std::string m_lastError;                              // Error to be reported by getLastError()
   bool m_noReplayer = false;                            // True if no BuilderReplayer needed
+  bool m_useStateDirectly = false;                      // True if middle-end uses this state without IR round-trip
   bool m_emitLgc = false;                               // Whether -emit-lgc is on
   // Whether generating pipeline or unlinked part-pipeline
   PipelineLink m_pipelineLink = PipelineLink::WholePipeline;
@@ -488,6 +505,7 @@ private:
   llvm::SmallVector<std::unique_ptr<uint32_t[]>, 4> m_immutableValueAllocs;
 
   bool m_gsOnChip = false;                                                     // Whether to use GS on-chip mode
+  bool m_tessOffChip = false;                                                  // Whether to use tess off-chip mode
   NggControl m_nggControl = {};                                                // NGG control settings
   ShaderModes m_shaderModes;                                                   // Shader modes for this pipeline
   unsigned m_deviceIndex = 0;                                                  // Device index
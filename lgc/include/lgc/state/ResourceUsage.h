@@ -407,6 +407,11 @@ struct ResourceUsage {
       unsigned outputOrigLocs[MaxColorTargets];
 
       std::vector<FsInterpInfo> interpInfo;   // Array of interpolation info
+
+      // Map from generic input location info to the constants (printed as text) that replace those inputs, as
+      // propagated from the outputs of the last vertex processing stage
+      std::map<InOutLocationInfo, std::string> constInputs;
+
       BasicType outputTypes[MaxColorTargets]; // Array of basic types of fragment outputs
       unsigned cbShaderMask;                  // CB shader channel mask (correspond to register CB_SHADER_MASK)
       bool isNullFs;                          // Is null FS, so should set final cbShaderMask to 0
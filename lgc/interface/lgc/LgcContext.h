@@ -31,6 +31,7 @@
 #pragma once
 
 #include "llvm/ADT/StringRef.h"
+#include <string>
 
 namespace llvm {
 
@@ -157,6 +158,7 @@ private:
   static llvm::raw_ostream *m_llpcOuts;           // nullptr or stream for LLPC_OUTS
   llvm::LLVMContext &m_context;                   // LLVM context
   llvm::TargetMachine *m_targetMachine = nullptr; // Target machine
+  std::string m_targetMachineKey;                 // Key of the target machine in the target machine pool
   TargetInfo *m_targetInfo = nullptr;             // Target info
   unsigned m_palAbiVersion = 0xFFFFFFFF;          // PAL pipeline ABI version to compile for
   PassManagerCache *m_passManagerCache = nullptr; // Pass manager cache and creator
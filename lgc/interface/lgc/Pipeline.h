@@ -95,6 +95,11 @@ enum class WaveBreak : unsigned {
   _32x32 = 0x3,   ///< Outside a 32x32 pixel region
 };
 
+// Descriptor set and binding of the internal buffer holding the vertex attribute table read by the uber fetch
+// shader. Its entries are indexed by location, and have the layout of Vkgc::UberFetchShaderAttribInfo.
+static const unsigned UberFetchShaderTableSet = ~0U;
+static const unsigned UberFetchShaderTableBinding = 5;
+
 // Value for shadowDescriptorTable pipeline option.
 static const unsigned ShadowDescriptorTableDisable = ~0U;
 
@@ -127,6 +132,8 @@ struct Options {
   unsigned reserved1f;                 // Reserved for future functionality
   unsigned enableInterpModePatch; // Enable to do per-sample interpolation for nonperspective and smooth input
   unsigned pageMigrationEnabled;  // Enable page migration
+  unsigned enableUberFetchShader; // Fetch vertex inputs through the runtime attribute table in the internal buffer
+                                  //   rather than from the vertex input descriptions
 };
 
 // Middle-end per-shader options to pass to SetShaderOptions.
@@ -387,13 +394,26 @@ struct RasterizerState {
   unsigned usrClipPlaneMask;        // Mask to indicate the enabled user defined clip planes
 };
 
+// Compare operation of the depth or stencil test. The values match VkCompareOp.
+enum CompareFunc : unsigned {
+  CompareFuncNever = 0,
+  CompareFuncLess = 1,
+  CompareFuncEqual = 2,
+  CompareFuncLessEqual = 3,
+  CompareFuncGreater = 4,
+  CompareFuncNotEqual = 5,
+  CompareFuncGreaterEqual = 6,
+  CompareFuncAlways = 7,
+};
+
 // Struct to pass to depth/stencil state
 struct DepthStencilState {
-  bool depthTestEnable;           // Whether enable depth test
-  unsigned depthCompareOp;        // Depth compare operation
-  bool stencilTestEnable;         // Whether enable stencil test
-  unsigned stencilCompareOpFront; // Stencil compare operation for front face
-  unsigned stencilCompareOpBack;  // Stencil compare operation for back face
+  unsigned depthTestEnable;       // Whether enable depth test
+  unsigned depthCompareOp;        // Depth compare operation (CompareFunc)
+  unsigned stencilTestEnable;     // Whether enable stencil test
+  unsigned stencilCompareOpFront; // Stencil compare operation for front face (CompareFunc)
+  unsigned stencilCompareOpBack;  // Stencil compare operation for back face (CompareFunc)
+  unsigned depthBoundsTestEnable; // Whether enable depth bounds test
 };
 
 // =====================================================================================================================
@@ -262,6 +262,16 @@ void ConfigBuilderBase::setLdsSizeByteSize(Util::Abi::HardwareStage hwStage, uns
   hwShaderNode[Util::Abi::HardwareStageMetadataKey::LdsSize] = value;
 }
 
+// =====================================================================================================================
+// Set OFFCHIP_LDS_EN for given hardware shader stage
+//
+// @param hwStage : Hardware shader stage
+// @param value : Whether tessellation control outputs are stored in the off-chip LDS buffer
+void ConfigBuilderBase::setOffChipLdsEn(Util::Abi::HardwareStage hwStage, bool value) {
+  auto hwShaderNode = getHwShaderNode(hwStage);
+  hwShaderNode[Util::Abi::HardwareStageMetadataKey::OffchipLdsEn] = value;
+}
+
 // =====================================================================================================================
 // Set ES-GS LDS byte size
 //
@@ -282,6 +292,17 @@ void ConfigBuilderBase::setNggSubgroupSize(unsigned value) {
   m_pipelineNode[Util::Abi::PipelineMetadataKey::NggSubgroupSize] = value;
 }
 
+// =====================================================================================================================
+// Set the NGG culling decision, with the estimates of the cost model that led to it
+//
+// @param nggControl : NGG control settings
+void ConfigBuilderBase::setNggCulling(const NggControl &nggControl) {
+  auto cullingNode = m_pipelineNode[Util::Abi::PipelineMetadataKey::NggCulling].getMap(true);
+  cullingNode[Util::Abi::NggCullingMetadataKey::Enabled] = !nggControl.passthroughMode;
+  cullingNode[Util::Abi::NggCullingMetadataKey::EstimatedCost] = nggControl.cullingCost;
+  cullingNode[Util::Abi::NggCullingMetadataKey::EstimatedBenefit] = nggControl.cullingBenefit;
+}
+
 // =====================================================================================================================
 /// Append a single entry to the PAL register metadata.
 ///
@@ -326,6 +347,26 @@ bool ConfigBuilderBase::usesViewportArrayIndex() {
   return m_pipelineNode[Util::Abi::PipelineMetadataKey::UsesViewportArrayIndex].getBool();
 }
 
+// =====================================================================================================================
+// Check whether the depth/stencil result can never stop a fragment from being shaded in this pipeline, so that the
+// fragment shader's side effects are the same whether the tests run before or after it. This is the case when neither
+// the depth test nor the stencil test is enabled, or when every enabled test always passes, and the depth bounds test
+// is disabled. The depth/stencil state is only known in a whole-pipeline compile.
+bool ConfigBuilderBase::isFsUnaffectedByDepthStencil() {
+  if (!m_pipelineState->isWholePipeline())
+    return false;
+
+  const auto &dsState = m_pipelineState->getDepthStencilState();
+  if (dsState.depthBoundsTestEnable)
+    return false;
+  if (dsState.depthTestEnable && dsState.depthCompareOp != CompareFuncAlways)
+    return false;
+  if (dsState.stencilTestEnable &&
+      (dsState.stencilCompareOpFront != CompareFuncAlways || dsState.stencilCompareOpBack != CompareFuncAlways))
+    return false;
+  return true;
+}
+
 // =====================================================================================================================
 // Finish ConfigBuilder processing by writing into the PalMetadata document
 void ConfigBuilderBase::writePalMetadata() {
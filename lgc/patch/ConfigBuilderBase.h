@@ -45,6 +45,7 @@ class Module;
 namespace lgc {
 
 class PipelineState;
+struct NggControl;
 
 // Invalid metadata key and value which shouldn't be exported to ELF.
 constexpr unsigned InvalidMetadataKey = 0xFFFFFFFF;
@@ -79,14 +80,17 @@ protected:
   void setApiName(const char *value);
   void setPipelineType(Util::Abi::PipelineType value);
   void setLdsSizeByteSize(Util::Abi::HardwareStage hwStage, unsigned value);
+  void setOffChipLdsEn(Util::Abi::HardwareStage hwStage, bool value);
   void setEsGsLdsSize(unsigned value);
   void setNggSubgroupSize(unsigned value);
+  void setNggCulling(const NggControl &nggControl);
   unsigned setupFloatingPointMode(ShaderStage shaderStage);
 
   void appendConfig(llvm::ArrayRef<PalMetadataNoteEntry> config);
   void appendConfig(unsigned key, unsigned value);
 
   bool usesViewportArrayIndex();
+  bool isFsUnaffectedByDepthStencil();
 
   template <typename T> void appendConfig(const T &config) {
     static_assert(T::ContainsPalAbiMetadataOnly, "may only be used with structs that are fully metadata notes");
@@ -557,6 +557,7 @@ void ConfigBuilder::buildHsRegConfig(ShaderStage shaderStage, T *pConfig) {
   if (m_pipelineState->isTessOffChip()) {
     SET_REG_FIELD(&pConfig->hsRegs, SPI_SHADER_PGM_RSRC2_HS, OC_LDS_EN, true);
   }
+  setOffChipLdsEn(Util::Abi::HardwareStage::Hs, m_pipelineState->isTessOffChip());
 
   // Minimum and maximum tessellation factors supported by the hardware.
   constexpr float minTessFactor = 1.0f;
@@ -894,7 +895,10 @@ void ConfigBuilder::buildPsRegConfig(ShaderStage shaderStage, T *pConfig) {
   bool execOnHeirFail = false;
   if (fragmentMode.earlyFragmentTests)
     zOrder = EARLY_Z_THEN_LATE_Z;
-  else if (resUsage->resourceWrite) {
+  else if (resUsage->resourceWrite && !isFsUnaffectedByDepthStencil()) {
+    // NOTE: Resource writes must happen for fragments that later fail the depth/stencil tests, so we have to use late
+    // Z. If the tests can never fail in this pipeline, early Z is as good as late Z for the side effects, and we let
+    // the checks below choose the Z order.
     zOrder = LATE_Z;
     execOnHeirFail = true;
   } else if (shaderOptions.allowReZ)
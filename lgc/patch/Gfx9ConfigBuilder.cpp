@@ -1125,6 +1125,7 @@ void ConfigBuilder::buildLsHsRegConfig(ShaderStage shaderStage1, ShaderStage sha
   }
 
   setLdsSizeByteSize(Util::Abi::HardwareStage::Hs, ldsSizeInDwords * 4);
+  setOffChipLdsEn(Util::Abi::HardwareStage::Hs, m_pipelineState->isTessOffChip());
 
   // Minimum and maximum tessellation factors supported by the hardware.
   constexpr float minTessFactor = 1.0f;
@@ -1476,6 +1477,7 @@ void ConfigBuilder::buildPrimShaderRegConfig(ShaderStage shaderStage1, ShaderSta
   SET_REG_MOST_FIELD(&pConfig->primShaderRegs, VGT_GS_ONCHIP_CNTL, ES_VERTS_PER_SUBGRP, calcFactor.esVertsPerSubgroup);
   SET_REG_MOST_FIELD(&pConfig->primShaderRegs, VGT_GS_ONCHIP_CNTL, GS_PRIMS_PER_SUBGRP, calcFactor.gsPrimsPerSubgroup);
   setNggSubgroupSize(std::max(calcFactor.esVertsPerSubgroup, calcFactor.gsPrimsPerSubgroup));
+  setNggCulling(*nggControl);
 
   const unsigned gsInstPrimsInSubgrp = geometryMode.invocations > 1
                                            ? (calcFactor.gsPrimsPerSubgroup * geometryMode.invocations)
@@ -1818,7 +1820,10 @@ void ConfigBuilder::buildPsRegConfig(ShaderStage shaderStage, T *pConfig) {
   bool execOnHeirFail = false;
   if (fragmentMode.earlyFragmentTests)
     zOrder = EARLY_Z_THEN_LATE_Z;
-  else if (resUsage->resourceWrite) {
+  else if (resUsage->resourceWrite && !isFsUnaffectedByDepthStencil()) {
+    // NOTE: Resource writes must happen for fragments that later fail the depth/stencil tests, so we have to use late
+    // Z. If the tests can never fail in this pipeline, early Z is as good as late Z for the side effects, and we let
+    // the checks below choose the Z order.
     zOrder = LATE_Z;
     execOnHeirFail = true;
   } else if (shaderOptions.allowReZ)
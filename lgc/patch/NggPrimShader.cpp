@@ -3186,15 +3186,16 @@ Function *NggPrimShader::mutateGs(Module *module) {
         assert(call);
         m_builder->SetInsertPoint(call);
 
-        assert(call->arg_size() == 4);
+        assert(call->arg_size() == 5);
         const unsigned location = cast<ConstantInt>(call->getOperand(0))->getZExtValue();
         const unsigned compIdx = cast<ConstantInt>(call->getOperand(1))->getZExtValue();
         const unsigned streamId = cast<ConstantInt>(call->getOperand(2))->getZExtValue();
         assert(streamId < MaxGsStreams);
-        Value *output = call->getOperand(3);
+        const bool isHighHalf = cast<ConstantInt>(call->getOperand(3))->isOne();
+        Value *output = call->getOperand(4);
 
         auto emitVerts = m_builder->CreateLoad(m_builder->getInt32Ty(), emitVertsPtrs[streamId]);
-        exportGsOutput(output, location, compIdx, streamId, threadIdInSubgroup, emitVerts);
+        exportGsOutput(output, location, compIdx, streamId, isHighHalf, threadIdInSubgroup, emitVerts);
 
         removeCalls.push_back(call);
       }
@@ -3398,10 +3399,11 @@ Function *NggPrimShader::mutateCopyShader(Module *module) {
 // @param location : Location of the output
 // @param compIdx : Index used for vector element indexing
 // @param streamId : ID of output vertex stream
+// @param isHighHalf : Whether the 8-bit/16-bit output is packed to the high half of the dword
 // @param threadIdInSubgroup : Thread ID in sub-group
 // @param emitVerts : Counter of GS emitted vertices for this stream
 void NggPrimShader::exportGsOutput(Value *output, unsigned location, unsigned compIdx, unsigned streamId,
-                                   Value *threadIdInSubgroup, Value *emitVerts) {
+                                   bool isHighHalf, Value *threadIdInSubgroup, Value *emitVerts) {
   auto resUsage = m_pipelineState->getShaderResourceUsage(ShaderStageGeometry);
   if (resUsage->inOutUsage.gs.rasterStream != streamId) {
     // NOTE: Only export those outputs that belong to the rasterization stream.
@@ -3428,8 +3430,20 @@ void NggPrimShader::exportGsOutput(Value *output, unsigned location, unsigned co
   }
 
   const unsigned bitWidth = output->getType()->getScalarSizeInBits();
-  if (bitWidth == 8 || bitWidth == 16) {
-    // NOTE: Currently, to simplify the design of load/store data from GS-VS ring, we always extend byte/word
+  unsigned halfOffset = 0;
+  if ((bitWidth == 8 || bitWidth == 16) && m_pipelineState->canPack16BitGsOutput()) {
+    // NOTE: When 8-bit/16-bit outputs are packed, two of them share one dword of GS-VS ring and each is written as
+    // a word to the low or high half. Copy shader still reads the dword, which is unpacked by FS.
+    assert(!outputTy->isVectorTy());
+    if (outputTy->isFloatingPointTy()) {
+      assert(bitWidth == 16);
+      output = m_builder->CreateBitCast(output, m_builder->getInt16Ty());
+    } else if (bitWidth == 8) {
+      output = m_builder->CreateZExt(output, m_builder->getInt16Ty());
+    }
+    halfOffset = isHighHalf ? 2 : 0;
+  } else if (bitWidth == 8 || bitWidth == 16) {
+    // NOTE: Unless they are packed, to simplify the design of load/store data from GS-VS ring, we extend byte/word
     // to dword. This is because copy shader does not know the actual data type. It only generates output
     // export calls based on number of dwords.
     if (outputTy->isFPOrFPVectorTy()) {
@@ -3452,10 +3466,10 @@ void NggPrimShader::exportGsOutput(Value *output, unsigned location, unsigned co
   auto vertexId = m_builder->CreateMul(threadIdInSubgroup, m_builder->getInt32(geometryMode.outputVertices));
   vertexId = m_builder->CreateAdd(vertexId, emitVerts);
 
-  // ldsOffset = vertexOffset + (location * 4 + compIdx) * 4 (in bytes)
+  // ldsOffset = vertexOffset + (location * 4 + compIdx) * 4 + halfOffset (in bytes)
   auto vertexOffset = calcVertexItemOffset(streamId, vertexId);
   const unsigned attribOffset = (location * 4) + compIdx;
-  auto ldsOffset = m_builder->CreateAdd(vertexOffset, m_builder->getInt32(attribOffset * 4));
+  auto ldsOffset = m_builder->CreateAdd(vertexOffset, m_builder->getInt32(attribOffset * 4 + halfOffset));
 
   m_ldsManager->writeValueToLds(output, ldsOffset);
 }
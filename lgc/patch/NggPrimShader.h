@@ -190,7 +190,7 @@ private:
 
   llvm::Function *mutateCopyShader(llvm::Module *module);
 
-  void exportGsOutput(llvm::Value *output, unsigned location, unsigned compIdx, unsigned streamId,
+  void exportGsOutput(llvm::Value *output, unsigned location, unsigned compIdx, unsigned streamId, bool isHighHalf,
                       llvm::Value *threadIdInSubgroup, llvm::Value *emitVerts);
 
   llvm::Value *importGsOutput(llvm::Type *outputTy, unsigned location, unsigned streamId, llvm::Value *vertexOffset);
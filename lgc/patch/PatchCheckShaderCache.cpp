@@ -69,6 +69,47 @@ static void streamMapEntries(MapType &map, raw_ostream &stream) {
   }
 }
 
+// =====================================================================================================================
+// Stream a value for later inclusion in a hash
+//
+// @param value : Value to stream
+// @param [in/out] stream : Stream to output the value to
+template <typename T> static void streamValue(const T &value, raw_ostream &stream) {
+  stream << StringRef(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// =====================================================================================================================
+// Stream the state that decides how the pre-rasterization shader stages are laid out in the merged hardware stages,
+// for later inclusion in a hash. The code of one merged hardware stage depends on it, even where it comes from a shader
+// stage compiled into another hardware stage.
+//
+// @param pipelineState : Pipeline state
+// @param [in/out] stream : Stream to output the state to
+static void streamHwStageLayout(PipelineState *pipelineState, raw_ostream &stream) {
+  auto stageMask = pipelineState->getShaderStageMask();
+  if (stageMask & shaderStageToMask(ShaderStageTessControl)) {
+    streamValue(pipelineState->isTessOffChip(), stream);
+    auto &tcsCalcFactor = pipelineState->getShaderResourceUsage(ShaderStageTessControl)->inOutUsage.tcs.calcFactor;
+    streamValue(tcsCalcFactor, stream);
+  }
+
+  if (stageMask & shaderStageToMask(ShaderStageGeometry)) {
+    streamValue(pipelineState->isGsOnChip(), stream);
+    auto &gsCalcFactor = pipelineState->getShaderResourceUsage(ShaderStageGeometry)->inOutUsage.gs.calcFactor;
+    streamValue(gsCalcFactor.esGsRingItemSize, stream);
+    streamValue(gsCalcFactor.gsVsRingItemSize, stream);
+    streamValue(gsCalcFactor.esVertsPerSubgroup, stream);
+    streamValue(gsCalcFactor.gsPrimsPerSubgroup, stream);
+    streamValue(gsCalcFactor.esGsLdsSize, stream);
+    streamValue(gsCalcFactor.gsOnChipLdsSize, stream);
+    streamValue(gsCalcFactor.inputVertices, stream);
+    streamValue(gsCalcFactor.primAmpFactor, stream);
+    streamValue(gsCalcFactor.enableMaxVertOut, stream);
+  }
+
+  streamValue(pipelineState->getNggControl()->enableNgg, stream);
+}
+
 } // namespace
 
 // =====================================================================================================================
@@ -147,6 +188,22 @@ bool PatchCheckShaderCache::runImpl(Module &module, PipelineState *pipelineState
       streamMapEntries(resUsage->inOutUsage.gs.builtInOutLocs, stream);
     }
 
+    if (stage == ShaderStageFragment) {
+      // NOTE: Constant outputs of the previous shader stage are folded into the fragment shader in place of its
+      // inputs. We have to add them to shader hash calculation.
+      streamValue(resUsage->inOutUsage.fs.constInputs.size(), stream);
+      for (const auto &constInput : resUsage->inOutUsage.fs.constInputs) {
+        streamValue(constInput.first, stream);
+        stream << constInput.second << '\0';
+      }
+    }
+
+    if (stage != ShaderStageFragment) {
+      // NOTE: The shader cache may keep the hardware stages of the pre-rasterization shader stages apart. We have to
+      // add the layout of those hardware stages to shader hash calculation.
+      streamHwStageLayout(pipelineState, stream);
+    }
+
     // Store the result of the hash for this shader stage.
     stream.flush();
     inOutUsageValues[stage] = ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(inOutUsageStreams[stage].data()),
@@ -359,12 +359,14 @@ void PatchCopyShader::collectGsGenericOutputInfo(Function *gsEntryPoint) {
           continue;
         visitedLocInfos.insert(origLocInfo);
 
-        // Each output call is scalarized and exports 4 bytes for packing
+        // Each output call is scalarized and exports 4 bytes for packing. Packed 8-bit/16-bit outputs may share the
+        // same component, so the byte size is determined by the highest mapped component.
         unsigned byteSize = 4;
         auto &newLocByteSizesMap = m_newLocByteSizesMapArray[origLocInfo.getStreamId()];
         const unsigned newLoc = locInfoMapIt->second.getLocation();
         if (m_pipelineState->canPackOutput(ShaderStageGeometry)) {
-          newLocByteSizesMap[newLoc] += byteSize;
+          byteSize *= locInfoMapIt->second.getComponent() + 1;
+          newLocByteSizesMap[newLoc] = std::max(newLocByteSizesMap[newLoc], byteSize);
         } else {
           unsigned compCount = 1;
           auto compTy = outputTy;
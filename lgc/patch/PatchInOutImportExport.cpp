@@ -37,9 +37,11 @@
 #include "lgc/util/Debug.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/InlineAsm.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 
 #define DEBUG_TYPE "lgc-patch-in-out-import-export"
 
@@ -180,6 +182,15 @@ bool PatchInOutImportExport::runImpl(Module &module, PipelineShadersResult &pipe
     break;
   }
 
+  // Find tessellation levels that TCS writes as compile-time constants, so that TES reads of them can be folded
+  // before TES is processed.
+  std::fill_n(&m_constTessLevels[0][0], 2 * 4, nullptr);
+  m_foldTessLevels[0] = m_foldTessLevels[1] = false;
+  if (m_hasTs) {
+    collectConstTessLevels(pipelineShaders.getEntryPoint(ShaderStageTessControl),
+                           pipelineShaders.getEntryPoint(ShaderStageTessEval));
+  }
+
   // Process each shader in turn, in reverse order (because for example VS uses inOutUsage.tcs.calcFactor
   // set by TCS).
   for (int shaderStage = ShaderStageCountInternal - 1; shaderStage >= 0; --shaderStage) {
@@ -346,21 +357,7 @@ void PatchInOutImportExport::processShader() {
       const unsigned outVertexCount =
           hasTcs ? m_pipelineState->getShaderModes()->getTessellationMode().outputVertices : MaxTessPatchVertices;
 
-      unsigned tessFactorStride = 0;
-      switch (m_pipelineState->getShaderModes()->getTessellationMode().primitiveMode) {
-      case PrimitiveMode::Triangles:
-        tessFactorStride = 4;
-        break;
-      case PrimitiveMode::Quads:
-        tessFactorStride = 6;
-        break;
-      case PrimitiveMode::Isolines:
-        tessFactorStride = 2;
-        break;
-      default:
-        llvm_unreachable("Should never be called!");
-        break;
-      }
+      const unsigned tessFactorStride = m_pipelineState->getTessFactorStride();
 
       calcFactor.inVertexStride = inLocCount * 4;
       calcFactor.outVertexStride = outLocCount * 4;
@@ -369,9 +366,9 @@ void PatchInOutImportExport::processShader() {
           hasTcs ? tcsInOutUsage.perPatchOutputMapLocCount : tesInOutUsage.perPatchInputMapLocCount;
       calcFactor.patchConstSize = patchConstCount * 4;
 
-      calcFactor.patchCountPerThreadGroup =
-          calcPatchCountPerThreadGroup(inVertexCount, calcFactor.inVertexStride, outVertexCount,
-                                       calcFactor.outVertexStride, patchConstCount, tessFactorStride);
+      calcFactor.patchCountPerThreadGroup = m_pipelineState->calcPatchCountPerThreadGroup(
+          m_pipelineState->isTessOffChip(), inVertexCount, calcFactor.inVertexStride, outVertexCount,
+          calcFactor.outVertexStride, patchConstCount, tessFactorStride);
 
       const unsigned inPatchSize = inVertexCount * calcFactor.inVertexStride;
       const unsigned inPatchTotalSize = calcFactor.patchCountPerThreadGroup * inPatchSize;
@@ -418,11 +415,9 @@ void PatchInOutImportExport::processShader() {
         break;
       case PrimitiveMode::Quads:
         LLPC_OUTS("quads");
-        tessFactorStride = 6;
         break;
       case PrimitiveMode::Isolines:
         LLPC_OUTS("isolines");
-        tessFactorStride = 2;
         break;
       default:
         llvm_unreachable("Should never be called!");
@@ -898,6 +893,7 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
       unsigned loc = InvalidValue;
       Value *locOffset = nullptr;
       unsigned elemIdx = InvalidValue;
+      bool isHighHalf = false;
 
       InOutLocationInfo origLocInfo;
       origLocInfo.setLocation(value);
@@ -947,6 +943,7 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
             // Dynamic indexing related locations just use the location for mapping
             if (!relateDynIndex)
               elemIdx = locInfoMapIt->second.getComponent();
+            isHighHalf = locInfoMapIt->second.isHighHalf();
             exist = true;
           } else {
             exist = false;
@@ -992,7 +989,7 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
           if (elemIdx == InvalidValue)
             elemIdx = cast<ConstantInt>(callInst.getOperand(1))->getZExtValue();
           const unsigned streamId = cast<ConstantInt>(callInst.getOperand(2))->getZExtValue();
-          patchGsGenericOutputExport(output, loc, elemIdx, streamId, &callInst);
+          patchGsGenericOutputExport(output, loc, elemIdx, streamId, isHighHalf, &callInst);
           break;
         }
         case ShaderStageFragment: {
@@ -1032,7 +1029,7 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
         unsigned loc = builtInOutLocMap[BuiltInViewIndex];
 
         auto rasterStream = resUsage->inOutUsage.gs.rasterStream;
-        storeValueToGsVsRing(viewIndex, loc, 0, rasterStream, &callInst);
+        storeValueToGsVsRing(viewIndex, loc, 0, rasterStream, false, &callInst);
       }
 
       unsigned emitStream = InvalidValue;
@@ -1971,9 +1968,10 @@ void PatchInOutImportExport::patchTesGenericOutputExport(Value *output, unsigned
 // @param location : Location of the output
 // @param compIdx : Index used for vector element indexing
 // @param streamId : ID of output vertex stream
+// @param isHighHalf : Whether the 8-bit/16-bit output is packed to the high half of the dword
 // @param insertPos : Where to insert the patch instruction
 void PatchInOutImportExport::patchGsGenericOutputExport(Value *output, unsigned location, unsigned compIdx,
-                                                        unsigned streamId, Instruction *insertPos) {
+                                                        unsigned streamId, bool isHighHalf, Instruction *insertPos) {
   auto outputTy = output->getType();
 
   // Cast double or double vector to float vector.
@@ -1993,15 +1991,16 @@ void PatchInOutImportExport::patchGsGenericOutputExport(Value *output, unsigned
     assert(bitWidth == 8 || bitWidth == 16 || bitWidth == 32);
 
   const unsigned compCount = outputTy->isVectorTy() ? cast<FixedVectorType>(outputTy)->getNumElements() : 1;
-  // NOTE: Currently, to simplify the design of load/store data from GS-VS ring, we always extend byte/word to dword and
-  // store dword to GS-VS ring. So for 8-bit/16-bit data type, the actual byte size is based on number of dwords.
+  // NOTE: Unless 8-bit/16-bit outputs are packed, to simplify the design of load/store data from GS-VS ring, we extend
+  // byte/word to dword and store dword to GS-VS ring. So for 8-bit/16-bit data type, the actual byte size is based on
+  // number of dwords.
   unsigned byteSize = (outputTy->getScalarSizeInBits() / 8) * compCount;
-  if (bitWidth == 8 || bitWidth == 16)
+  if ((bitWidth == 8 || bitWidth == 16) && !m_pipelineState->canPack16BitGsOutput())
     byteSize *= (32 / bitWidth);
 
   assert(compIdx <= 4);
 
-  storeValueToGsVsRing(output, location, compIdx, streamId, insertPos);
+  storeValueToGsVsRing(output, location, compIdx, streamId, isHighHalf, insertPos);
 }
 
 // =====================================================================================================================
@@ -2197,6 +2196,12 @@ Value *PatchInOutImportExport::patchTesBuiltInInputImport(Type *inputTy, unsigne
   }
   case BuiltInTessLevelOuter:
   case BuiltInTessLevelInner: {
+    // Tessellation levels written as compile-time constants by TCS are folded rather than read from LDS.
+    if (Constant *constTessLevel = getConstTessLevel(builtInId, inputTy, elemIdx)) {
+      input = constTessLevel;
+      break;
+    }
+
     assert(perPatchBuiltInInLocMap.find(builtInId) != perPatchBuiltInInLocMap.end());
     unsigned loc = perPatchBuiltInInLocMap[builtInId];
 
@@ -3286,7 +3291,7 @@ void PatchInOutImportExport::patchGsBuiltInOutputExport(Value *output, unsigned
   }
 
   (void(builtInUsage)); // unused
-  storeValueToGsVsRing(output, loc, 0, streamId, insertPos);
+  storeValueToGsVsRing(output, loc, 0, streamId, false, insertPos);
 }
 
 // =====================================================================================================================
@@ -4031,9 +4036,10 @@ Value *PatchInOutImportExport::loadValueFromEsGsRing(Type *loadTy, unsigned loca
 // @param location : Output location
 // @param compIdx : Output component index
 // @param streamId : Output stream ID
+// @param isHighHalf : Whether the 8-bit/16-bit value is packed to the high half of the dword
 // @param insertPos : Where to insert the store instruction
 void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned location, unsigned compIdx,
-                                                  unsigned streamId, Instruction *insertPos) {
+                                                  unsigned streamId, bool isHighHalf, Instruction *insertPos) {
   auto storeTy = storeValue->getType();
 
   Type *elemTy = storeTy;
@@ -4050,7 +4056,8 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
     // real instructions when when NGG primitive shader is generated.
     Value *args[] = {ConstantInt::get(Type::getInt32Ty(*m_context), location),
                      ConstantInt::get(Type::getInt32Ty(*m_context), compIdx),
-                     ConstantInt::get(Type::getInt32Ty(*m_context), streamId), storeValue};
+                     ConstantInt::get(Type::getInt32Ty(*m_context), streamId),
+                     ConstantInt::getBool(*m_context, isHighHalf), storeValue};
     std::string callName = lgcName::NggGsOutputExport + getTypeName(storeTy);
     emitCall(callName, Type::getVoidTy(*m_context), args, {}, insertPos);
     return;
@@ -4069,10 +4076,20 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
             ExtractElementInst::Create(storeValue, ConstantInt::get(Type::getInt32Ty(*m_context), i), "", insertPos);
       }
 
-      storeValueToGsVsRing(storeElem, location + (compIdx + i) / 4, (compIdx + i) % 4, streamId, insertPos);
+      storeValueToGsVsRing(storeElem, location + (compIdx + i) / 4, (compIdx + i) % 4, streamId, false, insertPos);
     }
   } else {
-    if (bitWidth == 8 || bitWidth == 16) {
+    // NOTE: When 8-bit/16-bit outputs are packed, two of them share one dword of GS-VS ring and each is stored as a
+    // word to the low or high half. Copy shader still loads and exports the dword, which is unpacked by FS.
+    const bool packWord = (bitWidth == 8 || bitWidth == 16) && m_pipelineState->canPack16BitGsOutput();
+    if (packWord) {
+      if (storeTy->isFloatingPointTy()) {
+        assert(bitWidth == 16);
+        storeValue = new BitCastInst(storeValue, Type::getInt16Ty(*m_context), "", insertPos);
+      } else if (bitWidth == 8) {
+        storeValue = new ZExtInst(storeValue, Type::getInt16Ty(*m_context), "", insertPos);
+      }
+    } else if (bitWidth == 8 || bitWidth == 16) {
       // NOTE: Currently, to simplify the design of load/store data from GS-VS ring, we always extend byte/word
       // to dword. This is because copy shader does not know the actual data type. It only generates output
       // export calls based on number of dwords.
@@ -4098,17 +4115,37 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
     auto ringOffset = calcGsVsRingOffsetForOutput(location, compIdx, streamId, emitCounter, gsVsOffset, insertPos);
 
     if (m_pipelineState->isGsOnChip()) {
+      if (packWord) {
+        // Ring offset is in dwords, index the LDS as words
+        ringOffset = BinaryOperator::CreateShl(ringOffset, ConstantInt::get(Type::getInt32Ty(*m_context), 1), "",
+                                               insertPos);
+        if (isHighHalf) {
+          ringOffset =
+              BinaryOperator::CreateAdd(ringOffset, ConstantInt::get(Type::getInt32Ty(*m_context), 1), "", insertPos);
+        }
+        Type *wordPtrTy = Type::getInt16PtrTy(*m_context, m_lds->getType()->getPointerAddressSpace());
+        Value *ldsPtr = new BitCastInst(m_lds, wordPtrTy, "", insertPos);
+        Value *storePtr = GetElementPtrInst::Create(Type::getInt16Ty(*m_context), ldsPtr, ringOffset, "", insertPos);
+        new StoreInst(storeValue, storePtr, false, Align(2), insertPos);
+        return;
+      }
       Value *idxs[] = {ConstantInt::get(Type::getInt32Ty(*m_context), 0), ringOffset};
       auto ldsType = m_lds->getType()->getPointerElementType();
       Value *storePtr = GetElementPtrInst::Create(ldsType, m_lds, idxs, "", insertPos);
       new StoreInst(storeValue, storePtr, false, m_lds->getAlign().getValue(), insertPos);
     } else {
+      // Ring offset is in bytes, the high half is at the next word of the dword
+      if (packWord && isHighHalf) {
+        ringOffset =
+            BinaryOperator::CreateAdd(ringOffset, ConstantInt::get(Type::getInt32Ty(*m_context), 2), "", insertPos);
+      }
+      const char *storeName = packWord ? "llvm.amdgcn.raw.tbuffer.store.i16" : "llvm.amdgcn.raw.tbuffer.store.i32";
       // NOTE: Here we use tbuffer_store instruction instead of buffer_store because we have to do explicit
       // control of soffset. This is required by swizzle enabled mode when address range checking should be
       // complied with.
       if (m_gfxIp.major <= 9) {
         CombineFormat combineFormat = {};
-        combineFormat.bits.dfmt = BUF_DATA_FORMAT_32;
+        combineFormat.bits.dfmt = packWord ? BUF_DATA_FORMAT_16 : BUF_DATA_FORMAT_32;
         combineFormat.bits.nfmt = BUF_NUM_FORMAT_UINT;
         CoherentFlag coherent = {};
         coherent.bits.glc = true;
@@ -4122,7 +4159,7 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
             ConstantInt::get(Type::getInt32Ty(*m_context), combineFormat.u32All),
             ConstantInt::get(Type::getInt32Ty(*m_context), coherent.u32All) // glc, slc, swz
         };
-        emitCall("llvm.amdgcn.raw.tbuffer.store.i32", Type::getVoidTy(*m_context), args, {}, insertPos);
+        emitCall(storeName, Type::getVoidTy(*m_context), args, {}, insertPos);
       } else {
         CoherentFlag coherent = {};
         coherent.bits.glc = true;
@@ -4133,10 +4170,10 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
             m_pipelineSysValues.get(m_entryPoint)->getGsVsRingBufDesc(streamId), // rsrc
             ringOffset,                                                          // voffset
             gsVsOffset,                                                          // soffset
-            ConstantInt::get(Type::getInt32Ty(*m_context), BUF_FORMAT_32_UINT),  // format
-            ConstantInt::get(Type::getInt32Ty(*m_context), coherent.u32All)      // glc, slc, swz
+            ConstantInt::get(Type::getInt32Ty(*m_context), packWord ? BUF_FORMAT_16_UINT : BUF_FORMAT_32_UINT),
+            ConstantInt::get(Type::getInt32Ty(*m_context), coherent.u32All) // glc, slc, swz
         };
-        emitCall("llvm.amdgcn.raw.tbuffer.store.i32", Type::getVoidTy(*m_context), args, {}, insertPos);
+        emitCall(storeName, Type::getVoidTy(*m_context), args, {}, insertPos);
       }
     }
   }
@@ -4932,99 +4969,6 @@ Value *PatchInOutImportExport::calcLdsOffsetForTesInput(Type *inputTy, unsigned
   return ldsOffset;
 }
 
-// =====================================================================================================================
-// Calculates the patch count for per-thread group.
-//
-// @param inVertexCount : Count of vertices of input patch
-// @param inVertexStride : Vertex stride of input patch in (dwords)
-// @param outVertexCount : Count of vertices of output patch
-// @param outVertexStride : Vertex stride of output patch in (dwords)
-// @param patchConstCount : Count of output patch constants
-// @param tessFactorStride : Stride of tessellation factors (dwords)
-unsigned PatchInOutImportExport::calcPatchCountPerThreadGroup(unsigned inVertexCount, unsigned inVertexStride,
-                                                              unsigned outVertexCount, unsigned outVertexStride,
-                                                              unsigned patchConstCount,
-                                                              unsigned tessFactorStride) const {
-  const unsigned waveSize = m_pipelineState->getShaderWaveSize(m_shaderStage);
-
-  // NOTE: The limit of thread count for tessellation control shader is 4 wavefronts per thread group.
-  const unsigned maxThreadCountPerThreadGroup = (4 * waveSize);
-  const unsigned maxThreadCountPerPatch = std::max(inVertexCount, outVertexCount);
-  const unsigned patchCountLimitedByThread = maxThreadCountPerThreadGroup / maxThreadCountPerPatch;
-
-  const unsigned inPatchSize = (inVertexCount * inVertexStride);
-  const unsigned outPatchSize = (outVertexCount * outVertexStride);
-  const unsigned patchConstSize = patchConstCount * 4;
-
-  // Compute the required LDS size per patch, always include the space for VS vertex out
-  unsigned ldsSizePerPatch = inPatchSize;
-  unsigned patchCountLimitedByLds =
-      (m_pipelineState->getTargetInfo().getGpuProperty().ldsSizePerThreadGroup / ldsSizePerPatch);
-
-  unsigned patchCountPerThreadGroup = std::min(patchCountLimitedByThread, patchCountLimitedByLds);
-
-  // NOTE: Performance analysis shows that 16 patches per thread group is an optimal upper-bound. The value is only
-  // an experimental number. For GFX9. 64 is an optimal number instead.
-  const unsigned optimalPatchCountPerThreadGroup = m_gfxIp.major >= 9 ? 64 : 16;
-
-  patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, optimalPatchCountPerThreadGroup);
-
-  if (m_pipelineState->isTessOffChip()) {
-    auto outPatchLdsBufferSize = (outPatchSize + patchConstSize) * 4;
-    auto tessOffChipPatchCountPerThreadGroup =
-        m_pipelineState->getTargetInfo().getGpuProperty().tessOffChipLdsBufferSize / outPatchLdsBufferSize;
-    patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, tessOffChipPatchCountPerThreadGroup);
-  }
-
-  // TF-Buffer-based limit for Patchers per Thread Group:
-  // ---------------------------------------------------------------------------------------------
-
-  // There is one TF Buffer per shader engine. We can do the below calculation on a per-SE basis.  It is also safe to
-  // assume that one thread-group could at most utilize all of the TF Buffer.
-  const unsigned tfBufferSizeInBytes =
-      sizeof(unsigned) * m_pipelineState->getTargetInfo().getGpuProperty().tessFactorBufferSizePerSe;
-  unsigned tfBufferPatchCountLimit = tfBufferSizeInBytes / (tessFactorStride * sizeof(unsigned));
-
-  const auto workarounds = &m_pipelineState->getTargetInfo().getGpuWorkarounds();
-  if (workarounds->gfx10.waTessFactorBufferSizeLimitGeUtcl1Underflow) {
-    tfBufferPatchCountLimit /= 2;
-  }
-
-  patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, tfBufferPatchCountLimit);
-
-  if (m_pipelineState->isTessOffChip()) {
-    // For all-offchip tessellation, we need to write an additional 4-byte TCS control word to the TF buffer whenever
-    // the patch-ID is zero.
-    const unsigned offChipTfBufferPatchCountLimit =
-        (tfBufferSizeInBytes - (patchCountPerThreadGroup * sizeof(unsigned))) / (tessFactorStride * sizeof(unsigned));
-    patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, offChipTfBufferPatchCountLimit);
-  }
-
-  // Adjust the patches-per-thread-group based on hardware workarounds.
-  if (m_pipelineState->getTargetInfo().getGpuWorkarounds().gfx6.miscLoadBalancePerWatt != 0) {
-    const unsigned waveSize = m_pipelineState->getTargetInfo().getGpuProperty().waveSize;
-    // Load balance per watt is a mechanism which monitors HW utilization (num waves active, instructions issued
-    // per cycle, etc.) to determine if the HW can handle the workload with fewer CUs enabled.  The SPI_LB_CU_MASK
-    // register directs the SPI to stop launching waves to a CU so it will be clock-gated.  There is a bug in the
-    // SPI which where that register setting is applied immediately, which causes any pending LS/HS/CS waves on
-    // that CU to never be launched.
-    //
-    // The workaround is to limit each LS/HS threadgroup to a single wavefront: if there's only one wave, then the
-    // CU can safely be turned off afterwards.  A microcode fix exists for CS but for GFX it was decided that the
-    // cost in power efficiency wasn't worthwhile.
-    //
-    // Clamping to threads-per-wavefront / max(input control points, threads-per-patch) will make the hardware
-    // launch a single LS/HS wave per thread-group.
-    // For vulkan, threads-per-patch is always equal with outVertexCount.
-    const unsigned maxThreadCountPerPatch = std::max(inVertexCount, outVertexCount);
-    const unsigned maxPatchCount = waveSize / maxThreadCountPerPatch;
-
-    patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, maxPatchCount);
-  }
-
-  return patchCountPerThreadGroup;
-}
-
 // =====================================================================================================================
 // Inserts "exp" instruction to export generic output.
 //
@@ -5708,6 +5652,164 @@ void PatchInOutImportExport::exportVertexAttribs(Instruction *insertPos) {
   }
 }
 
+// =====================================================================================================================
+// Collects the elements of gl_TessLevelOuter/gl_TessLevelInner that TCS writes as compile-time constants, and decides
+// whether all TES reads of them can be folded to those constants (in which case TCS no longer needs to pass them to
+// TES through LDS).
+//
+// @param tcsEntryPoint : Entry-point of tessellation control shader (could be null)
+// @param tesEntryPoint : Entry-point of tessellation evaluation shader (could be null)
+void PatchInOutImportExport::collectConstTessLevels(Function *tcsEntryPoint, Function *tesEntryPoint) {
+  if (!tcsEntryPoint || !tesEntryPoint)
+    return;
+
+  static const BuiltInKind TessLevelBuiltIns[2] = {BuiltInTessLevelOuter, BuiltInTessLevelInner};
+  static const unsigned TessLevelCounts[2] = {4, 2};
+
+  for (unsigned i = 0; i < 2; ++i) {
+    const StringRef builtInName = PipelineState::getBuiltInName(TessLevelBuiltIns[i]);
+    const std::string exportName = (Twine(lgcName::OutputExportBuiltIn) + builtInName).str();
+    const std::string importName = (Twine(lgcName::InputImportBuiltIn) + builtInName).str();
+
+    Constant **constTessLevels = m_constTessLevels[i];
+    bool isVarying[4] = {};
+    auto recordTessLevel = [&](unsigned elem, Constant *value) {
+      // An element is only treated as constant if all writes to it store the same defined constant.
+      if (!value || isa<UndefValue>(value) || (constTessLevels[elem] && constTessLevels[elem] != value))
+        isVarying[elem] = true;
+      else
+        constTessLevels[elem] = value;
+    };
+
+    // TCS: @lgc.output.export.builtin.TessLevel*.%Type%(i32 builtInId, i32 elemIdx, i32 vertexIdx, %Type% outputValue)
+    for (Function &func : *m_module) {
+      if (!func.isDeclaration() || !func.getName().startswith(exportName))
+        continue;
+
+      for (User *user : func.users()) {
+        auto call = cast<CallInst>(user);
+        Value *elemIdx = call->getArgOperand(1);
+        Value *output = call->getArgOperand(3);
+        auto constElemIdx = dyn_cast<ConstantInt>(elemIdx);
+        if (call->getFunction() == tcsEntryPoint && isDontCareValue(elemIdx)) {
+          Constant *constOutput = dyn_cast<Constant>(output);
+          for (unsigned elem = 0; elem < TessLevelCounts[i]; ++elem)
+            recordTessLevel(elem, constOutput ? constOutput->getAggregateElement(elem) : nullptr);
+        } else if (call->getFunction() == tcsEntryPoint && constElemIdx &&
+                   constElemIdx->getZExtValue() < TessLevelCounts[i]) {
+          recordTessLevel(constElemIdx->getZExtValue(), dyn_cast<Constant>(output));
+        } else {
+          // Writes with dynamic indexing or outside of the entry-point are not analyzed.
+          std::fill_n(isVarying, TessLevelCounts[i], true);
+        }
+      }
+    }
+
+    for (unsigned elem = 0; elem < TessLevelCounts[i]; ++elem) {
+      if (isVarying[elem])
+        constTessLevels[elem] = nullptr;
+    }
+
+    // TES: @lgc.input.import.builtin.TessLevel*.%Type%(i32 builtInId, i32 elemIdx, i32 vertexIdx)
+    bool foldTessLevels = true;
+    for (Function &func : *m_module) {
+      if (!func.isDeclaration() || !func.getName().startswith(importName))
+        continue;
+
+      for (User *user : func.users()) {
+        auto call = cast<CallInst>(user);
+        Value *elemIdx = nullptr;
+        if (call->arg_size() > 1)
+          elemIdx = isDontCareValue(call->getArgOperand(1)) ? nullptr : call->getArgOperand(1);
+        if (call->getFunction() != tesEntryPoint || !getConstTessLevel(TessLevelBuiltIns[i], call->getType(), elemIdx))
+          foldTessLevels = false;
+      }
+    }
+    m_foldTessLevels[i] = foldTessLevels;
+  }
+}
+
+// =====================================================================================================================
+// Gets the compile-time constant value of gl_TessLevelOuter/gl_TessLevelInner (or an element of it) written by TCS.
+// Returns null if the value is not known to be a constant.
+//
+// @param builtInId : ID of the built-in (TessLevelOuter or TessLevelInner)
+// @param tessLevelTy : Type of the tessellation level value being read
+// @param elemIdx : Index used for array element indexing (could be null)
+Constant *PatchInOutImportExport::getConstTessLevel(unsigned builtInId, Type *tessLevelTy, Value *elemIdx) {
+  assert(builtInId == BuiltInTessLevelOuter || builtInId == BuiltInTessLevelInner);
+  Constant *const *constTessLevels = m_constTessLevels[builtInId == BuiltInTessLevelOuter ? 0 : 1];
+
+  if (!elemIdx) {
+    // gl_TessLevelOuter[4] or gl_TessLevelInner[2] is read as a whole
+    auto arrayTy = dyn_cast<ArrayType>(tessLevelTy);
+    if (!arrayTy || arrayTy->getNumElements() > 4)
+      return nullptr;
+
+    SmallVector<Constant *, 4> elems;
+    for (unsigned i = 0; i < arrayTy->getNumElements(); ++i) {
+      if (!constTessLevels[i] || constTessLevels[i]->getType() != arrayTy->getElementType())
+        return nullptr;
+      elems.push_back(constTessLevels[i]);
+    }
+    return ConstantArray::get(arrayTy, elems);
+  }
+
+  auto constElemIdx = dyn_cast<ConstantInt>(elemIdx);
+  if (!constElemIdx || constElemIdx->getZExtValue() >= 4)
+    return nullptr;
+
+  Constant *constTessLevel = constTessLevels[constElemIdx->getZExtValue()];
+  if (!constTessLevel || constTessLevel->getType() != tessLevelTy)
+    return nullptr;
+  return constTessLevel;
+}
+
+// =====================================================================================================================
+// Checks whether the given TCS value is known to be the same for all invocations of a patch. This is a conservative
+// check that only accepts constants, SGPR entry-point arguments and values computed from them by lane-independent
+// operations, including loads from constant memory.
+//
+// @param value : Value to check
+// @param depth : Current recursion depth
+bool PatchInOutImportExport::isPatchUniform(Value *value, unsigned depth) {
+  static const unsigned MaxDepth = 8;
+
+  if (isa<Constant>(value))
+    return true;
+
+  if (auto arg = dyn_cast<Argument>(value))
+    return arg->getParent() == m_entryPoint && arg->hasInRegAttr();
+
+  auto inst = dyn_cast<Instruction>(value);
+  if (!inst || depth >= MaxDepth)
+    return false;
+
+  if (auto load = dyn_cast<LoadInst>(inst)) {
+    if (load->getPointerAddressSpace() != ADDR_SPACE_CONST && !load->getMetadata(LLVMContext::MD_invariant_load))
+      return false;
+    return isPatchUniform(load->getPointerOperand(), depth + 1);
+  }
+
+  if (auto intrinsic = dyn_cast<IntrinsicInst>(inst)) {
+    // NOTE: Target intrinsics may query lane-dependent state (such as lane ID), so only pure generic intrinsics are
+    // accepted.
+    if (intrinsic->getCalledFunction()->isTargetIntrinsic() || !intrinsic->doesNotAccessMemory())
+      return false;
+  } else if (!isa<BinaryOperator>(inst) && !isa<UnaryOperator>(inst) && !isa<CastInst>(inst) && !isa<CmpInst>(inst) &&
+             !isa<SelectInst>(inst) && !isa<GetElementPtrInst>(inst) && !isa<ExtractValueInst>(inst) &&
+             !isa<InsertValueInst>(inst) && !isa<ExtractElementInst>(inst) && !isa<InsertElementInst>(inst) &&
+             !isa<ShuffleVectorInst>(inst)) {
+    return false;
+  }
+
+  for (Value *operand : inst->operands()) {
+    if (!isPatchUniform(operand, depth + 1))
+      return false;
+  }
+  return true;
+}
+
 // =====================================================================================================================
 // The process of handling the store of tessellation factors.
 // 1. Collect outer and inner tessellation factors from the corresponding callInst.
@@ -5734,13 +5836,14 @@ void PatchInOutImportExport::storeTessFactors() {
       Type *outputTy = output->getType();
       isOutputArray[i] = outputTy->isArrayTy();
       if (isOutputArray[i]) {
+        builder.SetInsertPoint(tessLevelInst);
         const unsigned tessFactorCount = expTessFactorCount[primitiveMode][i];
         for (unsigned elemIdx = 0; elemIdx < tessFactorCount; ++elemIdx) {
           auto elem = builder.CreateExtractValue(output, elemIdx);
           tessFactors->push_back(elem);
         }
         if (static_cast<PrimitiveMode>(primitiveMode) == PrimitiveMode::Isolines && i == 0)
-          std::swap(tessFactors[0], tessFactors[1]);
+          std::swap((*tessFactors)[0], (*tessFactors)[1]);
       } else {
         assert(outputTy->isFloatTy());
         tessFactors->push_back(output);
@@ -5750,50 +5853,94 @@ void PatchInOutImportExport::storeTessFactors() {
     tessLevelInsts = m_tessLevelInnerInsts;
   }
 
-  bool optimizeTessFactors = false;
-
-  if (!optimizeTessFactors) {
-    // Write tessellation factors to LDS if they are used as input for TES or TCS.
-    auto resUsage = m_pipelineState->getShaderResourceUsage(ShaderStageTessControl);
-    auto &perPatchBuiltInOutLocMap = resUsage->inOutUsage.perPatchBuiltInOutputLocMap;
-    unsigned builtInId = BuiltInTessLevelOuter;
-    tessFactors = &outerTessFactors;
-    tessLevelInsts = m_tessLevelOuterInsts;
-    for (unsigned i = 0; i < 2; ++i) {
-      // If tessellation factors are used as input of TES or TCS, they are required to write to LDS.
-      const bool needWriteToLds = perPatchBuiltInOutLocMap.count(builtInId) == 1;
-      if (needWriteToLds) {
-        const unsigned loc = perPatchBuiltInOutLocMap[builtInId];
-        if (isOutputArray[i]) {
-          // gl_TessLevelOuter[4] is treated as vec4
-          // gl_TessLevelInner[2] is treated as vec2
-          auto output = tessLevelInsts[0]->getOperand(3);
-          auto outputTy = output->getType();
-          auto vertexIdx = tessLevelInsts[0]->getOperand(2);
-          auto insertPos = tessLevelInsts[0];
-          for (unsigned idx = 0; idx < outputTy->getArrayNumElements(); ++idx) {
-            auto elem = builder.CreateExtractValue(output, idx);
-            auto elemIdx = builder.getInt32(idx);
-            auto ldsOffset = calcLdsOffsetForTcsOutput(elem->getType(), loc, nullptr, elemIdx, vertexIdx, insertPos);
-            writeValueToLds(elem, ldsOffset, insertPos);
-          }
-        } else {
-          for (unsigned idx = 0; idx < tessFactors->size(); ++idx) {
-            Value *elemIdx = tessLevelInsts[idx]->getOperand(1);
-            Value *tessFactor = (*tessFactors)[idx];
-            auto ldsOffset =
-                calcLdsOffsetForTcsOutput(tessFactor->getType(), loc, nullptr, elemIdx, nullptr, tessLevelInsts[idx]);
-            writeValueToLds(tessFactor, ldsOffset, tessLevelInsts[idx]);
-          }
+  // Write tessellation factors to LDS if they are used as input for TES or TCS.
+  auto resUsage = m_pipelineState->getShaderResourceUsage(ShaderStageTessControl);
+  auto &perPatchBuiltInOutLocMap = resUsage->inOutUsage.perPatchBuiltInOutputLocMap;
+  unsigned builtInId = BuiltInTessLevelOuter;
+  tessFactors = &outerTessFactors;
+  tessLevelInsts = m_tessLevelOuterInsts;
+  for (unsigned i = 0; i < 2; ++i) {
+    // If tessellation factors are used as input of TES or TCS, they are required to write to LDS. When all TES reads
+    // have been folded to constants, they are only written if TCS reads them back.
+    bool needWriteToLds = perPatchBuiltInOutLocMap.count(builtInId) == 1;
+    if (needWriteToLds && m_foldTessLevels[i]) {
+      const std::string importName =
+          (Twine(lgcName::OutputImportBuiltIn) + PipelineState::getBuiltInName(static_cast<BuiltInKind>(builtInId)))
+              .str();
+      needWriteToLds = any_of(m_module->functions(), [&](const Function &func) {
+        return func.isDeclaration() && func.getName().startswith(importName) && !func.use_empty();
+      });
+    }
+
+    if (needWriteToLds) {
+      const unsigned loc = perPatchBuiltInOutLocMap[builtInId];
+      if (isOutputArray[i]) {
+        // gl_TessLevelOuter[4] is treated as vec4
+        // gl_TessLevelInner[2] is treated as vec2
+        auto output = tessLevelInsts[0]->getOperand(3);
+        auto outputTy = output->getType();
+        auto vertexIdx = tessLevelInsts[0]->getOperand(2);
+        auto insertPos = tessLevelInsts[0];
+        builder.SetInsertPoint(insertPos);
+        for (unsigned idx = 0; idx < outputTy->getArrayNumElements(); ++idx) {
+          auto elem = builder.CreateExtractValue(output, idx);
+          auto elemIdx = builder.getInt32(idx);
+          auto ldsOffset = calcLdsOffsetForTcsOutput(elem->getType(), loc, nullptr, elemIdx, vertexIdx, insertPos);
+          writeValueToLds(elem, ldsOffset, insertPos);
         }
+      } else {
+        for (unsigned idx = 0; idx < tessFactors->size(); ++idx) {
+          Value *elemIdx = tessLevelInsts[idx]->getOperand(1);
+          Value *tessFactor = (*tessFactors)[idx];
+          auto ldsOffset =
+              calcLdsOffsetForTcsOutput(tessFactor->getType(), loc, nullptr, elemIdx, nullptr, tessLevelInsts[idx]);
+          writeValueToLds(tessFactor, ldsOffset, tessLevelInsts[idx]);
+        }
+      }
+    }
+    builtInId = BuiltInTessLevelInner;
+    tessFactors = &innerTessFactors;
+    tessLevelInsts = m_tessLevelInnerInsts;
+  }
+
+  // Every invocation of the patch executes the writes of tessellation factors. If the factors (and the element
+  // indices) are uniform among the invocations of the patch and are written unconditionally, only the first invocation
+  // has to store them to TF buffer. This covers the common case of compile-time constant factors, including patches
+  // that are always culled by zero outer factors.
+  Instruction *uniformInsertPos = nullptr;
+  ReturnInst *retInst = nullptr;
+  for (BasicBlock &block : *m_entryPoint) {
+    if (auto ret = dyn_cast<ReturnInst>(block.getTerminator())) {
+      if (retInst) {
+        retInst = nullptr;
+        break;
       }
-      builtInId = BuiltInTessLevelInner;
-      tessFactors = &innerTessFactors;
-      tessLevelInsts = m_tessLevelInnerInsts;
+      retInst = ret;
     }
+  }
 
-    doTessFactorBufferStore(outerTessFactors, innerTessFactors, nullptr);
+  if (retInst) {
+    PostDominatorTree postDomTree(*m_entryPoint);
+    BasicBlock *entryBlock = &m_entryPoint->getEntryBlock();
+    auto isUniformTessLevelInst = [&](Instruction *tessLevelInst) {
+      return tessLevelInst->getFunction() == m_entryPoint &&
+             postDomTree.dominates(tessLevelInst->getParent(), entryBlock) &&
+             isPatchUniform(tessLevelInst->getOperand(1)) && isPatchUniform(tessLevelInst->getOperand(3));
+    };
+    auto isUniformTessFactor = [&](Value *tessFactor) { return isPatchUniform(tessFactor); };
+
+    if (all_of(m_tessLevelOuterInsts, isUniformTessLevelInst) &&
+        all_of(m_tessLevelInnerInsts, isUniformTessLevelInst) && all_of(outerTessFactors, isUniformTessFactor) &&
+        all_of(innerTessFactors, isUniformTessFactor)) {
+      // if (invocationId == 0) { store tessellation factors }
+      builder.SetInsertPoint(retInst);
+      auto isFirstInvocation =
+          builder.CreateICmpEQ(m_pipelineSysValues.get(m_entryPoint)->getInvocationId(), builder.getInt32(0));
+      uniformInsertPos = SplitBlockAndInsertIfThen(isFirstInvocation, retInst, false);
+    }
   }
+
+  doTessFactorBufferStore(outerTessFactors, innerTessFactors, uniformInsertPos);
 }
 
 // =====================================================================================================================
@@ -34,6 +34,12 @@
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/util/BuilderBase.h"
+#include "lgc/util/Debug.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
 
 #define DEBUG_TYPE "lgc-patch-initialize-workgroup-memory"
@@ -45,6 +51,12 @@ static cl::opt<bool>
     ForceInitWorkgroupMemory("force-init-workgroup-memory",
                              cl::desc("Force to initialize the workgroup memory with zero for internal use"),
                              cl::init(false));
+
+static cl::opt<bool> AliasWorkgroupMemory("alias-workgroup-memory",
+                                          cl::desc("Overlay workgroup variables whose accesses are separated by "
+                                                   "barriers in one LDS region"),
+                                          cl::init(true));
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -102,21 +114,31 @@ bool PatchInitializeWorkgroupMemory::runImpl(Module &module, PipelineShadersResu
   if (!m_pipelineState->hasShaderStage(ShaderStageCompute))
     return false;
 
+  Patch::init(&module);
+  m_shaderStage = ShaderStageCompute;
+  m_entryPoint = pipelineShaders.getEntryPoint(static_cast<ShaderStage>(m_shaderStage));
+
   SmallVector<GlobalVariable *> workgroupGlobals;
+  SmallVector<GlobalVariable *> uninitializedGlobals;
   for (GlobalVariable &global : module.globals()) {
+    if (global.getType()->getPointerAddressSpace() != ADDR_SPACE_LOCAL)
+      continue;
     // The pass process the cases that the workgroup memory is forced to be initialized or the workgroup variable has an
     // zero initializer
-    if (global.getType()->getPointerAddressSpace() == ADDR_SPACE_LOCAL &&
-        (ForceInitWorkgroupMemory || (global.hasInitializer() && global.getInitializer()->isNullValue())))
+    if (ForceInitWorkgroupMemory || (global.hasInitializer() && global.getInitializer()->isNullValue()))
       workgroupGlobals.push_back(&global);
+    else if (!global.hasInitializer() || isa<UndefValue>(global.getInitializer()))
+      uninitializedGlobals.push_back(&global);
   }
 
+  // Zero-initialized variables are kept apart, as the zero of a variable must not be overwritten by another one.
+  bool changed = false;
+  if (AliasWorkgroupMemory && m_entryPoint && uninitializedGlobals.size() > 1)
+    changed = aliasWorkgroupGlobals(module, uninitializedGlobals);
+
   if (workgroupGlobals.empty())
-    return false;
+    return changed;
 
-  Patch::init(&module);
-  m_shaderStage = ShaderStageCompute;
-  m_entryPoint = pipelineShaders.getEntryPoint(static_cast<ShaderStage>(m_shaderStage));
   BuilderBase builder(*m_context);
   Instruction *insertPos = &*m_entryPoint->front().getFirstInsertionPt();
   builder.SetInsertPoint(insertPos);
@@ -153,6 +175,182 @@ bool PatchInitializeWorkgroupMemory::runImpl(Module &module, PipelineShadersResu
   return true;
 }
 
+// =====================================================================================================================
+// Overlay workgroup variables whose live ranges do not overlap in one LDS region, so the total LDS usage goes down.
+//
+// The live ranges are measured in phases of the entry point, split by the barriers that every invocation executes
+// exactly once: those outside loops whose block post-dominates the entry block. Such barriers are totally ordered, and
+// the phase of an instruction is the number of them that dominate it. A variable lives from the first to the last
+// phase in which it is accessed. Two variables with disjoint phase ranges can share LDS, as all invocations finish
+// their accesses of the earlier variable before any invocation gets past the barrier between them.
+//
+// @param [in/out] module : LLVM module
+// @param globals : Uninitialized workgroup variables
+// @returns : True if any variable was overlaid
+bool PatchInitializeWorkgroupMemory::aliasWorkgroupGlobals(Module &module, ArrayRef<GlobalVariable *> globals) {
+  const DataLayout &dataLayout = module.getDataLayout();
+
+  // Collect the barriers that split the entry point into phases.
+  DominatorTree domTree(*m_entryPoint);
+  PostDominatorTree postDomTree(*m_entryPoint);
+  LoopInfo loopInfo(domTree);
+  SmallVector<Instruction *, 8> barriers;
+  for (Instruction &inst : instructions(*m_entryPoint)) {
+    auto intrinsic = dyn_cast<IntrinsicInst>(&inst);
+    if (intrinsic && intrinsic->getIntrinsicID() == Intrinsic::amdgcn_s_barrier &&
+        !loopInfo.getLoopFor(inst.getParent()) &&
+        postDomTree.dominates(inst.getParent(), &m_entryPoint->getEntryBlock()))
+      barriers.push_back(&inst);
+  }
+  if (barriers.empty())
+    return false;
+
+  auto getPhase = [&](Instruction *inst) {
+    unsigned phase = 0;
+    for (Instruction *barrier : barriers) {
+      if (domTree.dominates(barrier, inst))
+        ++phase;
+    }
+    return phase;
+  };
+
+  // A variable that can be overlaid, with its LDS layout and the range of phases in which it is accessed
+  struct AliasCandidate {
+    GlobalVariable *global;
+    uint64_t size;
+    Align alignment;
+    unsigned firstPhase;
+    unsigned lastPhase;
+    uint64_t offset;
+  };
+  SmallVector<AliasCandidate, 8> candidates;
+  uint64_t sizeBefore = 0;
+  for (GlobalVariable *global : globals) {
+    Type *globalTy = global->getValueType();
+    SmallVector<Instruction *, 16> accesses;
+    SmallPtrSet<Value *, 16> visited;
+    if (!collectWorkgroupAccesses(global, accesses, visited) || accesses.empty())
+      continue;
+
+    AliasCandidate candidate = {global, dataLayout.getTypeAllocSize(globalTy),
+                                std::max(global->getAlign().valueOrOne(), dataLayout.getABITypeAlign(globalTy)),
+                                UINT_MAX, 0, 0};
+    for (Instruction *access : accesses) {
+      const unsigned phase = getPhase(access);
+      candidate.firstPhase = std::min(candidate.firstPhase, phase);
+      candidate.lastPhase = std::max(candidate.lastPhase, phase);
+    }
+    candidates.push_back(candidate);
+    sizeBefore += candidate.size;
+  }
+  if (candidates.size() < 2)
+    return false;
+
+  // Place the variables first-fit in order of decreasing size, at the lowest offset that does not overlap a variable
+  // already placed that is live at the same time.
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const AliasCandidate &lhs, const AliasCandidate &rhs) { return lhs.size > rhs.size; });
+  uint64_t regionSize = 0;
+  Align regionAlignment(16);
+  for (unsigned idx = 0; idx < candidates.size(); ++idx) {
+    AliasCandidate &candidate = candidates[idx];
+    uint64_t offset = 0;
+    for (bool moved = true; moved;) {
+      moved = false;
+      offset = alignTo(offset, candidate.alignment);
+      for (unsigned placedIdx = 0; placedIdx < idx; ++placedIdx) {
+        const AliasCandidate &placed = candidates[placedIdx];
+        if (placed.lastPhase < candidate.firstPhase || candidate.lastPhase < placed.firstPhase)
+          continue;
+        if (placed.offset < offset + candidate.size && offset < placed.offset + placed.size) {
+          offset = placed.offset + placed.size;
+          moved = true;
+        }
+      }
+    }
+    candidate.offset = offset;
+    regionSize = std::max(regionSize, offset + candidate.size);
+    regionAlignment = std::max(regionAlignment, candidate.alignment);
+  }
+  if (regionSize >= sizeBefore)
+    return false;
+
+  // Replace the variables with their places in the new LDS region.
+  auto regionTy = ArrayType::get(Type::getInt8Ty(*m_context), regionSize);
+  auto region = new GlobalVariable(module, regionTy, false, GlobalValue::ExternalLinkage, UndefValue::get(regionTy),
+                                   "lds.aliased", nullptr, GlobalValue::NotThreadLocal, ADDR_SPACE_LOCAL);
+  region->setAlignment(regionAlignment);
+
+  LLPC_OUTS("===============================================================================\n");
+  LLPC_OUTS("// LLPC workgroup memory aliasing results\n\n");
+  for (const AliasCandidate &candidate : candidates) {
+    LLPC_OUTS("@" << candidate.global->getName() << ": phases = " << candidate.firstPhase << ".."
+                  << candidate.lastPhase << ", size = " << candidate.size << ", offset = " << candidate.offset
+                  << "\n");
+
+    Constant *indices[] = {ConstantInt::get(Type::getInt32Ty(*m_context), 0),
+                           ConstantInt::get(Type::getInt32Ty(*m_context), candidate.offset)};
+    Constant *pointer = ConstantExpr::getInBoundsGetElementPtr(regionTy, region, indices);
+    pointer = ConstantExpr::getBitCast(pointer, candidate.global->getType());
+    candidate.global->replaceAllUsesWith(pointer);
+    candidate.global->eraseFromParent();
+  }
+  LLPC_OUTS("\nLDS size of aliased variables: " << sizeBefore << " bytes before, " << regionSize
+                                                  << " bytes after\n\n");
+  return true;
+}
+
+// =====================================================================================================================
+// Collect the memory accesses through a pointer to a workgroup variable, following derived pointers.
+//
+// @param pointer : Pointer to a workgroup variable, or one derived from it
+// @param [out] accesses : Instructions accessing the memory through the pointer
+// @param [in/out] visited : Pointers already followed
+// @returns : False if the pointer escapes or is used outside the entry point, so the accesses are not all known
+bool PatchInitializeWorkgroupMemory::collectWorkgroupAccesses(Value *pointer, SmallVectorImpl<Instruction *> &accesses,
+                                                              SmallPtrSetImpl<Value *> &visited) {
+  if (!visited.insert(pointer).second)
+    return true;
+
+  for (User *user : pointer->users()) {
+    if (auto constExpr = dyn_cast<ConstantExpr>(user)) {
+      if (constExpr->getOpcode() != Instruction::GetElementPtr && constExpr->getOpcode() != Instruction::BitCast &&
+          constExpr->getOpcode() != Instruction::AddrSpaceCast)
+        return false;
+      if (!collectWorkgroupAccesses(constExpr, accesses, visited))
+        return false;
+      continue;
+    }
+
+    auto inst = dyn_cast<Instruction>(user);
+    if (!inst || inst->getFunction() != m_entryPoint)
+      return false;
+
+    if (isa<LoadInst>(inst) || isa<MemIntrinsic>(inst)) {
+      accesses.push_back(inst);
+    } else if (auto store = dyn_cast<StoreInst>(inst)) {
+      if (store->getValueOperand() == pointer)
+        return false;
+      accesses.push_back(inst);
+    } else if (auto atomicRmw = dyn_cast<AtomicRMWInst>(inst)) {
+      if (atomicRmw->getPointerOperand() != pointer)
+        return false;
+      accesses.push_back(inst);
+    } else if (auto atomicCmpXchg = dyn_cast<AtomicCmpXchgInst>(inst)) {
+      if (atomicCmpXchg->getPointerOperand() != pointer)
+        return false;
+      accesses.push_back(inst);
+    } else if (isa<GetElementPtrInst>(inst) || isa<BitCastInst>(inst) || isa<AddrSpaceCastInst>(inst) ||
+               isa<PHINode>(inst) || isa<SelectInst>(inst)) {
+      if (!collectWorkgroupAccesses(inst, accesses, visited))
+        return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
 // =====================================================================================================================
 // Initialize the given LDS variable with zero.
 //
@@ -31,8 +31,11 @@
 #include "lgc/patch/PatchLoadScalarizer.h"
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
+#include "llvm/Analysis/DivergenceAnalysis.h"
+#include "llvm/Analysis/LegacyDivergenceAnalysis.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/InitializePasses.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -68,6 +71,7 @@ LegacyPatchLoadScalarizer::LegacyPatchLoadScalarizer() : FunctionPass(ID) {
 // @param [out] analysisUsage : The analysis usage.
 void LegacyPatchLoadScalarizer::getAnalysisUsage(AnalysisUsage &analysisUsage) const {
   analysisUsage.addRequired<LegacyPipelineStateWrapper>();
+  analysisUsage.addRequired<LegacyDivergenceAnalysis>();
   analysisUsage.addRequired<LegacyPipelineShaders>();
   analysisUsage.addPreserved<LegacyPipelineShaders>();
 }
@@ -79,7 +83,9 @@ void LegacyPatchLoadScalarizer::getAnalysisUsage(AnalysisUsage &analysisUsage) c
 // @returns : True if the module was modified by the transformation and false otherwise
 bool LegacyPatchLoadScalarizer::runOnFunction(Function &function) {
   PipelineState *pipelineState = getAnalysis<LegacyPipelineStateWrapper>().getPipelineState(function.getParent());
-  return m_impl.runImpl(function, pipelineState);
+  LegacyDivergenceAnalysis *divergenceAnalysis = &getAnalysis<LegacyDivergenceAnalysis>();
+  auto isDivergentUse = [divergenceAnalysis](const Use &use) { return divergenceAnalysis->isDivergentUse(&use); };
+  return m_impl.runImpl(function, pipelineState, isDivergentUse);
 }
 
 // =====================================================================================================================
@@ -92,7 +98,9 @@ PreservedAnalyses PatchLoadScalarizer::run(Function &function, FunctionAnalysisM
   const auto &moduleAnalysisManager = analysisManager.getResult<ModuleAnalysisManagerFunctionProxy>(function);
   PipelineState *pipelineState =
       moduleAnalysisManager.getCachedResult<PipelineStateWrapper>(*function.getParent())->getPipelineState();
-  if (runImpl(function, pipelineState))
+  DivergenceInfo &divergenceInfo = analysisManager.getResult<DivergenceAnalysis>(function);
+  auto isDivergentUse = [&](const Use &use) { return divergenceInfo.isDivergentUse(use); };
+  if (runImpl(function, pipelineState, isDivergentUse))
     return PreservedAnalyses::none();
   return PreservedAnalyses::all();
 }
@@ -102,8 +110,10 @@ PreservedAnalyses PatchLoadScalarizer::run(Function &function, FunctionAnalysisM
 //
 // @param [in/out] function : Function that will run this optimization.
 // @param [in/out] pipelineState : Pipeline state object to use for this pass
+// @param isDivergentUse : Function returning true if the given use is divergent
 // @returns : True if the module was modified by the transformation and false otherwise
-bool PatchLoadScalarizer::runImpl(Function &function, PipelineState *pipelineState) {
+bool PatchLoadScalarizer::runImpl(Function &function, PipelineState *pipelineState,
+                                  std::function<bool(const Use &)> isDivergentUse) {
   LLVM_DEBUG(dbgs() << "Run the pass Patch-Load-Scalarizer-Opt\n");
 
   auto shaderStage = lgc::getShaderStage(&function);
@@ -115,6 +125,7 @@ bool PatchLoadScalarizer::runImpl(Function &function, PipelineState *pipelineSta
   if (m_scalarThreshold == 0)
     return false;
 
+  m_isDivergentUse = isDivergentUse;
   m_builder = std::make_unique<IRBuilder<>>(function.getContext());
 
   visit(function);
@@ -161,6 +172,20 @@ void PatchLoadScalarizer::visitLoadInst(LoadInst &loadInst) {
     if (compCount > m_scalarThreshold)
       return;
 
+    // A load from a uniform address is one memory access for the whole wave, and becomes a scalar load if the memory
+    // is known not to be written (e.g. a uniform buffer). Splitting it would only add instructions, so keep it as one
+    // wide load.
+    if (!m_isDivergentUse(loadInst.getOperandUse(loadInst.getPointerOperandIndex()))) {
+      LLVM_DEBUG(dbgs() << "Keep uniform load: " << loadInst << "\n");
+      return;
+    }
+
+    // If the loaded vector is consumed as a whole, the pieces would just be re-vectorized again, so keep the load.
+    if (isWholeVectorUsed(loadInst)) {
+      LLVM_DEBUG(dbgs() << "Keep load used as whole vector: " << loadInst << "\n");
+      return;
+    }
+
     Type *compTy = cast<VectorType>(loadTy)->getElementType();
     uint64_t compSize = loadInst.getModule()->getDataLayout().getTypeStoreSize(compTy);
 
@@ -202,8 +227,25 @@ void PatchLoadScalarizer::visitLoadInst(LoadInst &loadInst) {
   }
 }
 
+// =====================================================================================================================
+// Checks whether the result of the load is consumed as a whole vector, rather than by extracting its components
+// with constant indices.
+//
+// @param loadInst : The load instruction
+bool PatchLoadScalarizer::isWholeVectorUsed(LoadInst &loadInst) {
+  for (User *user : loadInst.users()) {
+    auto extract = dyn_cast<ExtractElementInst>(user);
+    if (!extract || !isa<ConstantInt>(extract->getIndexOperand()))
+      return true;
+  }
+  return false;
+}
+
 } // namespace lgc
 
 // =====================================================================================================================
 // Initializes the pass of LLVM patching operations for load scalarizer optimization.
-INITIALIZE_PASS(LegacyPatchLoadScalarizer, DEBUG_TYPE, "Patch LLVM for load scalarizer optimization", false, false)
+INITIALIZE_PASS_BEGIN(LegacyPatchLoadScalarizer, DEBUG_TYPE, "Patch LLVM for load scalarizer optimization", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(LegacyDivergenceAnalysis)
+INITIALIZE_PASS_END(LegacyPatchLoadScalarizer, DEBUG_TYPE, "Patch LLVM for load scalarizer optimization", false, false)
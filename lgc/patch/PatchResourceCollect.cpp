@@ -41,6 +41,9 @@
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/BuilderBase.h"
 #include "lgc/util/Debug.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -55,6 +58,18 @@ using namespace lgc;
 // -disable-gs-onchip: disable geometry shader on-chip mode
 cl::opt<bool> DisableGsOnChip("disable-gs-onchip", cl::desc("Disable geometry shader on-chip mode"), cl::init(false));
 
+// -ngg-culling-cost-model: only use NGG culling mode if it is estimated to pay off
+static cl::opt<bool> NggCullingCostModel("ngg-culling-cost-model",
+                                         cl::desc("Only use NGG culling mode if the estimated saving of culling is no "
+                                                  "less than its overhead"),
+                                         cl::init(true));
+
+// -propagate-const-outputs: propagate constant outputs of the last vertex processing stage into the fragment shader
+static cl::opt<bool> PropagateConstOutputs("propagate-const-outputs",
+                                           cl::desc("Propagate constant outputs of the last vertex processing stage "
+                                                    "into the fragment shader in a whole pipeline compile"),
+                                           cl::init(true));
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -133,6 +148,11 @@ bool PatchResourceCollect::runImpl(Module &module, PipelineShadersResult &pipeli
     scalarizeForInOutPacking(&module);
   }
 
+  // Fold the constant outputs of the last vertex processing stage into the fragment shader, before the inputs and
+  // outputs are matched up.
+  if (pipelineState->isGraphics())
+    propagateConstantOutputs(module);
+
   // Process each shader stage, in reverse order. We process FS even if it does not exist (part-pipeline compile).
   for (int shaderStage = ShaderStageCountInternal - 1; shaderStage >= 0; --shaderStage) {
     m_entryPoint = pipelineShaders.getEntryPoint(static_cast<ShaderStage>(shaderStage));
@@ -154,6 +174,9 @@ bool PatchResourceCollect::runImpl(Module &module, PipelineShadersResult &pipeli
     processShader();
   }
 
+  if (pipelineState->hasShaderStage(ShaderStageFragment))
+    refineFsResourceWrite(module);
+
   if (pipelineState->isGraphics()) {
     // Set NGG control settings
     setNggControl(&module);
@@ -166,6 +189,12 @@ bool PatchResourceCollect::runImpl(Module &module, PipelineShadersResult &pipeli
       bool gsOnChip = checkGsOnChipValidity();
       pipelineState->setGsOnChip(gsOnChip);
     }
+
+    // Determine whether or not tessellation off-chip mode is needed for this pipeline. Both TCS and TES must be seen
+    // here so that they agree on where the TCS outputs live.
+    if (!pipelineState->isTessOffChip() && pipelineShaders.getEntryPoint(ShaderStageTessControl) &&
+        pipelineShaders.getEntryPoint(ShaderStageTessEval))
+      pipelineState->setTessOffChip(checkTessOffChipRequired());
   }
 
   return true;
@@ -233,6 +262,10 @@ void PatchResourceCollect::setNggControl(Module *module) {
     if (!nggControl.passthroughMode)
       nggControl.passthroughMode = !canUseNggCulling(module);
 
+    // Unless culling mode is forced, only use it if it is expected to pay off for this pipeline.
+    if (!nggControl.passthroughMode && !(options.nggFlags & NggFlagForceCullingMode))
+      nggControl.passthroughMode = !isNggCullingProfitable(module);
+
     LLPC_OUTS("===============================================================================\n");
     LLPC_OUTS("// LLPC NGG control settings results\n\n");
 
@@ -240,6 +273,8 @@ void PatchResourceCollect::setNggControl(Module *module) {
     LLPC_OUTS("EnableNgg                    = " << nggControl.enableNgg << "\n");
     LLPC_OUTS("EnableGsUse                  = " << nggControl.enableGsUse << "\n");
     LLPC_OUTS("PassthroughMode              = " << nggControl.passthroughMode << "\n");
+    LLPC_OUTS("CullingCost                  = " << nggControl.cullingCost << "\n");
+    LLPC_OUTS("CullingBenefit               = " << nggControl.cullingBenefit << "\n");
     LLPC_OUTS("CompactMode                  = ");
     switch (nggControl.compactMode) {
     case NggCompactDisable:
@@ -396,34 +431,160 @@ bool PatchResourceCollect::canUseNggCulling(Module *module) {
     return false; // No position export
 
   // Find position export call
+  auto callStage = hasGs ? ShaderStageGeometry : (hasTs ? ShaderStageTessEval : ShaderStageVertex);
+  CallInst *posCall = findPositionExport(module, callStage);
+  assert(posCall); // Position export must exist
+
+  // Check position value, disable NGG culling if it is constant
+  auto posValue = posCall->getArgOperand(posCall->arg_size() - 1); // Last argument is position value
+  if (isa<Constant>(posValue))
+    return false;
+
+  // We can safely enable NGG culling here
+  return true;
+}
+
+// =====================================================================================================================
+// Finds the position export call of the specified shader stage.
+//
+// @param [in/out] module : Module
+// @param shaderStage : Shader stage that exports the position
+// @returns : The position export call, or null if there is none
+CallInst *PatchResourceCollect::findPositionExport(Module *module, ShaderStage shaderStage) {
   std::string posCallName = lgcName::OutputExportBuiltIn;
   posCallName += PipelineState::getBuiltInName(BuiltInPosition);
-  auto callStage = hasGs ? ShaderStageGeometry : (hasTs ? ShaderStageTessEval : ShaderStageVertex);
 
-  CallInst *posCall = nullptr;
   for (Function &func : *module) {
     if (func.getName().startswith(posCallName)) {
       for (User *user : func.users()) {
         auto call = cast<CallInst>(user);
-        if (m_pipelineShaders->getShaderStage(call->getFunction()) == callStage) {
-          posCall = call;
-          break;
-        }
+        if (m_pipelineShaders->getShaderStage(call->getFunction()) == shaderStage)
+          return call;
       }
+    }
+  }
+  return nullptr;
+}
 
-      if (posCall) // Already find the call
-        break;
+// =====================================================================================================================
+// Estimates whether NGG culling pays off for this pipeline. In culling mode, the part of the ES that computes the
+// position runs for all vertices, followed by the culling ALU work and the LDS traffic of vertex compaction. The rest
+// of the ES and the parameter exports only run for the vertices that survive culling. For a cheap ES with few
+// attributes, the overhead outweighs the saving. The estimates are rough per-vertex instruction counts, and are kept
+// in the NGG control settings to be reported in PAL metadata.
+//
+// NOTE: With GS, culling is done after the GS has run, so no ES work is saved and the cost model does not apply.
+//
+// @param [in/out] module : Module
+// @returns : True if the estimated saving of NGG culling is no less than its overhead
+bool PatchResourceCollect::isNggCullingProfitable(Module *module) {
+  if (!NggCullingCostModel || m_pipelineState->hasShaderStage(ShaderStageGeometry))
+    return true;
+
+  static const unsigned BaseCullingCost = 40;         // Position LDS traffic, primitive assembly and compaction
+  static const unsigned BackfaceCullingCost = 20;     // Backface culler
+  static const unsigned FrustumCullingCost = 20;      // Frustum culler
+  static const unsigned BoxFilterCullingCost = 20;    // Box filter culler
+  static const unsigned SphereCullingCost = 30;       // Sphere culler
+  static const unsigned SmallPrimFilterCost = 20;     // Small primitive filter
+  static const unsigned CullDistanceCullingCost = 10; // Cull distance culler
+  static const unsigned InputFetchCost = 8;           // Vertex fetch or off-chip LDS read of an ES input
+  static const unsigned ParamExportCost = 8;          // Parameter export of an attribute
+  static const unsigned CullRatePercent = 50;         // Assumed percentage of culled vertices
+
+  NggControl &nggControl = *m_pipelineState->getNggControl();
+  unsigned cullingCost = BaseCullingCost;
+  if (nggControl.enableBackfaceCulling)
+    cullingCost += BackfaceCullingCost;
+  if (nggControl.enableFrustumCulling)
+    cullingCost += FrustumCullingCost;
+  if (nggControl.enableBoxFilterCulling)
+    cullingCost += BoxFilterCullingCost;
+  if (nggControl.enableSphereCulling)
+    cullingCost += SphereCullingCost;
+  if (nggControl.enableSmallPrimFilter)
+    cullingCost += SmallPrimFilterCost;
+  if (nggControl.enableCullDistanceCulling)
+    cullingCost += CullDistanceCullingCost;
+
+  auto getInstCost = [](const Instruction &inst) -> unsigned {
+    if (isa<DbgInfoIntrinsic>(inst))
+      return 0;
+    if (auto call = dyn_cast<CallInst>(&inst)) {
+      auto callee = call->getCalledFunction();
+      if (callee && (callee->getName().startswith(lgcName::InputImportVertex) ||
+                     callee->getName().startswith(lgcName::InputImportGeneric)))
+        return InputFetchCost;
+    }
+    return 1;
+  };
+
+  // Cost of the whole ES
+  const ShaderStage esStage =
+      m_pipelineState->hasShaderStage(ShaderStageTessEval) ? ShaderStageTessEval : ShaderStageVertex;
+  unsigned esCost = 0;
+  for (Function &func : *module) {
+    if (func.isDeclaration() || getShaderStage(&func) != esStage)
+      continue;
+    for (const Instruction &inst : instructions(func))
+      esCost += getInstCost(inst);
+  }
+
+  // Cost of the position computation, which is done for all vertices in culling mode
+  unsigned posCost = 0;
+  CallInst *posCall = findPositionExport(module, esStage);
+  SmallPtrSet<Instruction *, 32> visited;
+  SmallVector<Instruction *, 32> worklist;
+  if (auto posInst = dyn_cast<Instruction>(posCall->getArgOperand(posCall->arg_size() - 1)))
+    worklist.push_back(posInst);
+  while (!worklist.empty()) {
+    Instruction *inst = worklist.pop_back_val();
+    if (!visited.insert(inst).second)
+      continue;
+    posCost += getInstCost(*inst);
+    for (Value *operand : inst->operands()) {
+      if (auto operandInst = dyn_cast<Instruction>(operand))
+        worklist.push_back(operandInst);
     }
   }
-  assert(posCall); // Position export must exist
 
-  // Check position value, disable NGG culling if it is constant
-  auto posValue = posCall->getArgOperand(posCall->arg_size() - 1); // Last argument is position value
-  if (isa<Constant>(posValue))
-    return false;
+  // The deferred part of the ES and the parameter exports are saved for culled vertices
+  const unsigned attribCount = m_pipelineState->getShaderResourceUsage(esStage)->inOutUsage.outputMapLocCount;
+  const unsigned deferredCost = esCost - std::min(esCost, posCost) + attribCount * ParamExportCost;
 
-  // We can safely enable NGG culling here
-  return true;
+  nggControl.cullingCost = cullingCost;
+  nggControl.cullingBenefit = deferredCost * CullRatePercent / 100;
+  return nggControl.cullingBenefit >= nggControl.cullingCost;
+}
+
+// =====================================================================================================================
+// Determines whether tessellation control outputs should be stored in the off-chip LDS buffer for this pipeline.
+//
+// On-chip mode keeps TCS input, TCS output and patch constants of all patches of a thread group in LDS, which saves
+// the memory traffic of the off-chip buffer but limits the patch count per thread group for big patches. Off-chip
+// mode only keeps TCS input in LDS. We select off-chip mode when it allows more patches per thread group than on-chip
+// mode, as computed by PipelineState::calcPatchCountPerThreadGroup().
+bool PatchResourceCollect::checkTessOffChipRequired() {
+  const auto &tcsInOutUsage = m_pipelineState->getShaderResourceUsage(ShaderStageTessControl)->inOutUsage;
+
+  const unsigned inVertexCount = m_pipelineState->getInputAssemblyState().patchControlPoints;
+  const unsigned outVertexCount = m_pipelineState->getShaderModes()->getTessellationMode().outputVertices;
+
+  // Vertex strides (in dwords), as PatchInOutImportExport computes them
+  const unsigned inVertexStride = std::max(tcsInOutUsage.inputMapLocCount, 1u) * 4;
+  const unsigned outVertexStride = std::max(tcsInOutUsage.outputMapLocCount, 1u) * 4;
+  const unsigned patchConstCount = tcsInOutUsage.perPatchOutputMapLocCount;
+  const unsigned tessFactorStride = m_pipelineState->getTessFactorStride();
+
+  const unsigned onChipPatchCount = m_pipelineState->calcPatchCountPerThreadGroup(
+      false, inVertexCount, inVertexStride, outVertexCount, outVertexStride, patchConstCount, tessFactorStride);
+  const unsigned offChipPatchCount = m_pipelineState->calcPatchCountPerThreadGroup(
+      true, inVertexCount, inVertexStride, outVertexCount, outVertexStride, patchConstCount, tessFactorStride);
+
+  LLVM_DEBUG(dbgs() << "Tessellation patch count per thread group: on-chip " << onChipPatchCount << ", off-chip "
+                    << offChipPatchCount << "\n");
+
+  return onChipPatchCount < offChipPatchCount;
 }
 
 // =====================================================================================================================
@@ -1054,6 +1215,290 @@ void PatchResourceCollect::processMissingFs() {
     m_resUsage->inOutUsage.builtInInputLocMap[oneLocInfo.first] = oneLocInfo.second;
 }
 
+// =====================================================================================================================
+// Check whether the instruction may write memory that is visible outside the shader invocation (a resource write).
+//
+// @param inst : Instruction to check
+static bool mayWriteResource(const Instruction &inst) {
+  if (!inst.mayWriteToMemory() || isa<FenceInst>(inst))
+    return false;
+
+  auto isResourceAddrSpace = [](unsigned addrSpace) {
+    return addrSpace != ADDR_SPACE_PRIVATE && addrSpace != ADDR_SPACE_LOCAL;
+  };
+  if (auto store = dyn_cast<StoreInst>(&inst))
+    return isResourceAddrSpace(store->getPointerAddressSpace());
+  if (auto atomicRmw = dyn_cast<AtomicRMWInst>(&inst))
+    return isResourceAddrSpace(atomicRmw->getPointerAddressSpace());
+  if (auto cmpXchg = dyn_cast<AtomicCmpXchgInst>(&inst))
+    return isResourceAddrSpace(cmpXchg->getPointerAddressSpace());
+  if (auto memIntrinsic = dyn_cast<AnyMemIntrinsic>(&inst))
+    return isResourceAddrSpace(memIntrinsic->getDestAddressSpace());
+
+  if (auto call = dyn_cast<CallInst>(&inst)) {
+    if (Function *callee = call->getCalledFunction()) {
+      // Input imports and output exports are not resource writes.
+      if (callee->getName().startswith(lgcName::InputCallPrefix) ||
+          callee->getName().startswith(lgcName::OutputCallPrefix))
+        return false;
+      switch (callee->getIntrinsicID()) {
+      case Intrinsic::lifetime_start:
+      case Intrinsic::lifetime_end:
+      case Intrinsic::assume:
+      case Intrinsic::amdgcn_kill:
+      case Intrinsic::amdgcn_wqm_demote:
+        return false;
+      default:
+        break;
+      }
+    }
+  }
+
+  // Anything else (image stores and atomics, calls to other functions) is conservatively a resource write.
+  return true;
+}
+
+// =====================================================================================================================
+// Refine the fragment shader's resourceWrite flag from the IR. The front-end sets the flag conservatively, for example
+// on every access to a storage buffer that is not declared read-only. The flag forces late Z in the fragment shader,
+// so clear it if the fragment shader (including its subfunctions) does not contain any resource write after all.
+//
+// @param module : LLVM module
+void PatchResourceCollect::refineFsResourceWrite(Module &module) {
+  ResourceUsage *resUsage = m_pipelineState->getShaderResourceUsage(ShaderStageFragment);
+  if (!resUsage->resourceWrite)
+    return;
+
+  for (Function &func : module) {
+    if (func.isDeclaration() || getShaderStage(&func) != ShaderStageFragment)
+      continue;
+    for (Instruction &inst : instructions(func)) {
+      if (mayWriteResource(inst))
+        return;
+    }
+  }
+
+  LLVM_DEBUG(dbgs() << "Fragment shader has no resource write\n");
+  resUsage->resourceWrite = false;
+}
+
+// =====================================================================================================================
+// Propagate the generic outputs of the last vertex processing stage that are constants into the fragment shader. Each
+// fragment shader read of such an output is replaced with the constant, and the output export is removed, so that
+// neither a parameter export nor an interpolant is needed for it. This is only done for a whole pipeline compile, as
+// both sides of the interface must be visible.
+//
+// @param module : LLVM module
+void PatchResourceCollect::propagateConstantOutputs(Module &module) {
+  if (!PropagateConstOutputs || !m_pipelineState->isWholePipeline() || m_pipelineState->isUnlinked() ||
+      !m_pipelineShaders->getEntryPoint(ShaderStageFragment))
+    return;
+
+  const ShaderStage producerStage = m_pipelineState->getLastVertexProcessingStage();
+  if (producerStage == ShaderStageInvalid || !m_pipelineShaders->getEntryPoint(producerStage))
+    return;
+
+  // Gather the generic output exports of the producer stage and the generic input imports of the fragment shader
+  SmallVector<CallInst *, 16> outputCalls;
+  SmallVector<CallInst *, 16> inputCalls;
+  for (Function &func : module) {
+    if (!func.isDeclaration())
+      continue;
+    const bool isOutput = func.getName().startswith(lgcName::OutputExportGeneric);
+    const bool isInput = func.getName().startswith(lgcName::InputImportGeneric) ||
+                         func.getName().startswith(lgcName::InputImportInterpolant);
+    if (!isOutput && !isInput)
+      continue;
+    for (User *user : func.users()) {
+      auto call = dyn_cast<CallInst>(user);
+      if (!call)
+        continue;
+      const ShaderStage stage = getShaderStage(call->getFunction());
+      if (isOutput && stage == producerStage)
+        outputCalls.push_back(call);
+      else if (isInput && stage == ShaderStageFragment)
+        inputCalls.push_back(call);
+    }
+  }
+
+  // A span of dwords within a generic location, and the constant written to it (null if not constant)
+  struct ConstOutput {
+    unsigned dwordStart;
+    unsigned dwordCount;
+    Type *ty;
+    Constant *value;
+    bool foldable;
+    SmallVector<CallInst *, 2> exports; // Producer exports of this span
+    SmallVector<CallInst *, 2> imports; // Fragment shader imports of this span
+  };
+  std::map<unsigned, SmallVector<ConstOutput, 4>> constOutputs;
+  std::set<unsigned> unfoldableLocs;
+
+  // Gets the span of dwords of a value of the specified type at the specified component.
+  auto getDwordSpan = [](Type *ty, unsigned elemIdx) -> std::pair<unsigned, unsigned> {
+    const unsigned elemDwords = ty->getScalarSizeInBits() == 64 ? 2 : 1;
+    const unsigned elemCount = ty->isVectorTy() ? cast<FixedVectorType>(ty)->getNumElements() : 1;
+    return {elemIdx * elemDwords, elemCount * elemDwords};
+  };
+
+  ResourceUsage *producerResUsage = m_pipelineState->getShaderResourceUsage(producerStage);
+  for (CallInst *call : outputCalls) {
+    const unsigned loc = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue();
+    Value *output = call->getArgOperand(call->arg_size() - 1);
+
+    if (producerStage == ShaderStageGeometry) {
+      // Only the outputs of the rasterization stream reach the fragment shader, and those captured by transform
+      // feedback must be kept.
+      const unsigned streamId = cast<ConstantInt>(call->getArgOperand(2))->getZExtValue();
+      if (streamId != producerResUsage->inOutUsage.gs.rasterStream)
+        continue;
+      for (const auto &locInfoXfbOutInfo : producerResUsage->inOutUsage.gs.locInfoXfbOutInfoMap) {
+        if (locInfoXfbOutInfo.first.getLocation() == loc)
+          unfoldableLocs.insert(loc);
+      }
+    }
+
+    // Undefined outputs are removed separately, and allow any value.
+    if (isa<UndefValue>(output))
+      continue;
+
+    auto elemIdx = dyn_cast<ConstantInt>(call->getArgOperand(1));
+    auto span = getDwordSpan(output->getType(), elemIdx ? elemIdx->getZExtValue() : 0);
+    if (!elemIdx || span.first + span.second > 4) {
+      // A dynamically indexed output, or one that crosses into the next location, is left alone.
+      unfoldableLocs.insert(loc);
+      unfoldableLocs.insert(loc + 1);
+      continue;
+    }
+
+    auto value = dyn_cast<Constant>(output);
+    auto &spans = constOutputs[loc];
+    auto it = find_if(spans, [&](const ConstOutput &constOutput) {
+      return constOutput.dwordStart == span.first && constOutput.dwordCount == span.second &&
+             constOutput.ty == output->getType();
+    });
+    if (it == spans.end()) {
+      spans.push_back({span.first, span.second, output->getType(), value, value != nullptr, {}, {}});
+      it = spans.end() - 1;
+    } else if (it->value != value) {
+      // Different values are written to the same span on different paths.
+      it->foldable = false;
+    }
+    it->exports.push_back(call);
+  }
+
+  // A span is only foldable if no other output overlaps it.
+  for (auto &locSpans : constOutputs) {
+    for (ConstOutput &constOutput : locSpans.second) {
+      for (const ConstOutput &other : locSpans.second) {
+        if (&other != &constOutput && other.dwordStart < constOutput.dwordStart + constOutput.dwordCount &&
+            constOutput.dwordStart < other.dwordStart + other.dwordCount)
+          constOutput.foldable = false;
+      }
+      if (unfoldableLocs.count(locSpans.first) != 0)
+        constOutput.foldable = false;
+    }
+  }
+
+  // Match the fragment shader inputs against the constant outputs. A span stays foldable only if every input that
+  // overlaps it reads exactly that span with the same type.
+  SmallVector<std::pair<CallInst *, unsigned>, 16> inputLocs;
+  for (CallInst *call : inputCalls) {
+    // Generic input: (location, elemIdx, interpMode, interpLoc)
+    // Interpolant input: (location, locOffset, elemIdx, interpMode, auxInterpValue)
+    const bool isInterpolant = call->arg_size() == 5;
+    unsigned loc = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue();
+    if (isInterpolant) {
+      auto locOffset = dyn_cast<ConstantInt>(call->getArgOperand(1));
+      if (!locOffset) {
+        // A dynamically indexed input may read any location.
+        return;
+      }
+      loc += locOffset->getZExtValue();
+    }
+    inputLocs.push_back({call, loc});
+
+    auto spansIt = constOutputs.find(loc);
+    if (spansIt == constOutputs.end())
+      continue;
+
+    auto elemIdx = dyn_cast<ConstantInt>(call->getArgOperand(isInterpolant ? 2 : 1));
+    auto span = getDwordSpan(call->getType(), elemIdx ? elemIdx->getZExtValue() : 0);
+    if (!elemIdx || span.first + span.second > 4) {
+      // A dynamically indexed input, or one that crosses into the next location, keeps the whole location.
+      span = {0, 4};
+    }
+
+    for (ConstOutput &constOutput : spansIt->second) {
+      if (constOutput.dwordStart >= span.first + span.second ||
+          span.first >= constOutput.dwordStart + constOutput.dwordCount)
+        continue;
+      if (constOutput.dwordStart == span.first && constOutput.dwordCount == span.second &&
+          constOutput.ty == call->getType())
+        constOutput.imports.push_back(call);
+      else
+        constOutput.foldable = false;
+    }
+  }
+
+  // Fold the constants into the fragment shader and remove the output exports.
+  ResourceUsage *fsResUsage = m_pipelineState->getShaderResourceUsage(ShaderStageFragment);
+  std::set<unsigned> foldedLocs;
+  SmallPtrSet<CallInst *, 16> foldedCalls;
+  bool printHeader = true;
+  for (auto &locSpans : constOutputs) {
+    for (ConstOutput &constOutput : locSpans.second) {
+      if (!constOutput.foldable || constOutput.imports.empty())
+        continue;
+
+      std::string valueText;
+      raw_string_ostream valueStream(valueText);
+      constOutput.value->printAsOperand(valueStream);
+      valueStream.flush();
+
+      InOutLocationInfo locInfo;
+      locInfo.setLocation(locSpans.first);
+      locInfo.setComponent(constOutput.dwordStart);
+      fsResUsage->inOutUsage.fs.constInputs[locInfo] = valueText;
+
+      if (printHeader) {
+        LLPC_OUTS("===============================================================================\n");
+        LLPC_OUTS("// LLPC constant output propagation results (" << getShaderStageAbbreviation(producerStage)
+                                                                  << " to FS)\n\n");
+        printHeader = false;
+      }
+      LLPC_OUTS("(FS) Input:  loc = " << locSpans.first << ", comp = " << constOutput.dwordStart
+                                      << "  =>  Constant = " << valueText << "\n");
+
+      for (CallInst *call : constOutput.imports) {
+        foldedCalls.insert(call);
+        call->replaceAllUsesWith(constOutput.value);
+        call->eraseFromParent();
+      }
+      for (CallInst *call : constOutput.exports)
+        call->eraseFromParent();
+      foldedLocs.insert(locSpans.first);
+    }
+  }
+  if (foldedLocs.empty())
+    return;
+  LLPC_OUTS("\n");
+
+  // Remove the location info of a fully folded location from the fragment shader, so the output of the producer stage
+  // is cleared as unused and the location is not assigned an interpolant. A location that is still read is kept.
+  for (const auto &inputLoc : inputLocs) {
+    if (foldedCalls.count(inputLoc.first) == 0)
+      foldedLocs.erase(inputLoc.second);
+  }
+  auto &inputLocInfoMap = fsResUsage->inOutUsage.inputLocInfoMap;
+  for (auto it = inputLocInfoMap.begin(); it != inputLocInfoMap.end();) {
+    if (foldedLocs.count(it->first.getLocation()) != 0)
+      it = inputLocInfoMap.erase(it);
+    else
+      ++it;
+  }
+}
+
 // =====================================================================================================================
 // Check whether vertex reuse should be disabled.
 bool PatchResourceCollect::isVertexReuseDisabled() {
@@ -2512,8 +2957,11 @@ void PatchResourceCollect::updateInputLocInfoMapWithPack() {
     inputLocInfoMap.clear();
   }
 
-  // LDS load/store copes with dword. For 8-bit/16-bit data type, we will extend them to 32-bit
-  const bool requireDword = isTcs || isGs || (isFs && m_pipelineState->hasShaderStage(ShaderStageGeometry));
+  // LDS load/store copes with dword. For 8-bit/16-bit data type, we will extend them to 32-bit. GS outputs of
+  // 8-bit/16-bit data type may be packed two per dword in GS-VS ring, and then FS inputs are packed in the same way.
+  const bool requireDword = isTcs || isGs ||
+                            (isFs && m_pipelineState->hasShaderStage(ShaderStageGeometry) &&
+                             !m_pipelineState->canPack16BitGsOutput());
   // Create locationMap according to the packable calls
   m_locationInfoMapManager->createMap(packableCalls, m_shaderStage, requireDword);
 
@@ -2591,8 +3039,8 @@ void PatchResourceCollect::updateOutputLocInfoMapWithPack() {
   }
 
   // For GS, the outputLocInfoMap is created according to the output calls in each stream
-  // LDS load/store copes with dword
-  m_locationInfoMapManager->createMap(m_outputCalls, m_shaderStage, true);
+  // LDS load/store copes with dword unless 8-bit/16-bit outputs can be packed two per dword in GS-VS ring
+  m_locationInfoMapManager->createMap(m_outputCalls, m_shaderStage, !m_pipelineState->canPack16BitGsOutput());
   m_outputCalls.clear();
 
   auto &fsInOutUsage = m_pipelineState->getShaderResourceUsage(ShaderStageFragment)->inOutUsage;
@@ -3045,7 +3493,8 @@ void InOutLocationInfoMapManager::addSpan(CallInst *call, ShaderStage shaderStag
   else if (bitWidth == 8)
     bitWidth = 16;
   span.compatibilityInfo.halfComponentCount = bitWidth / 16;
-  // For VS/TES-FS, 32-bit and 16-bit are packed seperately; For VS-TCS, VS/TES-GS and GS-FS, they are packed together
+  // For VS/TES-FS and GS-FS with packed 16-bit GS outputs, 32-bit and 16-bit are packed seperately; For VS-TCS,
+  // VS/TES-GS and other GS-FS, they are packed together
   span.compatibilityInfo.is16Bit = bitWidth == 16;
 
   if (isFs) {
@@ -3077,6 +3526,8 @@ void InOutLocationInfoMapManager::buildMap(ShaderStage shaderStage) {
   unsigned compIdx = 0;
   bool isHighHalf = false;
   const bool isGs = shaderStage == ShaderStageGeometry;
+  // For GS, the number of locations already used in each stream
+  unsigned usedLocCount[MaxGsStreams] = {};
   // For GS, the locationSpans in the same stream is compatible.
   // No need to check compatibility means all locationSpans are compatible.
   const bool checkCompatibility = shaderStage == ShaderStageFragment || isGs;
@@ -3093,7 +3544,8 @@ void InOutLocationInfoMapManager::buildMap(ShaderStage shaderStage) {
 
       // If the current loactionSpan is compatible with previous one, increase component index with location unchanged
       // until the component index is up to 4 and increase location index and reset component index to 0. Otherwise,
-      // reset the location index for GS or increase location index, and reset component index to 0.
+      // continue from the used locations of the stream for GS or increase location index, and reset component index
+      // to 0.
       if (compatible) {
         if (compIdx > 3) {
           ++consectiveLocation;
@@ -3103,8 +3555,9 @@ void InOutLocationInfoMapManager::buildMap(ShaderStage shaderStage) {
           isHighHalf = spanIt->compatibilityInfo.is16Bit ? !isHighHalf : false;
         }
       } else {
-        // NOTE: For GS, the indexing of remapped location is zero-based in each stream
-        consectiveLocation = isGs ? 0 : consectiveLocation + 1;
+        // NOTE: For GS, the indexing of remapped location is zero-based in each stream. The spans of a stream might be
+        // split into 32-bit ones and 16-bit ones, which must not overlap.
+        consectiveLocation = isGs ? usedLocCount[spanIt->firstLocationInfo.getStreamId()] : consectiveLocation + 1;
         compIdx = 0;
         isHighHalf = false;
       }
@@ -3117,6 +3570,10 @@ void InOutLocationInfoMapManager::buildMap(ShaderStage shaderStage) {
     newLocInfo.setHighHalf(isHighHalf);
     newLocInfo.setStreamId(spanIt->firstLocationInfo.getStreamId());
     m_locationInfoMap.insert({spanIt->firstLocationInfo, newLocInfo});
+    if (isGs) {
+      unsigned &locCount = usedLocCount[newLocInfo.getStreamId()];
+      locCount = std::max(locCount, consectiveLocation + 1);
+    }
 
     // Update component index
     if ((spanIt->compatibilityInfo.is16Bit && isHighHalf) || !spanIt->compatibilityInfo.is16Bit)
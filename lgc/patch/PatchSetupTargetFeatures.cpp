@@ -29,6 +29,8 @@
 ***********************************************************************************************************************
 */
 #include "lgc/patch/Patch.h"
+#include "lgc/state/IntrinsDefs.h"
+#include "lgc/state/PalMetadata.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "llvm/Pass.h"
@@ -59,6 +61,7 @@ public:
 
 private:
   void setupTargetFeatures(Module *module);
+  unsigned computeMaxWavesPerEu(Function *func);
 
   PipelineState *m_pipelineState;
 };
@@ -149,6 +152,24 @@ void PatchSetupTargetFeatures::setupTargetFeatures(Module *module) {
       builder.addAttribute("amdgpu-flat-work-group-size", flatWorkGroupSizeString + "," + flatWorkGroupSizeString);
     }
 
+    if (isShaderEntryPoint(&*func)) {
+      // Tell the backend the occupancy that LDS usage and workgroup size leave achievable, so that the register
+      // allocator can use the VGPRs that could not be turned into extra waves anyway.
+      unsigned maxWavesPerEu = computeMaxWavesPerEu(&*func);
+      if (maxWavesPerEu != 0) {
+        // Keep a tighter limit already requested through the maxThreadGroupsPerComputeUnit shader option.
+        Attribute wavesPerEuAttr = func->getFnAttribute("amdgpu-waves-per-eu");
+        unsigned requestedMaxWavesPerEu = 0;
+        if (wavesPerEuAttr.isStringAttribute() &&
+            !wavesPerEuAttr.getValueAsString().split(',').second.getAsInteger(0, requestedMaxWavesPerEu) &&
+            requestedMaxWavesPerEu != 0)
+          maxWavesPerEu = std::min(maxWavesPerEu, requestedMaxWavesPerEu);
+
+        builder.addAttribute("amdgpu-waves-per-eu", "1," + std::to_string(maxWavesPerEu));
+        m_pipelineState->getPalMetadata()->setMaxWavesPerEu(func->getCallingConv(), maxWavesPerEu);
+      }
+    }
+
     auto gfxIp = m_pipelineState->getTargetInfo().getGfxIpVersion();
 
     if (gfxIp.major >= 10) {
@@ -208,6 +229,87 @@ void PatchSetupTargetFeatures::setupTargetFeatures(Module *module) {
   }
 }
 
+// =====================================================================================================================
+// Compute the maximum number of waves per SIMD that the LDS allocation of a shader entry-point allows, given the
+// number of waves in each of its workgroups (or subgroups). Returns 0 if LDS usage does not limit occupancy below the
+// hardware maximum.
+//
+// @param func : Shader entry-point
+unsigned PatchSetupTargetFeatures::computeMaxWavesPerEu(Function *func) {
+  const auto gfxIp = m_pipelineState->getTargetInfo().getGfxIpVersion();
+  const auto &gpuProperty = m_pipelineState->getTargetInfo().getGpuProperty();
+  ShaderStage shaderStage = getShaderStage(func);
+
+  unsigned ldsSizeInBytes = 0;
+  unsigned threadCount = 0;
+  switch (func->getCallingConv()) {
+  case CallingConv::AMDGPU_CS: {
+    // All LDS variables of a compute pipeline belong to its only shader.
+    const DataLayout &dataLayout = func->getParent()->getDataLayout();
+    for (const GlobalVariable &global : func->getParent()->globals()) {
+      if (global.getType()->getPointerAddressSpace() == ADDR_SPACE_LOCAL)
+        ldsSizeInBytes += dataLayout.getTypeAllocSize(global.getValueType());
+    }
+    const auto &computeMode = m_pipelineState->getShaderModes()->getComputeShaderMode();
+    threadCount = computeMode.workgroupSizeX * computeMode.workgroupSizeY * computeMode.workgroupSizeZ;
+    break;
+  }
+  case CallingConv::AMDGPU_HS: {
+    // LS-HS workgroup: on-chip tessellation inputs/outputs (or only inputs with off-chip tessellation)
+    const auto &calcFactor =
+        m_pipelineState->getShaderResourceUsage(ShaderStageTessControl)->inOutUsage.tcs.calcFactor;
+    unsigned ldsSizeInDwords =
+        calcFactor.onChip.patchConstStart + calcFactor.patchConstSize * calcFactor.patchCountPerThreadGroup;
+    if (m_pipelineState->isTessOffChip())
+      ldsSizeInDwords = calcFactor.inPatchSize * calcFactor.patchCountPerThreadGroup;
+    ldsSizeInBytes = ldsSizeInDwords * 4;
+
+    const unsigned inVertexCount = m_pipelineState->getInputAssemblyState().patchControlPoints;
+    const unsigned outVertexCount = m_pipelineState->getShaderModes()->getTessellationMode().outputVertices;
+    threadCount = calcFactor.patchCountPerThreadGroup * std::max(inVertexCount, outVertexCount);
+    break;
+  }
+  case CallingConv::AMDGPU_GS: {
+    // GFX9+ ES-GS subgroup or NGG primitive shader: ES-GS ring (and GS-VS ring in GS on-chip mode or NGG) in LDS
+    if (gfxIp.major < 9)
+      return 0;
+    const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageGeometry)->inOutUsage.gs.calcFactor;
+    ldsSizeInBytes = calcFactor.gsOnChipLdsSize * 4;
+
+    unsigned gsPrimCount = calcFactor.gsPrimsPerSubgroup;
+    if (!m_pipelineState->getNggControl()->enableNgg && m_pipelineState->hasShaderStage(ShaderStageGeometry))
+      gsPrimCount *= std::max(m_pipelineState->getShaderModes()->getGeometryShaderMode().invocations, 1u);
+    threadCount = std::max(calcFactor.esVertsPerSubgroup, gsPrimCount);
+    break;
+  }
+  default:
+    return 0;
+  }
+
+  if (ldsSizeInBytes == 0 || threadCount == 0)
+    return 0;
+
+  // LDS is allocated per workgroup in units of the LDS_SIZE register granularity. We target CU mode, so each CU has
+  // 64KB of LDS shared by its SIMDs.
+  const unsigned ldsAllocGranularity = 4u << gpuProperty.ldsSizeDwordGranularityShift;
+  const unsigned ldsSizePerCu = 64 * 1024;
+  const unsigned simdCountPerCu = gfxIp.major >= 10 ? 2 : 4;
+  unsigned hwMaxWavesPerEu = 10;
+  if (gfxIp.major >= 10)
+    hwMaxWavesPerEu = (gfxIp.major == 10 && gfxIp.minor < 3) ? 20 : 16;
+
+  const unsigned waveSize = m_pipelineState->getShaderWaveSize(shaderStage);
+  const unsigned waveCountPerGroup = alignTo(threadCount, waveSize) / waveSize;
+  const unsigned groupCountPerCu = ldsSizePerCu / alignTo(ldsSizeInBytes, ldsAllocGranularity);
+  if (groupCountPerCu == 0)
+    return 0;
+
+  unsigned maxWavesPerEu = alignTo(groupCountPerCu * waveCountPerGroup, simdCountPerCu) / simdCountPerCu;
+  if (maxWavesPerEu >= hwMaxWavesPerEu)
+    return 0;
+  return std::max(maxWavesPerEu, 1u);
+}
+
 // =====================================================================================================================
 // Initializes the pass
 INITIALIZE_PASS(PatchSetupTargetFeatures, DEBUG_TYPE, "Patch LLVM to set up target features", false, false)
@@ -29,6 +29,7 @@
  ***********************************************************************************************************************
  */
 #include "lgc/patch/VertexFetch.h"
+#include "lgc/Builder.h"
 #include "lgc/LgcContext.h"
 #include "lgc/patch/Patch.h"
 #include "lgc/patch/ShaderInputs.h"
@@ -40,7 +41,9 @@
 #include "lgc/util/Internal.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 
 #define DEBUG_TYPE "lgc-vertex-fetch"
 
@@ -85,6 +88,10 @@ public:
   Value *fetchVertex(Type *inputTy, const VertexInputDescription *description, unsigned location, unsigned compIdx,
                      BuilderBase &builder) override;
 
+  // Generate code to fetch a vertex value, reading the attribute description from the uber fetch shader table
+  Value *fetchVertexUber(Type *inputTy, Value *attribTable, unsigned location, unsigned compIdx,
+                         BuilderBase &builder) override;
+
 private:
   void initialize(PipelineState *pipelineState);
 
@@ -100,7 +107,12 @@ private:
 
   unsigned mapVertexFormat(unsigned dfmt, unsigned nfmt) const;
 
-  Value *loadVertexBufferDescriptor(unsigned binding, BuilderBase &builder);
+  Value *loadVertexBufferDescriptor(Value *binding, BuilderBase &builder);
+
+  Constant *getFetchDefaults(Type *inputTy) const;
+
+  Value *finalizeVertexFetch(Type *inputTy, Value *vertexFetch, unsigned location, unsigned compIdx,
+                             Instruction *insertPos);
 
   void addVertexFetchInst(Value *vbDesc, unsigned numChannels, bool is16bitFetch, Value *vbIndex, unsigned offset,
                           unsigned stride, unsigned dfmt, unsigned nfmt, Instruction *insertPos, Value **ppFetch) const;
@@ -390,6 +402,27 @@ bool LowerVertexFetch::runImpl(Module &module, PipelineState *pipelineState) {
   if (vertexFetches.empty())
     return false;
 
+  if (pipelineState->getOptions().enableUberFetchShader) {
+    // Uber fetch shader: the vertex input state is not compiled into the shader. Load the descriptor of the
+    // attribute table once at the start of the vertex shader, then lower each vertex fetch to read its attribute
+    // description from the table.
+    std::unique_ptr<Builder> descBuilder(Builder::createBuilderImpl(pipelineState->getLgcContext(), pipelineState));
+    descBuilder->setShaderStage(ShaderStageVertex);
+    descBuilder->SetInsertPoint(&*vertexFetches[0]->getFunction()->front().getFirstInsertionPt());
+    Value *attribTable = descBuilder->CreateLoadBufferDesc(UberFetchShaderTableSet, UberFetchShaderTableBinding,
+                                                           descBuilder->getInt32(0), 0, descBuilder->getInt8Ty());
+
+    for (CallInst *call : vertexFetches) {
+      unsigned location = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue();
+      unsigned component = cast<ConstantInt>(call->getArgOperand(1))->getZExtValue();
+      builder.SetInsertPoint(call);
+      Value *vertex = vertexFetch->fetchVertexUber(call->getType(), attribTable, location, component, builder);
+      call->replaceAllUsesWith(vertex);
+      call->eraseFromParent();
+    }
+    return true;
+  }
+
   if (!pipelineState->isUnlinked() || !pipelineState->getVertexInputDescriptions().empty()) {
     // Whole-pipeline compilation (or shader compilation where we were given the vertex input descriptions).
     // Lower each vertex fetch.
@@ -542,9 +575,8 @@ VertexFetchImpl::VertexFetchImpl(LgcContext *lgcContext)
 // @param builder : Builder to use to insert vertex fetch instructions
 Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription *description, unsigned location,
                                     unsigned compIdx, BuilderBase &builder) {
-  Value *vertex = nullptr;
   Instruction *insertPos = &*builder.GetInsertPoint();
-  auto vbDesc = loadVertexBufferDescriptor(description->binding, builder);
+  auto vbDesc = loadVertexBufferDescriptor(builder.getInt64(description->binding), builder);
 
   Value *vbIndex = nullptr;
   if (description->inputRate == VertexInputRateVertex) {
@@ -581,7 +613,6 @@ Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription
 
   VertexFormatInfo formatInfo = getVertexFormatInfo(description);
 
-  const bool is8bitFetch = (inputTy->getScalarSizeInBits() == 8);
   const bool is16bitFetch = (inputTy->getScalarSizeInBits() == 16);
 
   // Do the first vertex fetch operation
@@ -716,36 +747,236 @@ Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription
   } else
     vertexFetch = vertexFetches[0];
 
-  // Finalize vertex fetch
+  return finalizeVertexFetch(inputTy, vertexFetch, location, compIdx, insertPos);
+}
+
+// =====================================================================================================================
+// Executes vertex fetch operations for the uber fetch shader. The binding, offset, input rate and format of the
+// attribute are read at run time from the attribute table, whose 16-byte entries (indexed by location) have the layout
+// of Vkgc::UberFetchShaderAttribInfo. The format is applied by replacing DWORD3 of the vertex buffer descriptor and
+// doing format buffer loads, so the hardware does the conversion and fills in the default values of missing
+// components. An attribute whose offset or stride is not aligned to its element size is fetched one component at a
+// time, as in addVertexFetchInst(). Before GFX9, the alpha channel of an attribute flagged as a signed 2_10_10_10
+// format is fixed up as in fetchVertex().
+//
+// @param inputTy : Type of vertex input
+// @param attribTable : Buffer pointer to the attribute table
+// @param location : Vertex input location
+// @param compIdx : Index used for vector element indexing
+// @param builder : Builder to use to insert vertex fetch instructions
+Value *VertexFetchImpl::fetchVertexUber(Type *inputTy, Value *attribTable, unsigned location, unsigned compIdx,
+                                        BuilderBase &builder) {
+  Instruction *insertPos = &*builder.GetInsertPoint();
+
+  // Load the table entry of this location.
+  Type *attribInfoTy = FixedVectorType::get(builder.getInt32Ty(), 4);
+  Value *attribInfoPtr =
+      builder.CreateBitCast(attribTable, attribInfoTy->getPointerTo(attribTable->getType()->getPointerAddressSpace()));
+  attribInfoPtr = builder.CreateConstInBoundsGEP1_32(attribInfoTy, attribInfoPtr, location);
+  LoadInst *attribInfo = builder.CreateLoad(attribInfoTy, attribInfoPtr);
+  attribInfo->setMetadata(LLVMContext::MD_invariant_load, MDNode::get(attribInfo->getContext(), {}));
+  attribInfo->setAlignment(Align(16));
+  Value *bindingAndFlags = builder.CreateExtractElement(attribInfo, uint64_t(0));
+  Value *offset = builder.CreateExtractElement(attribInfo, 1);
+  Value *divisor = builder.CreateExtractElement(attribInfo, 2);
+  Value *bufferFormat = builder.CreateExtractElement(attribInfo, 3);
+
+  // Load the vertex buffer descriptor of the binding, get the stride from its DWORD1, and give it the format of the
+  // attribute.
+  Value *binding = builder.CreateZExt(builder.CreateAnd(bindingAndFlags, 0xFF), builder.getInt64Ty());
+  Value *vbDesc = loadVertexBufferDescriptor(binding, builder);
+  Value *stride = builder.CreateAnd(builder.CreateLShr(builder.CreateExtractElement(vbDesc, 1), 16), 0x3FFF);
+  Value *formatDesc = builder.CreateInsertElement(vbDesc, bufferFormat, 3);
+
+  // Select the vertex buffer index by the input rate.
+  if (!m_vertexIndex) {
+    auto savedInsertPoint = builder.saveIP();
+    builder.SetInsertPoint(&*insertPos->getFunction()->front().getFirstInsertionPt());
+    m_vertexIndex = ShaderInputs::getVertexIndex(builder, *m_lgcContext);
+    builder.restoreIP(savedInsertPoint);
+  }
+  Value *baseInstance = ShaderInputs::getSpecialUserData(UserDataMapping::BaseInstance, builder);
+  Value *instanceId = ShaderInputs::getInput(ShaderInput::InstanceId, builder, *m_lgcContext);
+  Value *isDivisorZero = builder.CreateICmpEQ(divisor, builder.getInt32(0));
+  Value *instanceIndex =
+      builder.CreateUDiv(instanceId, builder.CreateSelect(isDivisorZero, builder.getInt32(1), divisor));
+  instanceIndex = builder.CreateSelect(isDivisorZero, baseInstance, builder.CreateAdd(instanceIndex, baseInstance));
+  Value *isPerInstance = builder.CreateICmpNE(builder.CreateAnd(bindingAndFlags, 0x100), builder.getInt32(0));
+  Value *vbIndex = builder.CreateSelect(isPerInstance, instanceIndex, m_vertexIndex);
+
+  // Does a format buffer load at the given byte offset in the vertex. If the offset is not less than the stride, the
+  // vertex buffer index and the offset are adjusted accordingly. Otherwise, vertex fetch might behave unexpectedly.
+  Value *isStrideZero = builder.CreateICmpEQ(stride, builder.getInt32(0));
+  Value *safeStride = builder.CreateSelect(isStrideZero, builder.getInt32(1), stride);
+  auto createFormatLoad = [&](Type *fetchTy, Value *desc, Value *fetchOffset) {
+    Value *indexOffset =
+        builder.CreateSelect(isStrideZero, builder.getInt32(0), builder.CreateUDiv(fetchOffset, safeStride));
+    Value *index = builder.CreateAdd(vbIndex, indexOffset);
+    fetchOffset = builder.CreateSub(fetchOffset, builder.CreateMul(indexOffset, stride));
+    return builder.CreateIntrinsic(Intrinsic::amdgcn_struct_buffer_load_format, fetchTy,
+                                   {desc, index, fetchOffset, builder.getInt32(0), builder.getInt32(0)});
+  };
+
+  // The fetch result is <4 x i32>, or <8 x i32> for a 64-bit input with more than two components.
+  const unsigned bitWidth = inputTy->getScalarSizeInBits();
+  const unsigned inputCompCount = inputTy->isVectorTy() ? cast<FixedVectorType>(inputTy)->getNumElements() : 1;
+  const unsigned fetchCompCount = (bitWidth == 64 && inputCompCount > 2) ? 8 : 4;
+  Type *fetchResultTy = FixedVectorType::get(builder.getInt32Ty(), fetchCompCount);
+
+  Value *isPacked = builder.CreateICmpNE(builder.CreateAnd(bindingAndFlags, 0x200), builder.getInt32(0));
+  Instruction *packedTerm = nullptr;
+  Instruction *alignedTerm = nullptr;
+  SplitBlockAndInsertIfThenElse(isPacked, insertPos, &packedTerm, &alignedTerm);
+
+  // Unaligned attribute: fetch each component with the component format and identity destination swizzle, and take
+  // the default value for the components the format does not have.
+  builder.SetInsertPoint(packedTerm);
+  Value *packedFetch = nullptr;
+  {
+    Value *compCount = builder.CreateAnd(builder.CreateLShr(bindingAndFlags, 11), 0xF);
+    Value *compByteSize = builder.CreateAnd(builder.CreateLShr(bindingAndFlags, 15), 0xF);
+    Value *compFormat = builder.CreateAnd(builder.CreateLShr(bindingAndFlags, 19), 0x7F);
+    static const unsigned DstSelXyzw = 4 | (5 << 3) | (6 << 6) | (7 << 9);
+    Value *compDword3 = builder.CreateOr(builder.CreateAnd(bufferFormat, ~0x7FFFFU),
+                                         builder.CreateOr(builder.CreateShl(compFormat, 12), DstSelXyzw));
+    Value *compDesc = builder.CreateInsertElement(vbDesc, compDword3, 3);
+    Constant *defaults = getFetchDefaults(inputTy);
+    packedFetch = UndefValue::get(fetchResultTy);
+    for (unsigned i = 0; i != fetchCompCount; ++i) {
+      Value *compOffset = builder.CreateAdd(offset, builder.CreateMul(compByteSize, builder.getInt32(i)));
+      Value *compFetch = createFormatLoad(bitWidth == 16 ? builder.getHalfTy() : builder.getFloatTy(), compDesc,
+                                          compOffset);
+      if (bitWidth == 16)
+        compFetch = builder.CreateZExt(builder.CreateBitCast(compFetch, builder.getInt16Ty()), builder.getInt32Ty());
+      else
+        compFetch = builder.CreateBitCast(compFetch, builder.getInt32Ty());
+      Value *defaultValue = i < cast<FixedVectorType>(defaults->getType())->getNumElements()
+                                ? defaults->getAggregateElement(i)
+                                : builder.getInt32(0);
+      compFetch = builder.CreateSelect(builder.CreateICmpULT(builder.getInt32(i), compCount), compFetch, defaultValue);
+      packedFetch = builder.CreateInsertElement(packedFetch, compFetch, i);
+    }
+    // Formats with BGRA component order are swizzled to RGBA.
+    Value *isBgra = builder.CreateICmpNE(builder.CreateAnd(bindingAndFlags, 0x400), builder.getInt32(0));
+    Value *swizzled = builder.CreateShuffleVector(packedFetch, packedFetch,
+                                                  fetchCompCount == 4 ? ArrayRef<int>({2, 1, 0, 3})
+                                                                      : ArrayRef<int>({2, 1, 0, 3, 4, 5, 6, 7}));
+    packedFetch = builder.CreateSelect(isBgra, swizzled, packedFetch);
+  }
+
+  // Aligned attribute: fetch the whole vertex with the attribute format. A 64-bit input with more than two components
+  // needs a second load of the next 16 bytes.
+  builder.SetInsertPoint(alignedTerm);
+  Value *alignedFetches[2] = {};
+  for (unsigned i = 0; i != fetchCompCount / 4; ++i) {
+    Value *fetchOffset = i == 0 ? offset : builder.CreateAdd(offset, builder.getInt32(SizeOfVec4));
+    Type *fetchTy = FixedVectorType::get(bitWidth == 16 ? builder.getHalfTy() : builder.getFloatTy(), 4);
+    Value *fetch = createFormatLoad(fetchTy, formatDesc, fetchOffset);
+    if (bitWidth == 16) {
+      // NOTE: The result of a 16-bit fetch is widened to <4 x i32> here so it can be finalized in the same way as
+      // the other fetches.
+      fetch = builder.CreateBitCast(fetch, FixedVectorType::get(builder.getInt16Ty(), 4));
+      fetch = builder.CreateZExt(fetch, FixedVectorType::get(builder.getInt32Ty(), 4));
+    } else {
+      fetch = builder.CreateBitCast(fetch, FixedVectorType::get(builder.getInt32Ty(), 4));
+    }
+    alignedFetches[i] = fetch;
+  }
+  Value *alignedFetch = alignedFetches[0];
+  if (fetchCompCount == 8)
+    alignedFetch = builder.CreateShuffleVector(alignedFetches[0], alignedFetches[1],
+                                               ArrayRef<int>({0, 1, 2, 3, 4, 5, 6, 7}));
+
+  builder.SetInsertPoint(insertPos);
+  PHINode *vertexFetch = builder.CreatePHI(fetchResultTy, 2);
+  vertexFetch->addIncoming(packedFetch, packedTerm->getParent());
+  vertexFetch->addIncoming(alignedFetch, alignedTerm->getParent());
+
+  Value *fetch = vertexFetch;
+  if (m_lgcContext->getTargetInfo().getGfxIpVersion().major < 9 && bitWidth == 32 && fetchCompCount == 4) {
+    // NOTE: For the signed 2_10_10_10 formats, vertex fetches incorrectly return the alpha channel as unsigned. The
+    // format is only known at run time, so compute the fixed-up alpha for each of them and select by NUM_FORMAT.
+    Value *isSignedA2 = builder.CreateICmpNE(builder.CreateAnd(bindingAndFlags, 0x4000000), builder.getInt32(0));
+    Value *numFormat = builder.CreateAnd(builder.CreateLShr(bufferFormat, 12), 0x7);
+    Value *alpha = builder.CreateExtractElement(fetch, 3);
+    Value *floatAlpha = builder.CreateBitCast(alpha, builder.getFloatTy());
+
+    // SINT: sign-extend the alpha channel.
+    Value *sintAlpha = builder.CreateAShr(builder.CreateShl(alpha, 30), 30);
+
+    // SNORM: remap the values { 0.0, 0.33, 0.66, 1.00 } to { 0.0, 1.0, -1.0, -1.0 } respectively.
+    Value *snormAlpha = builder.CreateFMul(floatAlpha, ConstantFP::get(builder.getFloatTy(), 3.0));
+    snormAlpha = builder.CreateSelect(builder.CreateFCmpUGT(snormAlpha, ConstantFP::get(builder.getFloatTy(), 1.5)),
+                                      ConstantFP::get(builder.getFloatTy(), -1.0), snormAlpha);
+
+    // SSCALED: remap the values { 0.0, 1.0, 2.0, 3.0 } to { 0.0, 1.0, -2.0, -1.0 } respectively.
+    Value *sscaledAlpha = builder.CreateFPToSI(floatAlpha, builder.getInt32Ty());
+    sscaledAlpha = builder.CreateAShr(builder.CreateShl(sscaledAlpha, 30), 30);
+    sscaledAlpha = builder.CreateSIToFP(sscaledAlpha, builder.getFloatTy());
+
+    Value *fixedAlpha = builder.CreateSelect(builder.CreateICmpEQ(numFormat, builder.getInt32(BUF_NUM_FORMAT_SINT)),
+                                             sintAlpha, alpha);
+    fixedAlpha = builder.CreateSelect(builder.CreateICmpEQ(numFormat, builder.getInt32(BUF_NUM_FORMAT_SNORM)),
+                                      builder.CreateBitCast(snormAlpha, builder.getInt32Ty()), fixedAlpha);
+    fixedAlpha = builder.CreateSelect(builder.CreateICmpEQ(numFormat, builder.getInt32(BUF_NUM_FORMAT_SSCALED)),
+                                      builder.CreateBitCast(sscaledAlpha, builder.getInt32Ty()), fixedAlpha);
+    fetch = builder.CreateInsertElement(fetch, builder.CreateSelect(isSignedA2, fixedAlpha, alpha), 3);
+  }
+
+  return finalizeVertexFetch(inputTy, fetch, location, compIdx, insertPos);
+}
+
+// =====================================================================================================================
+// Gets the default fetch values of a vertex input, as <n x i32>, for the components its vertex fetch does not return.
+//
+// @param inputTy : Type of vertex input
+Constant *VertexFetchImpl::getFetchDefaults(Type *inputTy) const {
   Type *basicTy = inputTy->isVectorTy() ? cast<VectorType>(inputTy)->getElementType() : inputTy;
   const unsigned bitWidth = basicTy->getScalarSizeInBits();
   assert(bitWidth == 8 || bitWidth == 16 || bitWidth == 32 || bitWidth == 64);
 
-  // Get default fetch values
-  Constant *defaults = nullptr;
-
   if (basicTy->isIntegerTy()) {
     if (bitWidth == 8)
-      defaults = m_fetchDefaults.int8;
-    else if (bitWidth == 16)
-      defaults = m_fetchDefaults.int16;
-    else if (bitWidth == 32)
-      defaults = m_fetchDefaults.int32;
-    else {
-      assert(bitWidth == 64);
-      defaults = m_fetchDefaults.int64;
-    }
-  } else if (basicTy->isFloatingPointTy()) {
+      return m_fetchDefaults.int8;
     if (bitWidth == 16)
-      defaults = m_fetchDefaults.float16;
-    else if (bitWidth == 32)
-      defaults = m_fetchDefaults.float32;
-    else {
-      assert(bitWidth == 64);
-      defaults = m_fetchDefaults.double64;
-    }
-  } else
-    llvm_unreachable("Should never be called!");
+      return m_fetchDefaults.int16;
+    if (bitWidth == 32)
+      return m_fetchDefaults.int32;
+    assert(bitWidth == 64);
+    return m_fetchDefaults.int64;
+  }
+  if (basicTy->isFloatingPointTy()) {
+    if (bitWidth == 16)
+      return m_fetchDefaults.float16;
+    if (bitWidth == 32)
+      return m_fetchDefaults.float32;
+    assert(bitWidth == 64);
+    return m_fetchDefaults.double64;
+  }
+  llvm_unreachable("Should never be called!");
+  return nullptr;
+}
+
+// =====================================================================================================================
+// Extracts the components of a vertex input from the result of its vertex fetch operations, filling in the
+// components that were not fetched with default values, and converts them to the input type.
+//
+// @param inputTy : Type of vertex input
+// @param vertexFetch : Result of vertex fetch operations, as <n x i32>
+// @param location : Vertex input location (only used for an IR name, not for functionality)
+// @param compIdx : Index used for vector element indexing
+// @param insertPos : Where to insert instructions
+Value *VertexFetchImpl::finalizeVertexFetch(Type *inputTy, Value *vertexFetch, unsigned location, unsigned compIdx,
+                                            Instruction *insertPos) {
+  Value *vertex = nullptr;
+  const bool is8bitFetch = (inputTy->getScalarSizeInBits() == 8);
+  const bool is16bitFetch = (inputTy->getScalarSizeInBits() == 16);
+
+  Type *basicTy = inputTy->isVectorTy() ? cast<VectorType>(inputTy)->getElementType() : inputTy;
+  const unsigned bitWidth = basicTy->getScalarSizeInBits();
+
+  // Get default fetch values
+  Constant *defaults = getFetchDefaults(inputTy);
 
   const unsigned defaultCompCount = cast<FixedVectorType>(defaults->getType())->getNumElements();
   std::vector<Value *> defaultValues(defaultCompCount);
@@ -919,9 +1150,9 @@ unsigned VertexFetchImpl::mapVertexFormat(unsigned dfmt, unsigned nfmt) const {
 // =====================================================================================================================
 // Loads vertex descriptor based on the specified vertex input location.
 //
-// @param binding : ID of vertex buffer binding
+// @param binding : ID of vertex buffer binding, as i64
 // @param builder : Builder with insert point set
-Value *VertexFetchImpl::loadVertexBufferDescriptor(unsigned binding, BuilderBase &builder) {
+Value *VertexFetchImpl::loadVertexBufferDescriptor(Value *binding, BuilderBase &builder) {
 
   // Get the vertex buffer table pointer as pointer to v4i32 descriptor.
   Type *vbDescTy = FixedVectorType::get(Type::getInt32Ty(*m_context), 4);
@@ -933,7 +1164,7 @@ Value *VertexFetchImpl::loadVertexBufferDescriptor(unsigned binding, BuilderBase
     builder.restoreIP(savedInsertPoint);
   }
 
-  Value *vbDescPtr = builder.CreateGEP(vbDescTy, m_vertexBufTablePtr, builder.getInt64(binding));
+  Value *vbDescPtr = builder.CreateGEP(vbDescTy, m_vertexBufTablePtr, binding);
   LoadInst *vbDesc = builder.CreateLoad(vbDescTy, vbDescPtr);
   vbDesc->setMetadata(LLVMContext::MD_invariant_load, MDNode::get(vbDesc->getContext(), {}));
   vbDesc->setAlignment(Align(16));
@@ -124,9 +124,15 @@ Module *PipelineState::irLink(ArrayRef<Module *> modules, PipelineLink pipelineL
   assert(shaderStageMask == getShaderStageMask());
 #endif
 
-  // If the front-end was using a BuilderRecorder, record pipeline state into IR metadata.
-  if (!m_noReplayer)
-    record(modules[0]);
+  // If the front-end was using a BuilderRecorder, the pipeline state needs to get to the middle-end. If the IR is
+  // going to be emitted for a later LGC run (-emit-lgc), record pipeline state into IR metadata. For an in-process
+  // compile, generate() hands this PipelineState straight to the middle-end instead.
+  if (!m_noReplayer) {
+    if (m_emitLgc)
+      record(modules[0]);
+    else
+      m_useStateDirectly = true;
+  }
 
   // If there is only one shader, just change the name on its module and return it.
   Module *pipelineModule = nullptr;
@@ -208,11 +214,13 @@ void PipelineState::generateWithNewPassManager(std::unique_ptr<Module> pipelineM
   getLgcContext()->preparePassManager(*passMgr);
 
   // Manually add a PipelineStateWrapper pass.
-  // If we were not using BuilderRecorder, give our PipelineState to it. (In the BuilderRecorder case,
-  // the first time PipelineStateWrapper is used, it allocates its own PipelineState and populates
-  // it by reading IR metadata.)
+  // If we were not using BuilderRecorder, or irLink did not record pipeline state into IR metadata, give our
+  // PipelineState to it. (Otherwise, the first time PipelineStateWrapper is used, it allocates its own
+  // PipelineState and populates it by reading IR metadata.)
+  if (m_useStateDirectly)
+    initializeInOutPackState();
   passMgr->registerModuleAnalysis([&] {
-    if (m_noReplayer)
+    if (m_noReplayer || m_useStateDirectly)
       return PipelineStateWrapper(this);
     return PipelineStateWrapper(getLgcContext());
   });
@@ -254,12 +262,14 @@ void PipelineState::generateWithLegacyPassManager(std::unique_ptr<Module> pipeli
   getLgcContext()->preparePassManager(&*passMgr);
 
   // Manually add a PipelineStateWrapper pass.
-  // If we were not using BuilderRecorder, give our PipelineState to it. (In the BuilderRecorder case,
-  // the first time PipelineStateWrapper is used, it allocates its own PipelineState and populates
-  // it by reading IR metadata.)
+  // If we were not using BuilderRecorder, or irLink did not record pipeline state into IR metadata, give our
+  // PipelineState to it. (Otherwise, the first time PipelineStateWrapper is used, it allocates its own
+  // PipelineState and populates it by reading IR metadata.)
   LegacyPipelineStateWrapper *pipelineStateWrapper = new LegacyPipelineStateWrapper(getLgcContext());
   passMgr->add(pipelineStateWrapper);
-  if (m_noReplayer)
+  if (m_useStateDirectly)
+    initializeInOutPackState();
+  if (m_noReplayer || m_useStateDirectly)
     pipelineStateWrapper->setPipelineState(this);
 
   if (m_emitLgc) {
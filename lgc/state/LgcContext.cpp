@@ -45,6 +45,7 @@
 #include "llvm/InitializePasses.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
 #if LLVM_MAIN_REVISION && LLVM_MAIN_REVISION < 401324
 // Old version
 #include "llvm/Support/TargetRegistry.h"
@@ -55,6 +56,8 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include <map>
+#include <mutex>
 
 #define DEBUG_TYPE "lgc-context"
 
@@ -96,6 +99,71 @@ static cl::opt<bool> EmitLgc("emit-lgc", cl::desc("Emit LLVM assembly suitable f
 // -show-encoding: show the instruction encoding when emitting assembler. This mirrors llvm-mc behaviour
 static cl::opt<bool> ShowEncoding("show-encoding", cl::desc("Show instruction encodings"), cl::init(false));
 
+// -target-machine-pool-size: maximum number of idle target machines kept for reuse per GPU
+static cl::opt<unsigned> TargetMachinePoolSize("target-machine-pool-size",
+                                               cl::desc("Maximum number of idle target machines kept for reuse per "
+                                                        "GPU (0 to disable)"),
+                                               cl::init(4));
+
+namespace {
+
+// =====================================================================================================================
+// Pool of idle target machines, keyed by the GPU name and the options they were created with. Creating a
+// TargetMachine and its subtarget tables is costly, and a client that recycles its LLVM contexts would otherwise
+// create one for the same GPU again and again.
+//
+// NOTE: A TargetMachine lazily caches subtargets per function attribute set without any locking, so it cannot be
+// used by concurrent compiles. An LgcContext therefore takes a target machine out of the pool for its lifetime and
+// puts it back when it is destroyed, rather than sharing it with other live LgcContexts.
+class TargetMachinePool {
+public:
+  ~TargetMachinePool() {
+    for (auto &entry : m_idleTargetMachines) {
+      for (TargetMachine *targetMachine : entry.second)
+        delete targetMachine;
+    }
+  }
+
+  // Take an idle target machine with the given key out of the pool. Returns nullptr if there is none.
+  TargetMachine *acquire(const std::string &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_idleTargetMachines.find(key);
+    if (it == m_idleTargetMachines.end() || it->second.empty())
+      return nullptr;
+    TargetMachine *targetMachine = it->second.back();
+    it->second.pop_back();
+    return targetMachine;
+  }
+
+  // Put a target machine that is no longer used back into the pool. If the pool is full, the least recently
+  // released target machine is deleted.
+  void release(const std::string &key, TargetMachine *targetMachine) {
+    if (TargetMachinePoolSize == 0) {
+      delete targetMachine;
+      return;
+    }
+    TargetMachine *evicted = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto &idleTargetMachines = m_idleTargetMachines[key];
+      if (idleTargetMachines.size() >= TargetMachinePoolSize) {
+        evicted = idleTargetMachines.front();
+        idleTargetMachines.erase(idleTargetMachines.begin());
+      }
+      idleTargetMachines.push_back(targetMachine);
+    }
+    delete evicted;
+  }
+
+private:
+  std::mutex m_mutex;                                                       // Mutex guarding the pool
+  std::map<std::string, std::vector<TargetMachine *>> m_idleTargetMachines; // Idle target machines per key
+};
+
+} // anonymous namespace
+
+static ManagedStatic<TargetMachinePool> TheTargetMachinePool;
+
 // =====================================================================================================================
 // Set default for a command-line option, but only if command-line processing has not happened yet, or did not see
 // an occurrence of this option.
@@ -252,8 +320,14 @@ LgcContext *LgcContext::Create(LLVMContext &context, StringRef gpuName, unsigned
 
   LLPC_OUTS("TargetMachine optimization level = " << cl::OptLevel << "\n");
 
-  builderContext->m_targetMachine =
-      target->createTargetMachine(triple, gpuName, "", targetOpts, Optional<Reloc::Model>(), None, cl::OptLevel);
+  // Reuse an idle target machine created earlier with the same settings if there is one.
+  builderContext->m_targetMachineKey =
+      (Twine(gpuName) + "," + Twine(unsigned(cl::OptLevel)) + "," + Twine(unsigned(ShowEncoding))).str();
+  builderContext->m_targetMachine = TheTargetMachinePool->acquire(builderContext->m_targetMachineKey);
+  if (!builderContext->m_targetMachine) {
+    builderContext->m_targetMachine =
+        target->createTargetMachine(triple, gpuName, "", targetOpts, Optional<Reloc::Model>(), None, cl::OptLevel);
+  }
   assert(builderContext->m_targetMachine);
   return builderContext;
 }
@@ -267,7 +341,8 @@ LgcContext::LgcContext(LLVMContext &context, unsigned palAbiVersion) : m_context
 
 // =====================================================================================================================
 LgcContext::~LgcContext() {
-  delete m_targetMachine;
+  if (m_targetMachine)
+    TheTargetMachinePool->release(m_targetMachineKey, m_targetMachine);
   delete m_targetInfo;
   delete m_passManagerCache;
 }
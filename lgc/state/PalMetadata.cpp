@@ -611,6 +611,45 @@ void PalMetadata::setRegister(unsigned regNum, unsigned value) {
   node = value;
 }
 
+// =====================================================================================================================
+// Set the occupancy ceiling implied by LDS usage and workgroup size for a hardware shader stage.
+//
+// @param callingConv : Calling convention of the hardware shader stage
+// @param maxWavesPerEu : Maximum number of waves per SIMD
+void PalMetadata::setMaxWavesPerEu(unsigned callingConv, unsigned maxWavesPerEu) {
+  Util::Abi::HardwareStage hwStage = Util::Abi::HardwareStage::Invalid;
+  switch (callingConv) {
+  case CallingConv::AMDGPU_LS:
+    hwStage = Util::Abi::HardwareStage::Ls;
+    break;
+  case CallingConv::AMDGPU_HS:
+    hwStage = Util::Abi::HardwareStage::Hs;
+    break;
+  case CallingConv::AMDGPU_ES:
+    hwStage = Util::Abi::HardwareStage::Es;
+    break;
+  case CallingConv::AMDGPU_GS:
+    hwStage = Util::Abi::HardwareStage::Gs;
+    break;
+  case CallingConv::AMDGPU_VS:
+    hwStage = Util::Abi::HardwareStage::Vs;
+    break;
+  case CallingConv::AMDGPU_PS:
+    hwStage = Util::Abi::HardwareStage::Ps;
+    break;
+  case CallingConv::AMDGPU_CS:
+    hwStage = Util::Abi::HardwareStage::Cs;
+    break;
+  default:
+    llvm_unreachable("Unexpected calling convention.");
+  }
+
+  auto hwShaderNode = m_pipelineNode[Util::Abi::PipelineMetadataKey::HardwareStages]
+                          .getMap(true)[HwStageNames[unsigned(hwStage)]]
+                          .getMap(true);
+  hwShaderNode[Util::Abi::HardwareStageMetadataKey::MaxWavesPerEu] = maxWavesPerEu;
+}
+
 // =====================================================================================================================
 // Set userDataLimit to maximum (the size of the root user data table, excluding vertex buffer and streamout).
 // This is called if spill is in use, or if there are root user data nodes but none of them are used (PAL does
@@ -59,6 +59,7 @@ static const char DeviceIndexMetadataName[] = "lgc.device.index";
 static const char VertexInputsMetadataName[] = "lgc.vertex.inputs";
 static const char IaStateMetadataName[] = "lgc.input.assembly.state";
 static const char RsStateMetadataName[] = "lgc.rasterizer.state";
+static const char DsStateMetadataName[] = "lgc.depth.stencil.state";
 static const char ColorExportFormatsMetadataName[] = "lgc.color.export.formats";
 static const char ColorExportStateMetadataName[] = "lgc.color.export.state";
 
@@ -296,6 +297,7 @@ void PipelineState::clear(Module *module) {
   m_colorExportState = {};
   m_inputAssemblyState = {};
   m_rasterizerState = {};
+  m_depthStencilState = {};
   record(module);
 }
 
@@ -1082,28 +1084,146 @@ void PipelineState::readDeviceIndex(Module *module) {
 }
 
 // =====================================================================================================================
-// Record graphics state (iastate, vpstate, rsstate) into the IR metadata
+// Record graphics state (iastate, vpstate, rsstate, dsstate) into the IR metadata
 //
 // @param [in/out] module : IR module to record into
 void PipelineState::recordGraphicsState(Module *module) {
   setNamedMetadataToArrayOfInt32(module, m_inputAssemblyState, IaStateMetadataName);
   setNamedMetadataToArrayOfInt32(module, m_rasterizerState, RsStateMetadataName);
+  setNamedMetadataToArrayOfInt32(module, m_depthStencilState, DsStateMetadataName);
 }
 
 // =====================================================================================================================
-// Read graphics state (device index, iastate, vpstate, rsstate) from the IR metadata
+// Read graphics state (device index, iastate, vpstate, rsstate, dsstate) from the IR metadata
 //
 // @param [in/out] module : IR module to read from
 void PipelineState::readGraphicsState(Module *module) {
   readNamedMetadataArrayOfInt32(module, IaStateMetadataName, m_inputAssemblyState);
   readNamedMetadataArrayOfInt32(module, RsStateMetadataName, m_rasterizerState);
+  readNamedMetadataArrayOfInt32(module, DsStateMetadataName, m_depthStencilState);
 }
 
 // =====================================================================================================================
 // Determine whether to use off-chip tessellation mode
+//
+// NOTE: On GFX6~8, the mode is selected per pipeline by PatchResourceCollect (see setTessOffChip). The command line
+// option forces off-chip mode.
 bool PipelineState::isTessOffChip() {
   // For GFX9+, always enable tessellation off-chip mode
-  return EnableTessOffChip || getLgcContext()->getTargetInfo().getGfxIpVersion().major >= 9;
+  if (EnableTessOffChip || getLgcContext()->getTargetInfo().getGfxIpVersion().major >= 9)
+    return true;
+  return m_tessOffChip;
+}
+
+// =====================================================================================================================
+// Gets the stride (in dwords) of the tessellation factors of a patch in the tessellation factor buffer
+unsigned PipelineState::getTessFactorStride() {
+  switch (getShaderModes()->getTessellationMode().primitiveMode) {
+  case PrimitiveMode::Triangles:
+    return 4;
+  case PrimitiveMode::Quads:
+    return 6;
+  case PrimitiveMode::Isolines:
+    return 2;
+  default:
+    llvm_unreachable("Should never be called!");
+  }
+}
+
+// =====================================================================================================================
+// Calculates the patch count for per-thread group.
+//
+// @param tessOffChip : Whether tessellation off-chip mode is used
+// @param inVertexCount : Count of vertices of input patch
+// @param inVertexStride : Vertex stride of input patch in (dwords)
+// @param outVertexCount : Count of vertices of output patch
+// @param outVertexStride : Vertex stride of output patch in (dwords)
+// @param patchConstCount : Count of output patch constants
+// @param tessFactorStride : Stride of tessellation factors (dwords)
+unsigned PipelineState::calcPatchCountPerThreadGroup(bool tessOffChip, unsigned inVertexCount, unsigned inVertexStride,
+                                                     unsigned outVertexCount, unsigned outVertexStride,
+                                                     unsigned patchConstCount, unsigned tessFactorStride) {
+  const unsigned waveSize = getShaderWaveSize(ShaderStageTessControl);
+
+  // NOTE: The limit of thread count for tessellation control shader is 4 wavefronts per thread group.
+  const unsigned maxThreadCountPerThreadGroup = (4 * waveSize);
+  const unsigned maxThreadCountPerPatch = std::max(inVertexCount, outVertexCount);
+  const unsigned patchCountLimitedByThread = maxThreadCountPerThreadGroup / maxThreadCountPerPatch;
+
+  const unsigned inPatchSize = (inVertexCount * inVertexStride);
+  const unsigned outPatchSize = (outVertexCount * outVertexStride);
+  const unsigned patchConstSize = patchConstCount * 4;
+
+  // Compute the required LDS size per patch, always include the space for VS vertex out. In on-chip mode, TCS outputs
+  // and patch constants are stored in LDS as well.
+  unsigned ldsSizePerPatch = inPatchSize;
+  if (!tessOffChip)
+    ldsSizePerPatch += outPatchSize + patchConstSize;
+  unsigned patchCountLimitedByLds =
+      (getTargetInfo().getGpuProperty().ldsSizePerThreadGroup / ldsSizePerPatch);
+
+  unsigned patchCountPerThreadGroup = std::min(patchCountLimitedByThread, patchCountLimitedByLds);
+
+  // NOTE: Performance analysis shows that 16 patches per thread group is an optimal upper-bound. The value is only
+  // an experimental number. For GFX9. 64 is an optimal number instead.
+  const unsigned optimalPatchCountPerThreadGroup = getTargetInfo().getGfxIpVersion().major >= 9 ? 64 : 16;
+
+  patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, optimalPatchCountPerThreadGroup);
+
+  if (tessOffChip) {
+    auto outPatchLdsBufferSize = (outPatchSize + patchConstSize) * 4;
+    auto tessOffChipPatchCountPerThreadGroup =
+        getTargetInfo().getGpuProperty().tessOffChipLdsBufferSize / outPatchLdsBufferSize;
+    patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, tessOffChipPatchCountPerThreadGroup);
+  }
+
+  // TF-Buffer-based limit for Patchers per Thread Group:
+  // ---------------------------------------------------------------------------------------------
+
+  // There is one TF Buffer per shader engine. We can do the below calculation on a per-SE basis.  It is also safe to
+  // assume that one thread-group could at most utilize all of the TF Buffer.
+  const unsigned tfBufferSizeInBytes =
+      sizeof(unsigned) * getTargetInfo().getGpuProperty().tessFactorBufferSizePerSe;
+  unsigned tfBufferPatchCountLimit = tfBufferSizeInBytes / (tessFactorStride * sizeof(unsigned));
+
+  const auto workarounds = &getTargetInfo().getGpuWorkarounds();
+  if (workarounds->gfx10.waTessFactorBufferSizeLimitGeUtcl1Underflow) {
+    tfBufferPatchCountLimit /= 2;
+  }
+
+  patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, tfBufferPatchCountLimit);
+
+  if (tessOffChip) {
+    // For all-offchip tessellation, we need to write an additional 4-byte TCS control word to the TF buffer whenever
+    // the patch-ID is zero.
+    const unsigned offChipTfBufferPatchCountLimit =
+        (tfBufferSizeInBytes - (patchCountPerThreadGroup * sizeof(unsigned))) / (tessFactorStride * sizeof(unsigned));
+    patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, offChipTfBufferPatchCountLimit);
+  }
+
+  // Adjust the patches-per-thread-group based on hardware workarounds.
+  if (getTargetInfo().getGpuWorkarounds().gfx6.miscLoadBalancePerWatt != 0) {
+    const unsigned waveSize = getTargetInfo().getGpuProperty().waveSize;
+    // Load balance per watt is a mechanism which monitors HW utilization (num waves active, instructions issued
+    // per cycle, etc.) to determine if the HW can handle the workload with fewer CUs enabled.  The SPI_LB_CU_MASK
+    // register directs the SPI to stop launching waves to a CU so it will be clock-gated.  There is a bug in the
+    // SPI which where that register setting is applied immediately, which causes any pending LS/HS/CS waves on
+    // that CU to never be launched.
+    //
+    // The workaround is to limit each LS/HS threadgroup to a single wavefront: if there's only one wave, then the
+    // CU can safely be turned off afterwards.  A microcode fix exists for CS but for GFX it was decided that the
+    // cost in power efficiency wasn't worthwhile.
+    //
+    // Clamping to threads-per-wavefront / max(input control points, threads-per-patch) will make the hardware
+    // launch a single LS/HS wave per thread-group.
+    // For vulkan, threads-per-patch is always equal with outVertexCount.
+    const unsigned maxThreadCountPerPatch = std::max(inVertexCount, outVertexCount);
+    const unsigned maxPatchCount = waveSize / maxThreadCountPerPatch;
+
+    patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, maxPatchCount);
+  }
+
+  return patchCountPerThreadGroup;
 }
 
 // =====================================================================================================================
@@ -1509,6 +1629,16 @@ bool PipelineState::canPackOutput(ShaderStage shaderStage) {
   return m_outputPackState[shaderStage];
 }
 
+// =====================================================================================================================
+// Get whether 8-bit/16-bit GS outputs are packed two per dword in the GS-VS ring (GS-VS LDS for on-chip GS and NGG),
+// rather than each being extended to a dword. The packed dwords are passed as they are to the FS, which reads them in
+// the same way as packed 16-bit outputs of VS/TES. Transform feedback outputs are written by the copy shader in
+// dwords, so the packing is not done when transform feedback is enabled.
+bool PipelineState::canPack16BitGsOutput() {
+  return hasShaderStage(ShaderStageGeometry) && m_outputPackState[ShaderStageGeometry] &&
+         !getShaderResourceUsage(ShaderStageGeometry)->inOutUsage.enableXfb;
+}
+
 // =====================================================================================================================
 // Get the count of vertices per primitive. For GS, the count is for output primitive.
 unsigned PipelineState::getVerticesPerPrimitive() {
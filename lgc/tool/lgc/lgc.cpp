@@ -36,9 +36,11 @@
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Target/TargetMachine.h"
+#include <chrono>
 
 using namespace lgc;
 using namespace llvm;
@@ -64,6 +66,11 @@ cl::opt<bool> Link("l", cl::cat(LgcCategory),
                    cl::desc("Link shader/part-pipeline ELFs. First input filename is "
                             "IR providing pipeline state; subsequent ones are ELF files."));
 
+// -link-repeat: benchmark linking
+cl::opt<unsigned> LinkRepeat("link-repeat", cl::cat(LgcCategory), cl::init(0), cl::value_desc("count"),
+                             cl::desc("With -l, first link the input ELFs the given number of times, each into a new "
+                                      "pipeline, and report link throughput"));
+
 // -o: output filename
 cl::opt<std::string> OutFileName("o", cl::cat(LgcCategory), cl::desc("Output filename ('-' for stdout)"),
                                  cl::value_desc("filename"));
@@ -121,6 +128,7 @@ int main(int argc, char **argv) {
   opts["filetype"]->addCategory(LgcCategory);
   opts["emit-llvm"]->addCategory(LgcCategory);
   opts["verify-ir"]->addCategory(LgcCategory);
+  opts["elf-linker-cache-size"]->addCategory(LgcCategory);
   cl::HideUnrelatedOptions(LgcCategory);
 
   // Parse command line.
@@ -307,6 +315,37 @@ int main(int argc, char **argv) {
         SmallVector<MemoryBufferRef, 4> elfRefs;
         for (unsigned i = 1; i != inBuffers.size(); ++i)
           elfRefs.push_back(inBuffers[i]->getMemBufferRef());
+
+        if (LinkRepeat) {
+          // Link throughput benchmark: link the same shader ELFs into many pipelines, as happens when
+          // pipelines share stages. Use -elf-linker-cache-size=0 to compare with parsing every input ELF each time.
+          // Glue shaders are compiled in the first link and then reused, as a client would from its cache.
+          SmallVector<std::string, 4> glueBlobs;
+          auto startTime = std::chrono::steady_clock::now();
+          for (unsigned i = 0; i != LinkRepeat; ++i) {
+            std::unique_ptr<Pipeline> benchPipeline(lgcContext->createPipeline());
+            benchPipeline->setStateFromModule(&*module);
+            std::unique_ptr<ElfLinker> benchLinker(benchPipeline->createElfLinker(elfRefs));
+            ArrayRef<StringRef> glueInfo = benchLinker->getGlueInfo();
+            for (unsigned glueIdx = 0; glueIdx != glueInfo.size(); ++glueIdx) {
+              if (glueIdx == glueBlobs.size())
+                glueBlobs.push_back(benchLinker->compileGlue(glueIdx).str());
+              else
+                benchLinker->addGlue(glueIdx, glueBlobs[glueIdx]);
+            }
+            SmallString<16> benchBuffer;
+            raw_svector_ostream benchStream(benchBuffer);
+            if (!benchLinker->link(benchStream)) {
+              // Link reported recoverable error.
+              errs() << benchPipeline->getLastError() << "\n";
+              return 1;
+            }
+          }
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+          errs() << progName << ": " << LinkRepeat << " links in " << format("%.3f", elapsed.count() * 1000.0)
+                 << " ms (" << format("%.1f", LinkRepeat / elapsed.count()) << " links/s)\n";
+        }
+
         std::unique_ptr<ElfLinker> elfLinker(pipeline->createElfLinker(elfRefs));
 
         if (Glue) {
@@ -0,0 +1,139 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Google LLC. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "lgc/LgcContext.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "gmock/gmock.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lgc;
+using namespace llvm;
+
+namespace {
+
+// GPU used by the tests
+const char TestGpuName[] = "gfx900";
+
+// =====================================================================================================================
+// Compile a small shader to ISA assembly with the target machine of a new LgcContext.
+//
+// @param gpuName : LLVM GPU name
+// @returns : ISA assembly text, or empty string on failure
+std::string compileTestShader(StringRef gpuName) {
+  LLVMContext context;
+  std::unique_ptr<LgcContext> lgcContext(LgcContext::Create(context, gpuName, 0));
+  if (!lgcContext)
+    return "";
+  TargetMachine *targetMachine = lgcContext->getTargetMachine();
+
+  auto module = std::make_unique<Module>("test", context);
+  module->setTargetTriple(targetMachine->getTargetTriple().getTriple());
+  module->setDataLayout(targetMachine->createDataLayout());
+
+  // define amdgpu_cs void @main(float addrspace(1)* inreg %out, float %value)
+  IRBuilder<> builder(context);
+  Type *outPtrTy = builder.getFloatTy()->getPointerTo(1);
+  auto funcTy = FunctionType::get(builder.getVoidTy(), {outPtrTy, builder.getFloatTy()}, false);
+  Function *func = Function::Create(funcTy, GlobalValue::ExternalLinkage, "main", *module);
+  func->setCallingConv(CallingConv::AMDGPU_CS);
+  func->addParamAttr(0, Attribute::InReg);
+  builder.SetInsertPoint(BasicBlock::Create(context, "", func));
+  Value *value = func->getArg(1);
+  Value *result = builder.CreateFAdd(builder.CreateFMul(value, value), ConstantFP::get(builder.getFloatTy(), 1.0));
+  builder.CreateStore(result, func->getArg(0));
+  builder.CreateRetVoid();
+
+  std::string isa;
+  {
+    raw_string_ostream isaStream(isa);
+    buffer_ostream outStream(isaStream);
+    legacy::PassManager passMgr;
+    if (targetMachine->addPassesToEmitFile(passMgr, outStream, nullptr, CGFT_AssemblyFile))
+      return "";
+    passMgr.run(*module);
+  }
+  return isa;
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Test that a target machine is reused by a later LgcContext for the same GPU instead of being created again.
+TEST(LgcContextTests, TargetMachineReused) {
+  LgcContext::initialize();
+
+  LLVMContext context;
+  TargetMachine *targetMachine = nullptr;
+  {
+    std::unique_ptr<LgcContext> lgcContext(LgcContext::Create(context, TestGpuName, 0));
+    ASSERT_NE(lgcContext, nullptr);
+    targetMachine = lgcContext->getTargetMachine();
+  }
+
+  std::unique_ptr<LgcContext> lgcContext(LgcContext::Create(context, TestGpuName, 0));
+  ASSERT_NE(lgcContext, nullptr);
+  EXPECT_EQ(lgcContext->getTargetMachine(), targetMachine);
+
+  // A concurrently live LgcContext must get its own target machine.
+  std::unique_ptr<LgcContext> otherLgcContext(LgcContext::Create(context, TestGpuName, 0));
+  ASSERT_NE(otherLgcContext, nullptr);
+  EXPECT_NE(otherLgcContext->getTargetMachine(), lgcContext->getTargetMachine());
+}
+
+// =====================================================================================================================
+// Test that compiles on several threads, recycling pooled target machines, all generate the same code.
+TEST(LgcContextTests, ConcurrentCodegenIsIdentical) {
+  LgcContext::initialize();
+
+  const std::string reference = compileTestShader(TestGpuName);
+  ASSERT_FALSE(reference.empty());
+
+  constexpr unsigned ThreadCount = 8;
+  constexpr unsigned CompilesPerThread = 4;
+  std::vector<std::vector<std::string>> results(ThreadCount);
+  std::vector<std::thread> threads;
+  for (unsigned threadIdx = 0; threadIdx != ThreadCount; ++threadIdx) {
+    threads.emplace_back([&results, threadIdx] {
+      for (unsigned compileIdx = 0; compileIdx != CompilesPerThread; ++compileIdx)
+        results[threadIdx].push_back(compileTestShader(TestGpuName));
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (const auto &threadResults : results) {
+    ASSERT_EQ(threadResults.size(), CompilesPerThread);
+    for (const std::string &isa : threadResults)
+      EXPECT_EQ(isa, reference);
+  }
+}
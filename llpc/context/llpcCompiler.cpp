@@ -141,6 +141,17 @@ opt<unsigned> ShaderCacheMode("shader-cache-mode",
                                    "load on-disk cache for read/write, 4 - load on-disk cache for read only"),
                               init(0));
 
+// -shader-cache-compression: compress shader cache entries
+opt<bool> ShaderCacheCompression("shader-cache-compression",
+                                 desc("Compress entries stored in the shader cache (memory and on-disk file)"),
+                                 init(false));
+
+// -shader-cache-decompressed-size: maximum size of decompressed shader cache entries kept for reuse
+opt<unsigned> ShaderCacheDecompressedSize("shader-cache-decompressed-size",
+                                          desc("Maximum total size in KB of decompressed shader cache entries that "
+                                               "are kept for reuse after they are no longer in use"),
+                                          init(1024));
+
 // -cache-full-pipelines: Add full pipelines to the caches that are provided.
 opt<bool> CacheFullPipelines("cache-full-pipelines", desc("Add full pipelines to the caches that are provided."),
                              init(true));
@@ -155,6 +166,12 @@ opt<bool> TrimDebugInfo("trim-debug-info", cl::desc("Trim debug information in S
 // -enable-per-stage-cache: Enable shader cache per shader stage
 opt<bool> EnablePerStageCache("enable-per-stage-cache", cl::desc("Enable shader cache per shader stage"), init(true));
 
+// -hw-stage-shader-cache: Cache each hardware stage of a graphics pipeline on its own (GFX9+)
+opt<bool> HwStageShaderCache("hw-stage-shader-cache",
+                             cl::desc("Cache each hardware stage of a graphics pipeline on its own, instead of only "
+                                      "splitting the fragment shader from the other shader stages (GFX9+)"),
+                             init(false));
+
 // -context-reuse-limit: The maximum number of times a compiler context can be reused.
 opt<int> ContextReuseLimit("context-reuse-limit",
                            cl::desc("The maximum number of times a compiler context can be reused"), init(100));
@@ -372,6 +389,7 @@ Result VKAPI_CALL ICompiler::Create(GfxIpVersion gfxIp, unsigned optionCount, co
     // LLVM command options can't be parsed multiple times
     if (cl::ParseCommandLineOptions(optionCount, options, "AMD LLPC compiler", ignoreErrors ? &nullStream : nullptr)) {
       HaveParsedOptions = true;
+      TimerProfiler::initOptions();
     } else {
       result = Result::ErrorInvalidValue;
     }
@@ -439,6 +457,8 @@ Compiler::Compiler(GfxIpVersion gfxIp, unsigned optionCount, const char *const *
   auxCreateInfo.gfxIp = m_gfxIp;
   auxCreateInfo.hash = m_optionHash;
   auxCreateInfo.executableName = cl::ExecutableName.c_str();
+  auxCreateInfo.compressEntries = cl::ShaderCacheCompression;
+  auxCreateInfo.decompressedCacheSize = static_cast<size_t>(cl::ShaderCacheDecompressedSize) * 1024;
 
   const char *shaderCachePath = cl::ShaderCacheFileDir.c_str();
   if (cl::ShaderCacheFileDir.empty()) {
@@ -582,6 +602,8 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
   } else if (ShaderModuleHelper::isLlvmBitcode(&shaderInfo->shaderBin)) {
     moduleDataEx.common.binType = BinaryType::LlvmBc;
     moduleDataEx.common.binCode = shaderInfo->shaderBin;
+    moduleDataEx.common.usage.inputLocationMask = UINT64_MAX;
+    moduleDataEx.common.usage.outputLocationMask = UINT64_MAX;
   } else
     result = Result::ErrorInvalidShader;
 
@@ -1173,6 +1195,9 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
       modulesToLink.push_back(modules[shaderIndex]);
     }
 
+    for (Module *module : modulesToLink)
+      timerProfiler.recordModule(*module);
+
     // Link the shader modules into a single pipeline module.
     pipelineModule.reset(pipeline->irLink(modulesToLink, context->getPipelineContext()->isUnlinked()
                                                              ? PipelineLink::Unlinked
@@ -1256,42 +1281,76 @@ unsigned GraphicsShaderCacheChecker::check(const Module *module, const unsigned
                                            ArrayRef<ArrayRef<uint8_t>> stageHashes,
                                            llvm::MutableArrayRef<CacheAccessInfo> stageCacheAccesses) {
   // Check per stage shader cache
-  MetroHash::Hash fragmentHash = {};
-  MetroHash::Hash nonFragmentHash = {};
-  Compiler::buildShaderCacheHash(m_context, stageMask, stageHashes, &fragmentHash, &nonFragmentHash);
+  buildCacheGroups(stageMask);
   unsigned stagesLeftToCompile = stageMask;
 
-  if (stageMask & getLgcShaderStageMask(ShaderStageFragment)) {
-    m_fragmentCacheAccessor.emplace(m_context, fragmentHash, m_compiler->getInternalCaches());
-    if (m_fragmentCacheAccessor->isInCache()) {
-      // Remove fragment shader stages.
-      stagesLeftToCompile &= ~getLgcShaderStageMask(ShaderStageFragment);
-      stageCacheAccesses[ShaderStageFragment] =
-          m_fragmentCacheAccessor->hitInternalCache() ? CacheAccessInfo::InternalCacheHit : CacheAccessInfo::CacheHit;
-    } else {
-      stageCacheAccesses[ShaderStageFragment] = CacheAccessInfo::CacheMiss;
-    }
-  }
+  for (CacheGroup &group : m_cacheGroups) {
+    MetroHash::Hash groupHash = {};
+    Compiler::buildShaderCacheHash(m_context, stageMask, stageHashes, group.stageMask, &groupHash);
 
-  if (stageMask & ~getLgcShaderStageMask(ShaderStageFragment)) {
     auto accessInfo = CacheAccessInfo::CacheNotChecked;
-    m_nonFragmentCacheAccessor.emplace(m_context, nonFragmentHash, m_compiler->getInternalCaches());
-    if (m_nonFragmentCacheAccessor->isInCache()) {
-      // Remove non-fragment shader stages.
-      stagesLeftToCompile &= getLgcShaderStageMask(ShaderStageFragment);
-      accessInfo = m_nonFragmentCacheAccessor->hitInternalCache() ? CacheAccessInfo::InternalCacheHit
-                                                                  : CacheAccessInfo::CacheHit;
+    group.accessor.emplace(m_context, groupHash, m_compiler->getInternalCaches());
+    if (group.accessor->isInCache()) {
+      // Remove the shader stages of this part.
+      stagesLeftToCompile &= ~group.stageMask;
+      accessInfo =
+          group.accessor->hitInternalCache() ? CacheAccessInfo::InternalCacheHit : CacheAccessInfo::CacheHit;
     } else {
       accessInfo = CacheAccessInfo::CacheMiss;
     }
 
     for (ShaderStage stage : gfxShaderStages())
-      if (stage != ShaderStageFragment && (getLgcShaderStageMask(stage) & stageMask))
+      if (getLgcShaderStageMask(stage) & group.stageMask)
         stageCacheAccesses[stage] = accessInfo;
   }
   return stagesLeftToCompile;
 }
 
+// =====================================================================================================================
+// Split the shader stages of a graphics pipeline into the parts that are cached on their own.
+//
+// Without -hw-stage-shader-cache, or before GFX9, the fragment shader is cached apart from the other shader stages.
+// Otherwise each hardware stage is cached on its own: GFX9+ merges the vertex and tessellation control shaders into
+// LS-HS, and the remaining pre-rasterization shader stages into ES-GS (or the NGG primitive shader) plus the copy
+// shader VS, so those are the parts we can take from different pipelines.
+//
+// @param stageMask : Shader stage mask (NOTE: This is a LGC shader stage mask passed by middle-end)
+void GraphicsShaderCacheChecker::buildCacheGroups(unsigned stageMask) {
+  const unsigned fragmentStageMask = getLgcShaderStageMask(ShaderStageFragment);
+  auto hwStageBit = [](Util::Abi::HardwareStage hwStage) { return 1U << static_cast<unsigned>(hwStage); };
+
+  m_cacheGroups.clear();
+  m_hwStageGranular = cl::HwStageShaderCache && m_context->getGfxIpVersion().major >= 9;
+  if (!m_hwStageGranular) {
+    if (stageMask & ~fragmentStageMask)
+      m_cacheGroups.push_back({"Non fragment", stageMask & ~fragmentStageMask, 0, None});
+    if (stageMask & fragmentStageMask)
+      m_cacheGroups.push_back({"Fragment", fragmentStageMask, 0, None});
+    return;
+  }
+
+  unsigned preRasterStageMask = stageMask & ~fragmentStageMask;
+  if (stageMask & getLgcShaderStageMask(ShaderStageTessControl)) {
+    const unsigned lsHsStageMask =
+        preRasterStageMask & (getLgcShaderStageMask(ShaderStageVertex) | getLgcShaderStageMask(ShaderStageTessControl));
+    m_cacheGroups.push_back({"LS-HS", lsHsStageMask, hwStageBit(Util::Abi::HardwareStage::Hs), None});
+    preRasterStageMask &= ~lsHsStageMask;
+  }
+  if (preRasterStageMask) {
+    m_cacheGroups.push_back({"ES-GS/VS", preRasterStageMask,
+                             hwStageBit(Util::Abi::HardwareStage::Gs) | hwStageBit(Util::Abi::HardwareStage::Vs),
+                             None});
+  }
+  if (stageMask & fragmentStageMask)
+    m_cacheGroups.push_back({"Fragment", fragmentStageMask, hwStageBit(Util::Abi::HardwareStage::Ps), None});
+
+  // GFX9+ never uses LS and ES, and uses HS only with tessellation. A part taken from the cache may come from a
+  // pipeline that has hardware stages this one doesn't have, so those are removed when the parts are merged.
+  m_unusedHwStageMask = hwStageBit(Util::Abi::HardwareStage::Ls) | hwStageBit(Util::Abi::HardwareStage::Es);
+  if ((stageMask & getLgcShaderStageMask(ShaderStageTessControl)) == 0)
+    m_unusedHwStageMask |= hwStageBit(Util::Abi::HardwareStage::Hs);
+}
+
 // =====================================================================================================================
 // Update root level descriptor offset for graphics pipeline.
 //
@@ -1312,52 +1371,42 @@ void GraphicsShaderCacheChecker::updateRootUserDateOffset(ElfPackage *pipelineEl
 // @param outputPipelineElf : ELF output of compile, updated to merge ELF from shader cache
 void GraphicsShaderCacheChecker::updateAndMerge(Result result, ElfPackage *outputPipelineElf) {
   // Update the shader cache if required, with the compiled pipeline or with a failure state.
-  bool needToMergeElf = false;
   BinaryData pipelineElf = {};
   pipelineElf.codeSize = outputPipelineElf->size();
   pipelineElf.pCode = outputPipelineElf->data();
-  if (m_nonFragmentCacheAccessor) {
-    if (!m_nonFragmentCacheAccessor->isInCache()) {
-      m_nonFragmentCacheAccessor->setElfInCache(pipelineElf);
-      LLPC_OUTS("Non fragment shader cache miss.\n");
+  SmallVector<bool, 3> groupHits;
+  for (CacheGroup &group : m_cacheGroups) {
+    groupHits.push_back(group.accessor->isInCache());
+    if (!groupHits.back()) {
+      group.accessor->setElfInCache(pipelineElf);
+      LLPC_OUTS(group.name << " shader cache miss.\n");
     } else {
-      needToMergeElf = true;
-      LLPC_OUTS("Non fragment shader cache hit.\n");
+      LLPC_OUTS(group.name << " shader cache hit.\n");
     }
   }
 
-  if (m_fragmentCacheAccessor) {
-    if (!m_fragmentCacheAccessor->isInCache()) {
-      m_fragmentCacheAccessor->setElfInCache(pipelineElf);
-      LLPC_OUTS("Fragment shader cache miss.\n");
-    } else {
-      needToMergeElf = true;
-      LLPC_OUTS("Fragment shader cache hit.\n");
-    }
-  }
+  // Now merge ELFs if any part is from the cache. Nothing needs to be merged if we just compiled the full pipeline,
+  // as everything is already contained in the single incoming ELF in this case.
+  if (!is_contained(groupHits, true))
+    return;
 
-  // Now merge ELFs if one or both parts are from the cache. Nothing needs to be merged if we just compiled the full
-  // pipeline, as everything is already contained in the single incoming ELF in this case.
-  if (needToMergeElf) {
-    // Move the compiled ELF out of the way.
-    ElfPackage compiledPipelineElf = std::move(*outputPipelineElf);
-    outputPipelineElf->clear();
+  // Move the compiled ELF out of the way.
+  ElfPackage compiledPipelineElf = std::move(*outputPipelineElf);
+  outputPipelineElf->clear();
 
+  if (!m_hwStageGranular) {
     // Determine where the fragment / non-fragment parts come from (cache or just-compiled).
     BinaryData fragmentElf = {};
-    if (m_fragmentCacheAccessor && m_fragmentCacheAccessor->isInCache())
-      fragmentElf = m_fragmentCacheAccessor->getElfFromCache();
-    else {
-      fragmentElf.pCode = compiledPipelineElf.data();
-      fragmentElf.codeSize = compiledPipelineElf.size();
-    }
-
-    BinaryData nonFragmentElf = {};
-    if ((m_nonFragmentCacheAccessor && m_nonFragmentCacheAccessor->isInCache()))
-      nonFragmentElf = m_nonFragmentCacheAccessor->getElfFromCache();
-    else {
-      nonFragmentElf.pCode = compiledPipelineElf.data();
-      nonFragmentElf.codeSize = compiledPipelineElf.size();
+    fragmentElf.pCode = compiledPipelineElf.data();
+    fragmentElf.codeSize = compiledPipelineElf.size();
+    BinaryData nonFragmentElf = fragmentElf;
+    for (unsigned groupIdx = 0; groupIdx != m_cacheGroups.size(); ++groupIdx) {
+      if (!groupHits[groupIdx])
+        continue;
+      if (m_cacheGroups[groupIdx].stageMask == getLgcShaderStageMask(ShaderStageFragment))
+        fragmentElf = m_cacheGroups[groupIdx].accessor->getElfFromCache();
+      else
+        nonFragmentElf = m_cacheGroups[groupIdx].accessor->getElfFromCache();
     }
 
     // Merge and store the result in pPipelineElf
@@ -1366,7 +1415,46 @@ void GraphicsShaderCacheChecker::updateAndMerge(Result result, ElfPackage *outpu
     assert(result == Result::Success);
     (void(result)); // unused
     writer.mergeElfBinary(m_context, &fragmentElf, outputPipelineElf);
+    return;
+  }
+
+  // Merge the hardware stages of each part from the cache into the compiled ELF, one part after another. If every
+  // part is from the cache, the ELF of the first part is the one to merge into. Each merge also removes the hardware
+  // stages this pipeline doesn't have. (A single part is still merged into its own ELF, to remove those.)
+  BinaryData baseElf = {};
+  baseElf.pCode = compiledPipelineElf.data();
+  baseElf.codeSize = compiledPipelineElf.size();
+  unsigned firstGroupToMerge = 0;
+  if (!is_contained(groupHits, false)) {
+    baseElf = m_cacheGroups.front().accessor->getElfFromCache();
+    firstGroupToMerge = m_cacheGroups.size() > 1 ? 1 : 0;
   }
+
+  for (unsigned groupIdx = firstGroupToMerge; groupIdx != m_cacheGroups.size(); ++groupIdx) {
+    if (!groupHits[groupIdx])
+      continue;
+    const CacheGroup &group = m_cacheGroups[groupIdx];
+    unsigned apiStageMask = 0;
+    for (ShaderStage stage : gfxShaderStages()) {
+      if (getLgcShaderStageMask(stage) & group.stageMask)
+        apiStageMask |= shaderStageToMask(stage);
+    }
+
+    ElfWriter<Elf64> writer(m_context->getGfxIpVersion());
+    auto result = writer.ReadFromBuffer(baseElf.pCode, baseElf.codeSize);
+    assert(result == Result::Success);
+    (void(result)); // unused
+    BinaryData groupElf = group.accessor->getElfFromCache();
+    writer.mergeHwStageElf(m_context, &groupElf, group.hwStageMask, apiStageMask, m_unusedHwStageMask,
+                           outputPipelineElf);
+
+    // The merged ELF is the one to merge the next part into.
+    compiledPipelineElf = std::move(*outputPipelineElf);
+    outputPipelineElf->clear();
+    baseElf.pCode = compiledPipelineElf.data();
+    baseElf.codeSize = compiledPipelineElf.size();
+  }
+  *outputPipelineElf = std::move(compiledPipelineElf);
 }
 
 // =====================================================================================================================
@@ -1424,6 +1512,18 @@ Result Compiler::buildGraphicsPipelineInternal(GraphicsContext *graphicsContext,
   return result;
 }
 
+// =====================================================================================================================
+// Returns true if the output of a graphics pipeline build came, entirely or in part, from a cache.
+//
+// @param pipelineOut : Output of building the graphics pipeline
+static bool usedCachedElf(const GraphicsPipelineBuildOut *pipelineOut) {
+  auto isHit = [](CacheAccessInfo access) {
+    return access == CacheAccessInfo::CacheHit || access == CacheAccessInfo::InternalCacheHit;
+  };
+  return isHit(pipelineOut->pipelineCacheAccess) ||
+         std::any_of(std::begin(pipelineOut->stageCacheAccesses), std::end(pipelineOut->stageCacheAccesses), isHit);
+}
+
 // =====================================================================================================================
 // Build graphics pipeline from the specified info.
 //
@@ -1443,7 +1543,10 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
     &pipelineInfo->fs,
   };
   // clang-format on
-  const bool relocatableElfRequested = pipelineInfo->options.enableRelocatableShaderElf || cl::UseRelocatableShaderElf;
+  // Early compile builds each stage as a relocatable shader ELF, which depends only on the state of its own stage and
+  // goes into the shader cache. A later build of a pipeline using the same stages then just links the cached ELFs.
+  const bool relocatableElfRequested = pipelineInfo->options.enableRelocatableShaderElf ||
+                                       cl::UseRelocatableShaderElf || pipelineInfo->enableEarlyCompile;
   const bool buildUsingRelocatableElf =
       relocatableElfRequested && canUseRelocatableGraphicsShaderElf(shaderInfo, pipelineInfo);
 
@@ -1515,6 +1618,19 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
     }
   }
 
+  // Register-only pipeline state is not part of the cache hash, so an ELF (or shader stage) taken from a cache may
+  // have been built for a pipeline that differs from this one in such state. Patch the affected registers.
+  if (result == Result::Success && usedCachedElf(pipelineOut)) {
+    ElfWriter<Elf64> writer(m_gfxIp);
+    result = writer.ReadFromBuffer(elfBin.pCode, elfBin.codeSize);
+    if (result == Result::Success) {
+      writer.updateRegisterOnlyState(pipelineInfo, MetroHash::compact64(&pipelineHash), &candidateElf);
+      elfBin.codeSize = candidateElf.size();
+      elfBin.pCode = candidateElf.data();
+      LLPC_OUTS("Patched register-only state of cached graphics pipeline.\n");
+    }
+  }
+
   if (result == Result::Success) {
     void *allocBuf = nullptr;
     if (pipelineInfo->pfnOutputAlloc) {
@@ -1768,6 +1884,8 @@ Result Compiler::CreateShaderCache(const ShaderCacheCreateInfo *pCreateInfo, ISh
   auxCreateInfo.shaderCacheMode = ShaderCacheMode::ShaderCacheEnableRuntime;
   auxCreateInfo.gfxIp = m_gfxIp;
   auxCreateInfo.hash = m_optionHash;
+  auxCreateInfo.compressEntries = cl::ShaderCacheCompression;
+  auxCreateInfo.decompressedCacheSize = static_cast<size_t>(cl::ShaderCacheDecompressedSize) * 1024;
 
   ShaderCache *shaderCache = new ShaderCache();
 
@@ -1893,14 +2011,31 @@ void Compiler::releaseContext(Context *context) const {
 // @param [out] nonFragmentHash : Hash code of all non-fragment shader
 void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayRef<ArrayRef<uint8_t>> stageHashes,
                                     MetroHash::Hash *fragmentHash, MetroHash::Hash *nonFragmentHash) {
-  MetroHash64 fragmentHasher;
-  MetroHash64 nonFragmentHasher;
+  const unsigned fragmentStageMask = getLgcShaderStageMask(ShaderStageFragment);
+  if (stageMask & fragmentStageMask)
+    buildShaderCacheHash(context, stageMask, stageHashes, fragmentStageMask, fragmentHash);
+  if (stageMask & ~fragmentStageMask)
+    buildShaderCacheHash(context, stageMask, stageHashes, stageMask & ~fragmentStageMask, nonFragmentHash);
+}
+
+// =====================================================================================================================
+// Builds hash code from input context for the cache of a part of the pipeline
+//
+// @param context : Acquired context
+// @param stageMask : Shader stage mask (NOTE: This is a LGC shader stage mask passed by middle-end)
+// @param stageHashes : Per-stage hash of in/out usage
+// @param groupStageMask : Mask of the shader stages in the part (NOTE: This is a LGC shader stage mask)
+// @param [out] groupHash : Hash code of the part
+void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayRef<ArrayRef<uint8_t>> stageHashes,
+                                    unsigned groupStageMask, MetroHash::Hash *groupHash) {
+  MetroHash64 groupHasher;
   auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
   auto pipelineOptions = context->getPipelineContext()->getPipelineOptions();
 
   // Build hash per shader stage
+  groupStageMask &= stageMask;
   for (ShaderStage stage : gfxShaderStages()) {
-    if ((stageMask & getLgcShaderStageMask(stage)) == 0)
+    if ((groupStageMask & getLgcShaderStageMask(stage)) == 0)
       continue;
 
     auto shaderInfo = context->getPipelineShaderInfo(stage);
@@ -1915,41 +2050,40 @@ void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayR
     // Update input/output usage (provided by middle-end caller of this callback).
     hasher.Update(stageHashes[getLgcShaderStage(stage)].data(), stageHashes[getLgcShaderStage(stage)].size());
 
-    // Update vertex input state
-    if (stage == ShaderStageVertex)
-      PipelineDumper::updateHashForVertexInputState(pipelineInfo->pVertexInput, pipelineInfo->dynamicVertexStride,
-                                                    &hasher);
+    // Update vertex input state. The uber fetch shader reads it at run time, so it is left out of the hash.
+    if (stage == ShaderStageVertex) {
+      hasher.Update(pipelineInfo->enableUberFetchShader);
+      if (!pipelineInfo->enableUberFetchShader)
+        PipelineDumper::updateHashForVertexInputState(pipelineInfo->pVertexInput, pipelineInfo->dynamicVertexStride,
+                                                      PipelineDumper::getUsedLocationMask(shaderInfo, true), &hasher);
+    }
 
     MetroHash::Hash hash = {};
     hasher.Finalize(hash.bytes);
 
-    // Add per stage hash code to fragmentHasher or nonFragmentHasher per shader stage
+    // Add per stage hash code to groupHasher
     auto shaderHashCode = MetroHash::compact64(&hash);
-    if (stage == ShaderStageFragment)
-      fragmentHasher.Update(shaderHashCode);
-    else
-      nonFragmentHasher.Update(shaderHashCode);
+    groupHasher.Update(shaderHashCode);
   }
 
   // Add additional pipeline state to final hasher
-  if (stageMask & getLgcShaderStageMask(ShaderStageFragment)) {
+  if (groupStageMask & getLgcShaderStageMask(ShaderStageFragment)) {
     // Add pipeline options to fragment hash
-    fragmentHasher.Update(pipelineOptions->includeDisassembly);
-    fragmentHasher.Update(pipelineOptions->scalarBlockLayout);
-    fragmentHasher.Update(pipelineOptions->reconfigWorkgroupLayout);
-    fragmentHasher.Update(pipelineOptions->includeIr);
-    fragmentHasher.Update(pipelineOptions->robustBufferAccess);
-    fragmentHasher.Update(pipelineOptions->extendedRobustness.robustBufferAccess);
-    fragmentHasher.Update(pipelineOptions->extendedRobustness.robustImageAccess);
-    fragmentHasher.Update(pipelineOptions->extendedRobustness.nullDescriptor);
-    PipelineDumper::updateHashForFragmentState(pipelineInfo, &fragmentHasher, false);
-    fragmentHasher.Finalize(fragmentHash->bytes);
-  }
-
-  if (stageMask & ~getLgcShaderStageMask(ShaderStageFragment)) {
-    PipelineDumper::updateHashForNonFragmentState(pipelineInfo, true, &nonFragmentHasher, false);
-    nonFragmentHasher.Finalize(nonFragmentHash->bytes);
+    groupHasher.Update(pipelineOptions->includeDisassembly);
+    groupHasher.Update(pipelineOptions->scalarBlockLayout);
+    groupHasher.Update(pipelineOptions->reconfigWorkgroupLayout);
+    groupHasher.Update(pipelineOptions->includeIr);
+    groupHasher.Update(pipelineOptions->robustBufferAccess);
+    groupHasher.Update(pipelineOptions->extendedRobustness.robustBufferAccess);
+    groupHasher.Update(pipelineOptions->extendedRobustness.robustImageAccess);
+    groupHasher.Update(pipelineOptions->extendedRobustness.nullDescriptor);
+    PipelineDumper::updateHashForFragmentState(pipelineInfo, true, &groupHasher, false);
   }
+
+  if (groupStageMask & ~getLgcShaderStageMask(ShaderStageFragment))
+    PipelineDumper::updateHashForNonFragmentState(pipelineInfo, true, &groupHasher, false);
+
+  groupHasher.Finalize(groupHash->bytes);
 }
 
 // =====================================================================================================================
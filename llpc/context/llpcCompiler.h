@@ -37,6 +37,7 @@
 #include "vkgcElfReader.h"
 #include "vkgcMetroHash.h"
 #include "lgc/CommonDefs.h"
+#include "llvm/ADT/SmallVector.h"
 
 namespace llvm {
 
@@ -77,15 +78,23 @@ public:
   void updateRootUserDateOffset(ElfPackage *pipelineElf);
 
 private:
-  Compiler *m_compiler;
-  Context *m_context;
-  llvm::Optional<CacheAccessor> m_nonFragmentCacheAccessor;
-  llvm::Optional<CacheAccessor> m_fragmentCacheAccessor;
+  // A part of the pipeline that is cached on its own.
+  struct CacheGroup {
+    const char *name;                       // Name of the part, for verbose output
+    unsigned stageMask;                     // Mask of the LGC shader stages in the part
+    unsigned hwStageMask;                   // Mask of the hardware stages (Util::Abi::HardwareStage) to merge
+                                            // from the ELF of the part
+    llvm::Optional<CacheAccessor> accessor; // Accessor of the shader cache entry of the part
+  };
 
-  // New ICache
-  Vkgc::EntryHandle m_nonFragmentEntry;
+  void buildCacheGroups(unsigned stageMask);
 
-  Vkgc::EntryHandle m_fragmentEntry;
+  Compiler *m_compiler;
+  Context *m_context;
+  llvm::SmallVector<CacheGroup, 3> m_cacheGroups; // Parts of the pipeline that are cached on their own
+  bool m_hwStageGranular = false;                 // Whether the parts are hardware stages (-hw-stage-shader-cache)
+  unsigned m_unusedHwStageMask = 0;               // Mask of the hardware stages the pipeline doesn't have, to remove
+                                                  // from the merged ELF
 };
 
 // =====================================================================================================================
@@ -140,6 +149,10 @@ public:
                                    llvm::ArrayRef<llvm::ArrayRef<uint8_t>> stageHashes, MetroHash::Hash *fragmentHash,
                                    MetroHash::Hash *nonFragmentHash);
 
+  static void buildShaderCacheHash(Context *context, unsigned stageMask,
+                                   llvm::ArrayRef<llvm::ArrayRef<uint8_t>> stageHashes, unsigned groupStageMask,
+                                   MetroHash::Hash *groupHash);
+
   CachePair getInternalCaches() { return {m_cache, m_shaderCache.get()}; }
 
 private:
@@ -221,8 +221,9 @@ void PipelineContext::setPipelineState(Pipeline *pipeline, bool unlinked) const
   }
 
   if (isGraphics()) {
-    if (!unlinked || DisableFetchShader) {
-      // Set vertex input descriptions to the middle-end.
+    auto pipelineInfo = static_cast<const GraphicsPipelineBuildInfo *>(getPipelineBuildInfo());
+    if ((!unlinked || DisableFetchShader) && !pipelineInfo->enableUberFetchShader) {
+      // Set vertex input descriptions to the middle-end. The uber fetch shader reads them at run time instead.
       setVertexInputDescriptions(pipeline);
     }
 
@@ -317,6 +318,12 @@ void PipelineContext::setOptionsInPipeline(Pipeline *pipeline) const {
   options.disableImageResourceCheck = getPipelineOptions()->disableImageResourceCheck;
   options.enableInterpModePatch = getPipelineOptions()->enableInterpModePatch;
   options.pageMigrationEnabled = getPipelineOptions()->pageMigrationEnabled;
+  if (isGraphics()) {
+    static_assert(UberFetchShaderTableSet == Vkgc::InternalDescriptorSetId, "Mismatch");
+    static_assert(UberFetchShaderTableBinding == Vkgc::FetchShaderInternalBufferBinding, "Mismatch");
+    options.enableUberFetchShader =
+        static_cast<const GraphicsPipelineBuildInfo *>(getPipelineBuildInfo())->enableUberFetchShader;
+  }
 
   // Driver report full subgroup lanes for compute shader, here we just set fullSubgroups as default options
   options.fullSubgroups = true;
@@ -677,6 +684,7 @@ void PipelineContext::setGraphicsStateInPipeline(Pipeline *pipeline) const {
 
   const auto &inputDsState = static_cast<const GraphicsPipelineBuildInfo *>(getPipelineBuildInfo())->dsState;
   DepthStencilState depthStencilState = {};
+  static_assert(static_cast<unsigned>(VK_COMPARE_OP_ALWAYS) == CompareFuncAlways, "Mismatch");
   if (inputDsState.depthTestEnable) {
     depthStencilState.depthTestEnable = inputDsState.depthTestEnable;
     depthStencilState.depthCompareOp = inputDsState.depthCompareOp;
@@ -686,6 +694,7 @@ void PipelineContext::setGraphicsStateInPipeline(Pipeline *pipeline) const {
     depthStencilState.stencilCompareOpFront = inputDsState.front.compareOp;
     depthStencilState.stencilCompareOpBack = inputDsState.back.compareOp;
   }
+  depthStencilState.depthBoundsTestEnable = inputDsState.depthBoundsTestEnable;
 
   pipeline->setDepthStencilState(depthStencilState);
 }
@@ -36,7 +36,9 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FileSystem.h"
+#include <algorithm>
 #include <string.h>
+#include <vector>
 
 #define DEBUG_TYPE "llpc-shader-cache"
 
@@ -45,6 +47,11 @@ using namespace llvm;
 static cl::opt<std::string> ShaderCacheFilename("shader-cache-filename", cl::desc("Filename for the shader cache"),
                                                 cl::value_desc("filename"), cl::init(""));
 
+static cl::opt<unsigned> ShaderCacheHotSetSize("shader-cache-hot-set-size",
+                                               cl::desc("Maximum number of entries recorded in the hot-set manifest of "
+                                                        "an on-disk shader cache, 0 disables the manifest"),
+                                               cl::init(256));
+
 namespace Llpc {
 
 #if !_WIN32
@@ -55,6 +62,8 @@ static const char CacheFileSubPath[] = "\\AMD\\LlpcCache\\";
 
 static const char ClientStr[] = "LLPC";
 
+static const char HotSetFileSuffix[] = ".hotset";
+
 static constexpr uint64_t CrcWidth = sizeof(uint64_t) * 8;
 static constexpr uint64_t CrcInitialValue = 0xFFFFFFFFFFFFFFFF;
 
@@ -112,10 +121,158 @@ static const uint64_t CrcLookup[256] = {
     0xF989DB4A98BD5062, 0x541A097F0C7465CB, 0x4FC6939CCB9986C6, 0xE25541A95F50B36F, 0xB972E5C276C2D83D,
     0x14E137F7E20BED94};
 
+// Parameters of the LZ77-style codec used to compress cache entries. The encoded stream is a sequence of
+// (token, literals, match) groups: the token holds the literal run length in its high nibble and the match length
+// (minus MinMatch) in its low nibble, with 15 in either nibble meaning the length continues in following bytes. A
+// match is a 16-bit little-endian back-reference offset. The last group carries literals only.
+static constexpr size_t MinMatch = 4;
+static constexpr size_t MaxOffset = 0xFFFF;
+static constexpr unsigned HashTableBits = 12;
+
+// =====================================================================================================================
+// Returns the worst-case size of compressed data for the given input size.
+//
+// @param size : Input size in bytes
+static size_t getMaxCompressedSize(size_t size) {
+  return size + size / 255 + 16;
+}
+
+// =====================================================================================================================
+// Writes a length that did not fit into a token nibble.
+//
+// @param length : Remaining length beyond the nibble's value of 15
+// @param [in/out] out : Output pointer, advanced past the written bytes
+static void writeExtendedLength(size_t length, uint8_t *&out) {
+  for (; length >= 255; length -= 255)
+    *out++ = 255;
+  *out++ = static_cast<uint8_t>(length);
+}
+
+// =====================================================================================================================
+// Compresses a block of data. Returns the compressed size; the output buffer must hold at least
+// getMaxCompressedSize(srcSize) bytes.
+//
+// @param src : Data to compress
+// @param srcSize : Size of the data in bytes
+// @param [out] dst : Buffer that receives the compressed data
+static size_t compressBlob(const uint8_t *src, size_t srcSize, uint8_t *dst) {
+  uint32_t hashTable[1 << HashTableBits];
+  memset(hashTable, 0xFF, sizeof(hashTable));
+
+  uint8_t *out = dst;
+  size_t literalStart = 0;
+  size_t pos = 0;
+
+  auto emitGroup = [&](size_t literalLength, size_t offset, size_t matchLength) {
+    uint8_t *token = out++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+    if (literalLength >= 15)
+      writeExtendedLength(literalLength - 15, out);
+    memcpy(out, src + literalStart, literalLength);
+    out += literalLength;
+
+    if (matchLength != 0) {
+      *out++ = static_cast<uint8_t>(offset);
+      *out++ = static_cast<uint8_t>(offset >> 8);
+      const size_t encodedMatch = matchLength - MinMatch;
+      *token |= static_cast<uint8_t>(std::min<size_t>(encodedMatch, 15));
+      if (encodedMatch >= 15)
+        writeExtendedLength(encodedMatch - 15, out);
+    }
+  };
+
+  while (pos + MinMatch <= srcSize) {
+    uint32_t sequence;
+    memcpy(&sequence, src + pos, sizeof(sequence));
+    const unsigned slot = (sequence * 2654435761U) >> (32 - HashTableBits);
+    const size_t candidate = hashTable[slot];
+    hashTable[slot] = static_cast<uint32_t>(pos);
+
+    if (candidate == UINT32_MAX || pos - candidate > MaxOffset || memcmp(src + candidate, src + pos, MinMatch) != 0) {
+      ++pos;
+      continue;
+    }
+
+    size_t matchLength = MinMatch;
+    while (pos + matchLength < srcSize && src[candidate + matchLength] == src[pos + matchLength])
+      ++matchLength;
+
+    emitGroup(pos - literalStart, pos - candidate, matchLength);
+    pos += matchLength;
+    literalStart = pos;
+  }
+
+  emitGroup(srcSize - literalStart, 0, 0);
+  return out - dst;
+}
+
+// =====================================================================================================================
+// Decompresses a block of data produced by compressBlob. Returns false if the compressed data is malformed or does not
+// decompress to exactly dstSize bytes.
+//
+// @param src : Compressed data
+// @param srcSize : Size of the compressed data in bytes
+// @param [out] dst : Buffer that receives the decompressed data
+// @param dstSize : Expected size of the decompressed data in bytes
+static bool decompressBlob(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize) {
+  const uint8_t *in = src;
+  const uint8_t *const inEnd = src + srcSize;
+  size_t outPos = 0;
+
+  auto readLength = [&](size_t length, size_t &result) {
+    if (length == 15) {
+      uint8_t next = 255;
+      while (next == 255) {
+        if (in == inEnd)
+          return false;
+        next = *in++;
+        length += next;
+      }
+    }
+    result = length;
+    return true;
+  };
+
+  while (in < inEnd) {
+    const uint8_t token = *in++;
+    size_t literalLength = 0;
+    if (!readLength(token >> 4, literalLength) || literalLength > static_cast<size_t>(inEnd - in) ||
+        literalLength > dstSize - outPos)
+      return false;
+    memcpy(dst + outPos, in, literalLength);
+    in += literalLength;
+    outPos += literalLength;
+
+    // The last group has no match.
+    if (in == inEnd)
+      break;
+
+    if (inEnd - in < 2)
+      return false;
+    const size_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    size_t matchLength = 0;
+    if (!readLength(token & 0xF, matchLength))
+      return false;
+    matchLength += MinMatch;
+    if (offset == 0 || offset > outPos || matchLength > dstSize - outPos)
+      return false;
+
+    // The source and destination ranges may overlap, so copy byte by byte.
+    for (size_t i = 0; i < matchLength; ++i, ++outPos)
+      dst[outPos] = dst[outPos - offset];
+  }
+
+  return outPos == dstSize;
+}
+
 // =====================================================================================================================
 ShaderCache::ShaderCache()
-    : m_onDiskFile(), m_disableCache(true), m_shaderDataEnd(sizeof(ShaderCacheSerializedHeader)), m_totalShaders(0),
-      m_serializedSize(sizeof(ShaderCacheSerializedHeader)), m_getValueFunc(nullptr), m_storeValueFunc(nullptr) {
+    : m_onDiskFile(), m_disableCache(true), m_compressEntries(false), m_writeHotSet(false),
+      m_shaderDataEnd(sizeof(ShaderCacheSerializedHeader)), m_totalShaders(0),
+      m_serializedSize(sizeof(ShaderCacheSerializedHeader)), m_getValueFunc(nullptr), m_storeValueFunc(nullptr),
+      m_lookupCounter(0), m_prewarmCancel(false), m_prewarmDone(0), m_prewarmTotal(0), m_decompressedCacheSize(0),
+      m_decompressedSize(0) {
   memset(m_fileFullPath, 0, sizeof(m_fileFullPath));
   memset(&m_gfxIp, 0, sizeof(m_gfxIp));
 }
@@ -128,6 +285,15 @@ ShaderCache::~ShaderCache() {
 // =====================================================================================================================
 // Destruction, does clean-up work.
 void ShaderCache::Destroy() {
+  // The prewarm thread works on the entries released below, so stop it first.
+  m_prewarmCancel = true;
+  waitForPrewarm();
+
+  if (m_writeHotSet) {
+    writeHotSetFile();
+    m_writeHotSet = false;
+  }
+
   if (m_onDiskFile.isOpen())
     m_onDiskFile.close();
   resetRuntimeCache();
@@ -136,9 +302,13 @@ void ShaderCache::Destroy() {
 // =====================================================================================================================
 // Resets the runtime shader cache to an empty state. Releases all allocator memory and decommits it back to the OS.
 void ShaderCache::resetRuntimeCache() {
-  for (auto indexMap : m_shaderIndexMap)
+  for (auto indexMap : m_shaderIndexMap) {
+    delete[] static_cast<uint8_t *>(indexMap.second->decompressedBlob);
     delete indexMap.second;
+  }
   m_shaderIndexMap.clear();
+  m_decompressedList.clear();
+  m_decompressedSize = 0;
 
   for (auto allocIt : m_allocationList)
     delete[] allocIt.first;
@@ -230,7 +400,7 @@ Result ShaderCache::Merge(unsigned srcCacheCount, const IShaderCache **ppSrcCach
         void *mem = getCacheSpace(it.second->header.size);
         memcpy(mem, it.second->dataBlob, it.second->header.size);
 
-        index = new ShaderIndex;
+        index = new ShaderIndex();
         index->dataBlob = mem;
         index->state = ShaderEntryState::Ready;
         index->header = it.second->header;
@@ -262,6 +432,8 @@ Result ShaderCache::init(const ShaderCacheCreateInfo *createInfo, const ShaderCa
     m_storeValueFunc = createInfo->pfnStoreValueFunc;
     m_gfxIp = auxCreateInfo->gfxIp;
     m_hash = auxCreateInfo->hash;
+    m_compressEntries = auxCreateInfo->compressEntries;
+    m_decompressedCacheSize = auxCreateInfo->decompressedCacheSize;
 
     lockCacheMap(false);
 
@@ -309,6 +481,11 @@ Result ShaderCache::init(const ShaderCacheCreateInfo *createInfo, const ShaderCa
       // any memory allocated
       if (loadResult != Result::Success)
         resetRuntimeCache();
+      else
+        loadHotSetFile();
+
+      m_writeHotSet = result == Result::Success && ShaderCacheHotSetSize > 0 &&
+                      auxCreateInfo->shaderCacheMode != ShaderCacheEnableOnDiskReadOnly;
     }
 
     unlockCacheMap(false);
@@ -410,7 +587,7 @@ ShaderEntryState ShaderCache::findShader(MetroHash::Hash hash, bool allocateOnMi
     existed = true;
     index = indexMap->second;
   } else if (allocateOnMiss) {
-    index = new ShaderIndex;
+    index = new ShaderIndex();
     m_shaderIndexMap[hashKey] = index;
   }
 
@@ -493,6 +670,10 @@ ShaderEntryState ShaderCache::findShader(MetroHash::Hash hash, bool allocateOnMi
     if (index->state == ShaderEntryState::Ready) {
       // The shader has been compiled, just verify it has valid data and then return success.
       assert(index->dataBlob && index->header.size != 0);
+      if (existed) {
+        ++index->hitCount;
+        index->lastHit = ++m_lookupCounter;
+      }
     } else if (index->state == ShaderEntryState::New) {
       // The shader entry is new (or previously failed compilation) and we're the first thread to get a
       // crack at it, move it into the Compiling state
@@ -526,9 +707,22 @@ void ShaderCache::insertShader(CacheEntryHandle hEntry, const void *blob, size_t
   Result result = Result::Success;
 
   if (result == Result::Success) {
+    // Compress the shader data if requested. The compressed form is only kept if it is actually smaller.
+    std::vector<uint8_t> compressed;
+    size_t storedSize = shaderSize;
+    index->header.uncompressedSize = 0;
+    if (m_compressEntries && shaderSize > 0) {
+      compressed.resize(getMaxCompressedSize(shaderSize));
+      const size_t compressedSize = compressBlob(static_cast<const uint8_t *>(blob), shaderSize, compressed.data());
+      if (compressedSize < shaderSize) {
+        storedSize = compressedSize;
+        index->header.uncompressedSize = shaderSize;
+      }
+    }
+
     // Allocate space to store the serialized shader and a copy of the header. The header is duplicated in the
     // data to simplify serialize/load.
-    index->header.size = (shaderSize + sizeof(ShaderHeader));
+    index->header.size = (storedSize + sizeof(ShaderHeader));
     index->dataBlob = getCacheSpace(index->header.size);
 
     if (!index->dataBlob)
@@ -540,11 +734,11 @@ void ShaderCache::insertShader(CacheEntryHandle hEntry, const void *blob, size_t
       void *const dataBlob = (header + 1);
 
       // Serialize the shader into an opaque blob of data.
-      memcpy(dataBlob, blob, shaderSize);
+      memcpy(dataBlob, index->header.uncompressedSize != 0 ? compressed.data() : blob, storedSize);
 
       // Compute a CRC for the serialized data (useful for detecting data corruption), and copy the index's
       // header into the data's header.
-      index->header.crc = calculateCrc(static_cast<uint8_t *>(dataBlob), shaderSize);
+      index->header.crc = calculateCrc(static_cast<uint8_t *>(dataBlob), storedSize);
       (*header) = index->header;
 
       if (useExternalCache()) {
@@ -602,13 +796,14 @@ void ShaderCache::resetShader(CacheEntryHandle hEntry) {
 }
 
 // =====================================================================================================================
-// Retrieves the shader from the cache which is identified by the specified entry handle.
+// Retrieves the shader from the cache which is identified by the specified entry handle. The returned data stays valid
+// until the retrieval is released with releaseShader().
 //
 // @param hEntry : Handle of shader cache entry
 // @param [out] ppBlob : Shader data
 // @param [out] size : Size of shader data in bytes
 Result ShaderCache::retrieveShader(CacheEntryHandle hEntry, const void **ppBlob, size_t *size) {
-  const auto *const index = static_cast<ShaderIndex *>(hEntry);
+  auto *const index = static_cast<ShaderIndex *>(hEntry);
 
   assert(m_disableCache == false);
   assert(index);
@@ -616,14 +811,96 @@ Result ShaderCache::retrieveShader(CacheEntryHandle hEntry, const void **ppBlob,
 
   lockCacheMap(true);
 
-  *ppBlob = voidPtrInc(index->dataBlob, sizeof(ShaderHeader));
-  *size = index->header.size - sizeof(ShaderHeader);
+  *ppBlob = getShaderData(index, true);
+  if (!*ppBlob)
+    *size = 0;
+  else if (index->header.uncompressedSize != 0)
+    *size = index->header.uncompressedSize;
+  else
+    *size = index->header.size - sizeof(ShaderHeader);
 
   unlockCacheMap(true);
 
   return *size > 0 ? Result::Success : Result::ErrorUnknown;
 }
 
+// =====================================================================================================================
+// Releases a retrieval of the shader made by retrieveShader(). The decompressed copy of a compressed entry is freed
+// once it is no longer in use and does not fit in the size limit for recently used copies.
+//
+// @param hEntry : Handle of shader cache entry
+void ShaderCache::releaseShader(CacheEntryHandle hEntry) {
+  auto *const index = static_cast<ShaderIndex *>(hEntry);
+  assert(index);
+
+  lockCacheMap(false);
+  if (index->decompressedRefs > 0) {
+    --index->decompressedRefs;
+    trimDecompressedEntries();
+  }
+  unlockCacheMap(false);
+}
+
+// =====================================================================================================================
+// Returns the number of bytes the cache holds in memory: the stored entries plus the decompressed copies.
+size_t ShaderCache::getResidentSize() {
+  lockCacheMap(true);
+  size_t residentSize = m_decompressedSize;
+  for (const auto &allocation : m_allocationList)
+    residentSize += allocation.second;
+  unlockCacheMap(true);
+  return residentSize;
+}
+
+// =====================================================================================================================
+// Returns the shader data of a cache entry, decompressing it if a compressed entry has no decompressed copy. Returns
+// nullptr if the compressed data is damaged. This function assumes that the cache map lock has been taken by the
+// calling function.
+//
+// @param index : Cache entry
+// @param acquire : Whether the decompressed copy is kept until the caller releases it
+const void *ShaderCache::getShaderData(ShaderIndex *index, bool acquire) {
+  if (index->header.uncompressedSize == 0)
+    return voidPtrInc(index->dataBlob, sizeof(ShaderHeader));
+
+  if (index->decompressedBlob) {
+    // Move the entry to the front of the recently used list
+    m_decompressedList.remove(index);
+  } else {
+    auto *const decompressed = new uint8_t[index->header.uncompressedSize];
+    if (!decompressBlob(static_cast<const uint8_t *>(voidPtrInc(index->dataBlob, sizeof(ShaderHeader))),
+                        index->header.size - sizeof(ShaderHeader), decompressed, index->header.uncompressedSize)) {
+      delete[] decompressed;
+      return nullptr;
+    }
+    index->decompressedBlob = decompressed;
+    m_decompressedSize += index->header.uncompressedSize;
+  }
+  m_decompressedList.push_front(index);
+
+  if (acquire)
+    ++index->decompressedRefs;
+  const void *data = index->decompressedBlob;
+  trimDecompressedEntries();
+  return data;
+}
+
+// =====================================================================================================================
+// Frees the least recently used decompressed copies that are not in use, until the copies fit in the size limit. This
+// function assumes that the cache map lock has been taken by the calling function.
+void ShaderCache::trimDecompressedEntries() {
+  auto it = m_decompressedList.end();
+  while (it != m_decompressedList.begin() && m_decompressedSize > m_decompressedCacheSize) {
+    ShaderIndex *index = *--it;
+    if (index->decompressedRefs > 0)
+      continue;
+    delete[] static_cast<uint8_t *>(index->decompressedBlob);
+    index->decompressedBlob = nullptr;
+    m_decompressedSize -= index->header.uncompressedSize;
+    it = m_decompressedList.erase(it);
+  }
+}
+
 // =====================================================================================================================
 // Adds data for a new shader to the on-disk file
 //
@@ -774,7 +1051,7 @@ Result ShaderCache::populateIndexMap(void *dataStart, size_t dataSize) {
       ShaderIndex *index = nullptr;
       auto indexMap = m_shaderIndexMap.find(header->key);
       if (indexMap == m_shaderIndexMap.end()) {
-        index = new ShaderIndex;
+        index = new ShaderIndex();
         index->header = (*header);
         index->dataBlob = header;
         index->state = ShaderEntryState::Ready;
@@ -873,4 +1150,199 @@ bool ShaderCache::isCompatible(const ShaderCacheCreateInfo *createInfo, const Sh
   return isCompatible && m_gfxIp == auxCreateInfo->gfxIp;
 }
 
+// =====================================================================================================================
+// Returns the hit statistics of all ready entries in the cache.
+//
+// @param [out] stats : Hit statistics, one element per entry
+void ShaderCache::getEntryStats(std::vector<ShaderCacheEntryStats> &stats) {
+  lockCacheMap(true);
+  stats.clear();
+  stats.reserve(m_shaderIndexMap.size());
+  for (const auto &keyAndIndex : m_shaderIndexMap) {
+    const ShaderIndex *index = keyAndIndex.second;
+    if (index->state == ShaderEntryState::Ready)
+      stats.push_back({keyAndIndex.first, index->hitCount, index->lastHit});
+  }
+  unlockCacheMap(true);
+}
+
+// =====================================================================================================================
+// Writes a hot-set manifest listing the keys of the most frequently hit entries, hottest first. Entries with the same
+// hit count are ordered by the recency of their last hit. The manifest can be passed to prewarm() in a later process.
+//
+// @param maxEntries : Maximum number of keys in the manifest
+// @param [out] blob : Memory the manifest is written to
+// @param [in/out] size : Size of the memory pointed to by blob. If the value stored in size is zero then no data will
+// be written and instead the size required for the manifest will be returned in size
+Result ShaderCache::exportHotSet(size_t maxEntries, void *blob, size_t *size) {
+  std::vector<ShaderCacheEntryStats> stats;
+  getEntryStats(stats);
+
+  auto end = std::remove_if(stats.begin(), stats.end(),
+                            [](const ShaderCacheEntryStats &entry) { return entry.hitCount == 0; });
+  std::sort(stats.begin(), end, [](const ShaderCacheEntryStats &lhs, const ShaderCacheEntryStats &rhs) {
+    return lhs.hitCount != rhs.hitCount ? lhs.hitCount > rhs.hitCount : lhs.lastHit > rhs.lastHit;
+  });
+  const size_t keyCount = std::min<size_t>(end - stats.begin(), maxEntries);
+  const size_t requiredSize = sizeof(ShaderCacheHotSetHeader) + keyCount * sizeof(uint64_t);
+
+  if (*size == 0) {
+    *size = requiredSize;
+    return Result::Success;
+  }
+  if (!blob || *size < requiredSize)
+    return Result::ErrorInvalidValue;
+
+  ShaderCacheHotSetHeader header = {};
+  header.headerSize = sizeof(ShaderCacheHotSetHeader);
+  header.keyCount = keyCount;
+  getBuildTime(&header.buildId);
+  memcpy(blob, &header, sizeof(header));
+
+  auto *keys = static_cast<uint64_t *>(voidPtrInc(blob, sizeof(header)));
+  for (size_t i = 0; i < keyCount; ++i)
+    keys[i] = stats[i].key;
+
+  *size = requiredSize;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Starts loading the entries listed in a hot-set manifest on a background thread, so that they are ready for use
+// before the first compile requests arrive. Compressed entries are decompressed. Keys that are not in the cache are
+// skipped. The progress can be queried with getPrewarmProgress().
+//
+// @param hotSet : Hot-set manifest written by exportHotSet()
+// @param hotSetSize : Size of the manifest in bytes
+Result ShaderCache::prewarm(const void *hotSet, size_t hotSetSize) {
+  if (m_disableCache)
+    return Result::ErrorUnavailable;
+
+  BuildUniqueId buildId;
+  getBuildTime(&buildId);
+
+  const auto *header = static_cast<const ShaderCacheHotSetHeader *>(hotSet);
+  if (!hotSet || hotSetSize < sizeof(ShaderCacheHotSetHeader) ||
+      header->headerSize != sizeof(ShaderCacheHotSetHeader) ||
+      memcmp(&header->buildId, &buildId, sizeof(buildId)) != 0 ||
+      header->keyCount > (hotSetSize - sizeof(ShaderCacheHotSetHeader)) / sizeof(uint64_t))
+    return Result::ErrorInvalidValue;
+
+  const auto *keys = static_cast<const uint64_t *>(voidPtrInc(hotSet, sizeof(ShaderCacheHotSetHeader)));
+  std::vector<uint64_t> keyList(keys, keys + header->keyCount);
+
+  waitForPrewarm();
+  m_prewarmKeys = keyList;
+  m_prewarmCancel = false;
+  m_prewarmDone = 0;
+  m_prewarmTotal = keyList.size();
+  m_prewarmThread = std::thread(&ShaderCache::prewarmEntries, this, std::move(keyList));
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Body of the prewarm thread. Only the hottest entries whose decompressed copies fit in the size limit are loaded, and
+// they are loaded coldest first, so that the hottest entries end up most recently used and are evicted last.
+//
+// @param keys : Keys of the entries to load, hottest first
+void ShaderCache::prewarmEntries(std::vector<uint64_t> keys) {
+  size_t keyCount = 0;
+  size_t decompressedSize = 0;
+  lockCacheMap(true);
+  for (; keyCount < keys.size(); ++keyCount) {
+    auto indexMap = m_shaderIndexMap.find(keys[keyCount]);
+    if (indexMap == m_shaderIndexMap.end() || indexMap->second->state != ShaderEntryState::Ready)
+      continue;
+    decompressedSize += indexMap->second->header.uncompressedSize;
+    if (decompressedSize > m_decompressedCacheSize)
+      break;
+  }
+  unlockCacheMap(true);
+  m_prewarmDone += keys.size() - keyCount;
+
+  for (size_t i = keyCount; i-- > 0;) {
+    if (m_prewarmCancel)
+      break;
+
+    lockCacheMap(true);
+    auto indexMap = m_shaderIndexMap.find(keys[i]);
+    if (indexMap != m_shaderIndexMap.end() && indexMap->second->state == ShaderEntryState::Ready)
+      (void)getShaderData(indexMap->second, false);
+    unlockCacheMap(true);
+
+    ++m_prewarmDone;
+  }
+}
+
+// =====================================================================================================================
+// Returns the progress of the most recent prewarm.
+//
+// @param [out] done : Number of hot-set entries processed so far
+// @param [out] total : Number of entries in the hot set
+void ShaderCache::getPrewarmProgress(size_t *done, size_t *total) const {
+  *done = m_prewarmDone;
+  *total = m_prewarmTotal;
+}
+
+// =====================================================================================================================
+// Waits for the prewarm thread to finish, if one is running.
+void ShaderCache::waitForPrewarm() {
+  if (m_prewarmThread.joinable())
+    m_prewarmThread.join();
+}
+
+// =====================================================================================================================
+// Reads the hot-set manifest stored next to the on-disk cache file, if there is one, and starts prewarming from it.
+// A missing, stale or damaged manifest only means there is nothing to prewarm.
+void ShaderCache::loadHotSetFile() {
+  const std::string hotSetPath = std::string(m_fileFullPath) + HotSetFileSuffix;
+  if (!File::exists(hotSetPath.c_str()))
+    return;
+
+  std::vector<uint8_t> hotSet(File::getFileSize(hotSetPath.c_str()));
+  File hotSetFile;
+  size_t bytesRead = 0;
+  if (hotSet.empty() || hotSetFile.open(hotSetPath.c_str(), FileAccessRead | FileAccessBinary) != Result::Success ||
+      hotSetFile.read(hotSet.data(), hotSet.size(), &bytesRead) != Result::Success || bytesRead != hotSet.size())
+    return;
+
+  Result result = prewarm(hotSet.data(), hotSet.size());
+  (void)result;
+}
+
+// =====================================================================================================================
+// Writes the hot-set manifest next to the on-disk cache file, so that the next process can prewarm from it. The hit
+// counts only cover this process, so the keys of the manifest this process was prewarmed from are kept after the keys
+// hit here. Nothing is written if both are empty.
+void ShaderCache::writeHotSetFile() {
+  size_t hotSetSize = 0;
+  if (exportHotSet(ShaderCacheHotSetSize, nullptr, &hotSetSize) != Result::Success)
+    return;
+
+  std::vector<uint8_t> hotSet(hotSetSize + m_prewarmKeys.size() * sizeof(uint64_t));
+  if (exportHotSet(ShaderCacheHotSetSize, hotSet.data(), &hotSetSize) != Result::Success)
+    return;
+
+  ShaderCacheHotSetHeader header;
+  memcpy(&header, hotSet.data(), sizeof(header));
+  auto *keys = reinterpret_cast<uint64_t *>(voidPtrInc(hotSet.data(), sizeof(header)));
+  for (uint64_t key : m_prewarmKeys) {
+    if (header.keyCount >= ShaderCacheHotSetSize)
+      break;
+    if (std::find(keys, keys + header.keyCount, key) == keys + header.keyCount)
+      keys[header.keyCount++] = key;
+  }
+  if (header.keyCount == 0)
+    return;
+  memcpy(hotSet.data(), &header, sizeof(header));
+  hotSetSize = sizeof(header) + header.keyCount * sizeof(uint64_t);
+
+  const std::string hotSetPath = std::string(m_fileFullPath) + HotSetFileSuffix;
+  File hotSetFile;
+  if (hotSetFile.open(hotSetPath.c_str(), FileAccessWrite | FileAccessBinary) == Result::Success) {
+    Result result = hotSetFile.write(hotSet.data(), hotSetSize);
+    (void)result;
+  }
+}
+
 } // namespace Llpc
@@ -35,18 +35,22 @@
 #include "llpcUtil.h"
 #include "vkgcMetroHash.h"
 #include "llvm/Support/Mutex.h"
+#include <atomic>
 #include <condition_variable>
 #include <list>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace Llpc {
 
 // Header data that is stored with each shader in the cache.
 struct ShaderHeader {
-  uint64_t key; // Compacted hash key used to identify shaders
-  uint64_t crc; // CRC of the shader cache entry, used to detect data corruption.
-  size_t size;  // Total size of the shader data in the storage file
+  uint64_t key;            // Compacted hash key used to identify shaders
+  uint64_t crc;            // CRC of the shader cache entry, used to detect data corruption.
+  size_t size;             // Total size of the shader data in the storage file
+  size_t uncompressedSize; // Size of the shader data once decompressed, or 0 if it is stored uncompressed
 };
 
 // Enum defining the states a shader cache entry can be in
@@ -72,6 +76,17 @@ struct ShaderIndex {
   ShaderHeader header;             // Shader header data (key, crc, size)
   volatile ShaderEntryState state; // Shader entry state
   void *dataBlob;                  // Serialized data blob representing a cached RelocatableShader object.
+  void *decompressedBlob;          // Decompressed copy of a compressed data blob while in use or recently used
+  unsigned decompressedRefs;       // Number of retrievals of the decompressed copy that are not released yet
+  unsigned hitCount;               // Number of lookups that found this entry in the cache
+  uint64_t lastHit;                // Value of the cache's lookup counter at the most recent hit
+};
+
+// Hit statistics of a single shader cache entry.
+struct ShaderCacheEntryStats {
+  uint64_t key;      // Compacted hash key of the entry
+  unsigned hitCount; // Number of lookups that found the entry in the cache
+  uint64_t lastHit;  // Value of the cache's lookup counter at the most recent hit, larger is more recent
 };
 
 // The key in hash map is a 64-bit compacted Shader Hash
@@ -84,6 +99,8 @@ struct ShaderCacheAuxCreateInfo {
   MetroHash::Hash hash;            // Hash code of compilation options
   const char *cacheFilePath;       // root directory of cache file
   const char *executableName;      // Name of executable file
+  bool compressEntries;            // Whether to compress new cache entries
+  size_t decompressedCacheSize;    // Maximum total size of decompressed copies that are kept for reuse
 };
 
 // Length of date field used in BuildUniqueId
@@ -112,6 +129,15 @@ struct ShaderCacheSerializedHeader {
   size_t shaderDataEnd;  // Offset to the end of shader data
 };
 
+// This is the header of a hot-set manifest, which lists the keys of the most frequently hit entries of a shader cache,
+// hottest first. The keys follow the header as an array of uint64_t.
+struct ShaderCacheHotSetHeader {
+  size_t headerSize;     // Size of the header structure. This member must always be first
+                         // since it is used to validate the serialized data.
+  BuildUniqueId buildId; // Build time/date of the PAL version that created the manifest
+  size_t keyCount;       // Number of keys following the header
+};
+
 typedef void *CacheEntryHandle;
 
 // =====================================================================================================================
@@ -137,9 +163,23 @@ public:
 
   LLPC_NODISCARD Result retrieveShader(CacheEntryHandle hEntry, const void **ppBlob, size_t *size);
 
+  void releaseShader(CacheEntryHandle hEntry);
+
+  size_t getResidentSize();
+
   LLPC_NODISCARD bool isCompatible(const ShaderCacheCreateInfo *createInfo,
                                    const ShaderCacheAuxCreateInfo *auxCreateInfo);
 
+  void getEntryStats(std::vector<ShaderCacheEntryStats> &stats);
+
+  LLPC_NODISCARD Result exportHotSet(size_t maxEntries, void *blob, size_t *size);
+
+  LLPC_NODISCARD Result prewarm(const void *hotSet, size_t hotSetSize);
+
+  void getPrewarmProgress(size_t *done, size_t *total) const;
+
+  void waitForPrewarm();
+
 private:
   ShaderCache(const ShaderCache &) = delete;
   ShaderCache &operator=(const ShaderCache &) = delete;
@@ -154,6 +194,12 @@ private:
   LLPC_NODISCARD Result loadCacheFromFile();
   void resetCacheFile();
   LLPC_NODISCARD Result addShaderToFile(const ShaderIndex *index);
+  void loadHotSetFile();
+  void writeHotSetFile();
+
+  const void *getShaderData(ShaderIndex *index, bool acquire);
+  void trimDecompressedEntries();
+  void prewarmEntries(std::vector<uint64_t> keys);
 
   void *getCacheSpace(size_t numBytes);
 
@@ -188,6 +234,8 @@ private:
   llvm::sys::Mutex m_lock; // Read/Write lock for access to the shader cache hash map
   File m_onDiskFile;       // File for on-disk storage of the cache
   bool m_disableCache;     // Whether disable cache completely
+  bool m_compressEntries;  // Whether new entries are compressed before they are stored
+  bool m_writeHotSet;      // Whether the hot-set manifest is written next to the cache file on destruction
 
   // Map of shader index data which detail the hash, crc, size and CPU memory location for each shader
   // in the cache.
@@ -208,6 +256,15 @@ private:
   ShaderCacheStoreValue m_storeValueFunc;          // StoreValue function used to store shader data in an external cache
   GfxIpVersion m_gfxIp;                            // Graphics IP version info
   MetroHash::Hash m_hash;                          // Hash code of compilation options
+  uint64_t m_lookupCounter;                        // Number of hits so far, used to order entries by recency
+  std::thread m_prewarmThread;                     // Background thread loading the hot set
+  std::atomic<bool> m_prewarmCancel;               // Set to make the prewarm thread stop early
+  std::atomic<size_t> m_prewarmDone;               // Number of hot-set entries processed by the prewarm thread
+  std::atomic<size_t> m_prewarmTotal;              // Number of hot-set entries the prewarm thread was started with
+  std::vector<uint64_t> m_prewarmKeys;             // Keys of the hot set most recently passed to prewarm()
+  size_t m_decompressedCacheSize;                  // Maximum total size of decompressed copies that are not in use
+  size_t m_decompressedSize;                       // Total size of the decompressed copies currently held
+  std::list<ShaderIndex *> m_decompressedList;     // Entries holding a decompressed copy, most recently used first
 };
 
 } // namespace Llpc
@@ -31,8 +31,12 @@
 #include "llpcSpirvLowerConstImmediateStore.h"
 #include "SPIRVInternal.h"
 #include "llpcContext.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Support/Debug.h"
+#include <functional>
+#include <map>
+#include <memory>
 #include <vector>
 
 #define DEBUG_TYPE "llpc-spirv-lower-const-immediate-store"
@@ -83,6 +87,7 @@ bool SpirvLowerConstImmediateStore::runImpl(Module &module) {
   LLVM_DEBUG(dbgs() << "Run the pass Spirv-Lower-Const-Immediate-Store\n");
 
   SpirvLower::init(&module);
+  m_readOnlyGlobals.clear();
 
   // Process "alloca" instructions to see if they can be optimized to a read-only global
   // variable.
@@ -104,21 +109,164 @@ bool SpirvLowerConstImmediateStore::runImpl(Module &module) {
 void SpirvLowerConstImmediateStore::processAllocaInsts(Function *func) {
   // NOTE: We only visit the entry block on the basis that SPIR-V translator puts all "alloca"
   // instructions there.
-  auto entryBlock = &func->front();
-  for (auto instIt = entryBlock->begin(), instItEnd = entryBlock->end(); instIt != instItEnd; ++instIt) {
-    auto inst = &*instIt;
-    if (auto allocaInst = dyn_cast<AllocaInst>(inst)) {
-      if (allocaInst->getType()->getElementType()->isAggregateType()) {
-        // Got an "alloca" instruction of aggregate type.
-        auto storeInst = findSingleStore(allocaInst);
-        if (storeInst && isa<Constant>(storeInst->getValueOperand())) {
-          // Got an aggregate "alloca" with a single store to the whole type.
-          // Do the optimization.
-          convertAllocaToReadOnlyGlobal(storeInst);
+  SmallVector<AllocaInst *, 8> allocaInsts;
+  for (auto &inst : func->front()) {
+    if (auto allocaInst = dyn_cast<AllocaInst>(&inst)) {
+      if (allocaInst->getType()->getElementType()->isAggregateType())
+        allocaInsts.push_back(allocaInst);
+    }
+  }
+
+  std::unique_ptr<DominatorTree> domTree;
+  for (auto allocaInst : allocaInsts) {
+    // Got an "alloca" instruction of aggregate type.
+    auto storeInst = findSingleStore(allocaInst);
+    if (storeInst && isa<Constant>(storeInst->getValueOperand())) {
+      // Got an aggregate "alloca" with a single store to the whole type.
+      // Do the optimization.
+      convertAllocaToReadOnlyGlobal(allocaInst, cast<Constant>(storeInst->getValueOperand()), storeInst);
+      continue;
+    }
+
+    // Otherwise, see if every element is stored once with a constant before being read.
+    if (!domTree)
+      domTree = std::make_unique<DominatorTree>(*func);
+    SmallVector<StoreInst *, 16> storeInsts;
+    if (Constant *initializer = findElementWiseInitializer(allocaInst, *domTree, storeInsts))
+      convertAllocaToReadOnlyGlobal(allocaInst, initializer, storeInsts);
+  }
+}
+
+// =====================================================================================================================
+// Finds the constant initializer of an aggregate "alloca" whose elements are each stored exactly once with a constant,
+// through constant-index "getelementptr" instructions, before any load from the "alloca" on all paths.
+//
+// Returns nullptr if the "alloca" is not initialized in that way. This is conservative: all the stores must be in
+// one basic block, and every load must either follow the last store in that block or be in a block it dominates.
+//
+// @param allocaInst : The "alloca" instruction to process
+// @param domTree : Dominator tree of the function
+// @param [out] storeInsts : The element "store" instructions
+Constant *SpirvLowerConstImmediateStore::findElementWiseInitializer(AllocaInst *allocaInst, DominatorTree &domTree,
+                                                                    SmallVectorImpl<StoreInst *> &storeInsts) {
+  using ElementPath = SmallVector<unsigned, 4>;
+  std::map<ElementPath, Constant *> elements;
+  SmallVector<LoadInst *, 16> loadInsts;
+
+  // Records the scalar elements of a stored constant. Returns false if one of them was already stored.
+  std::function<bool(Constant *, ElementPath &)> addElements = [&](Constant *value, ElementPath &path) {
+    auto ty = value->getType();
+    if (isa<StructType>(ty) || isa<ArrayType>(ty) || isa<FixedVectorType>(ty)) {
+      unsigned elementCount = isa<StructType>(ty) ? ty->getStructNumElements()
+                              : isa<ArrayType>(ty) ? ty->getArrayNumElements()
+                                                   : cast<FixedVectorType>(ty)->getNumElements();
+      for (unsigned i = 0; i < elementCount; ++i) {
+        path.push_back(i);
+        bool added = addElements(value->getAggregateElement(i), path);
+        path.pop_back();
+        if (!added)
+          return false;
+      }
+      return true;
+    }
+    return elements.insert({path, value}).second;
+  };
+
+  // Walk the uses of the "alloca". A pointer is dynamic if it comes from a "getelementptr" with a non-constant index;
+  // only loads are allowed through those.
+  struct PointerInfo {
+    Instruction *pointer;
+    ElementPath path;
+    bool isDynamic;
+  };
+  SmallVector<PointerInfo, 8> pointers;
+  pointers.push_back({allocaInst, {}, false});
+  while (!pointers.empty()) {
+    PointerInfo info = pointers.pop_back_val();
+    for (User *user : info.pointer->users()) {
+      if (auto storeInst = dyn_cast<StoreInst>(user)) {
+        auto value = dyn_cast<Constant>(storeInst->getValueOperand());
+        if (!value || info.isDynamic || storeInst->isVolatile() || !addElements(value, info.path))
+          return nullptr;
+        storeInsts.push_back(storeInst);
+      } else if (auto getElemPtrInst = dyn_cast<GetElementPtrInst>(user)) {
+        PointerInfo elementInfo = {getElemPtrInst, info.path, info.isDynamic};
+        auto firstIdx = dyn_cast<ConstantInt>(*getElemPtrInst->idx_begin());
+        elementInfo.isDynamic |= !firstIdx || !firstIdx->isZero();
+        for (auto idxIt = getElemPtrInst->idx_begin() + 1, idxItEnd = getElemPtrInst->idx_end(); idxIt != idxItEnd;
+             ++idxIt) {
+          if (auto idx = dyn_cast<ConstantInt>(*idxIt))
+            elementInfo.path.push_back(idx->getZExtValue());
+          else
+            elementInfo.isDynamic = true;
         }
+        pointers.push_back(elementInfo);
+      } else if (auto loadInst = dyn_cast<LoadInst>(user)) {
+        loadInsts.push_back(loadInst);
+      } else {
+        // Pointer escapes by being used in some way other than "load/store/getelementptr".
+        return nullptr;
       }
     }
   }
+
+  if (storeInsts.empty())
+    return nullptr;
+
+  // All stores must be in one block, and every load must come after the last of them.
+  BasicBlock *storeBlock = storeInsts.front()->getParent();
+  StoreInst *lastStore = storeInsts.front();
+  for (auto storeInst : storeInsts) {
+    if (storeInst->getParent() != storeBlock)
+      return nullptr;
+    if (lastStore->comesBefore(storeInst))
+      lastStore = storeInst;
+  }
+  for (auto loadInst : loadInsts) {
+    if (loadInst->getParent() == storeBlock ? loadInst->comesBefore(lastStore)
+                                            : !domTree.dominates(storeBlock, loadInst->getParent()))
+      return nullptr;
+  }
+
+  // Build the initializer; every scalar element must have been stored.
+  ElementPath path;
+  unsigned usedElementCount = 0;
+  std::function<Constant *(Type *)> buildInitializer = [&](Type *ty) -> Constant * {
+    if (!isa<StructType>(ty) && !isa<ArrayType>(ty) && !isa<FixedVectorType>(ty)) {
+      auto elementIt = elements.find(path);
+      if (elementIt == elements.end() || elementIt->second->getType() != ty)
+        return nullptr;
+      ++usedElementCount;
+      return elementIt->second;
+    }
+    unsigned elementCount = isa<StructType>(ty) ? ty->getStructNumElements()
+                            : isa<ArrayType>(ty) ? ty->getArrayNumElements()
+                                                 : cast<FixedVectorType>(ty)->getNumElements();
+    SmallVector<Constant *, 16> elementValues;
+    for (unsigned i = 0; i < elementCount; ++i) {
+      Type *elementTy = isa<StructType>(ty) ? ty->getStructElementType(i)
+                        : isa<ArrayType>(ty) ? ty->getArrayElementType()
+                                             : cast<FixedVectorType>(ty)->getElementType();
+      path.push_back(i);
+      Constant *elementValue = buildInitializer(elementTy);
+      path.pop_back();
+      if (!elementValue)
+        return nullptr;
+      elementValues.push_back(elementValue);
+    }
+    if (auto structTy = dyn_cast<StructType>(ty))
+      return ConstantStruct::get(structTy, elementValues);
+    if (auto arrayTy = dyn_cast<ArrayType>(ty))
+      return ConstantArray::get(arrayTy, elementValues);
+    return ConstantVector::get(elementValues);
+  };
+
+  Constant *initializer = buildInitializer(allocaInst->getType()->getElementType());
+  // Every stored element must be part of the initializer, which is not the case for a store through an out-of-range
+  // constant index.
+  if (usedElementCount != elements.size())
+    return nullptr;
+  return initializer;
 }
 
 // =====================================================================================================================
@@ -166,21 +314,32 @@ StoreInst *SpirvLowerConstImmediateStore::findSingleStore(AllocaInst *allocaInst
 }
 
 // =====================================================================================================================
-// Converts an "alloca" instruction with a single constant store into a read-only global variable.
+// Converts an "alloca" instruction initialized with constant stores into a read-only global variable. Identical
+// tables share one global variable, which is marked unnamed_addr so that the copies in other shader stages can be
+// merged when the pipeline is linked.
 //
-// NOTE: This erases the "store" instruction (so it will not be lowered by a later lowering pass
+// NOTE: This erases the "store" instructions (so they will not be lowered by a later lowering pass
 // any more) but not the "alloca" or replaced "getelementptr" instruction (they will be removed
 // later by DCE pass).
 //
-// @param storeInst : The single constant store into the "alloca"
-void SpirvLowerConstImmediateStore::convertAllocaToReadOnlyGlobal(StoreInst *storeInst) {
-  auto allocaInst = cast<AllocaInst>(storeInst->getPointerOperand());
+// @param allocaInst : The "alloca" instruction to convert
+// @param initializer : Constant contents of the "alloca"
+// @param storeInsts : The constant stores into the "alloca"
+void SpirvLowerConstImmediateStore::convertAllocaToReadOnlyGlobal(AllocaInst *allocaInst, Constant *initializer,
+                                                                  ArrayRef<StoreInst *> storeInsts) {
+  for (auto storeInst : storeInsts)
+    storeInst->eraseFromParent();
+
   auto globalType = allocaInst->getType()->getElementType();
-  auto global = new GlobalVariable(*m_module, globalType,
-                                   true, // isConstant
-                                   GlobalValue::InternalLinkage, cast<Constant>(storeInst->getValueOperand()), "",
-                                   nullptr, GlobalValue::NotThreadLocal, SPIRAS_Constant);
-  global->takeName(allocaInst);
+  GlobalVariable *&global = m_readOnlyGlobals[initializer];
+  if (!global) {
+    global = new GlobalVariable(*m_module, globalType,
+                                true, // isConstant
+                                GlobalValue::InternalLinkage, initializer, "", nullptr, GlobalValue::NotThreadLocal,
+                                SPIRAS_Constant);
+    global->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+    global->takeName(allocaInst);
+  }
   // Change all uses of pAllocaInst to use pGlobal. We need to do it manually, as there is a change
   // of address space, and we also need to recreate "getelementptr"s.
   std::vector<std::pair<Instruction *, Value *>> allocaToGlobalMap;
@@ -210,7 +369,6 @@ void SpirvLowerConstImmediateStore::convertAllocaToReadOnlyGlobal(StoreInst *sto
     }
     // Visit next map pair.
   } while (!allocaToGlobalMap.empty());
-  storeInst->eraseFromParent();
 }
 
 } // namespace Llpc
@@ -31,10 +31,14 @@
 #pragma once
 
 #include "llpcSpirvLower.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/PassManager.h"
 
 namespace llvm {
 class AllocaInst;
+class Constant;
+class DominatorTree;
+class GlobalVariable;
 class StoreInst;
 } // namespace llvm
 
@@ -52,7 +56,12 @@ public:
 private:
   void processAllocaInsts(llvm::Function *func);
   llvm::StoreInst *findSingleStore(llvm::AllocaInst *allocaInst);
-  void convertAllocaToReadOnlyGlobal(llvm::StoreInst *storeInst);
+  llvm::Constant *findElementWiseInitializer(llvm::AllocaInst *allocaInst, llvm::DominatorTree &domTree,
+                                             llvm::SmallVectorImpl<llvm::StoreInst *> &storeInsts);
+  void convertAllocaToReadOnlyGlobal(llvm::AllocaInst *allocaInst, llvm::Constant *initializer,
+                                     llvm::ArrayRef<llvm::StoreInst *> storeInsts);
+
+  llvm::DenseMap<llvm::Constant *, llvm::GlobalVariable *> m_readOnlyGlobals; // Read-only global for each initializer
 };
 
 // =====================================================================================================================
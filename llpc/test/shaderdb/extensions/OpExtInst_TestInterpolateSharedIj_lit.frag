@@ -0,0 +1,36 @@
+#version 450
+
+layout(location = 0) in vec4 f4_0;
+layout(location = 1) noperspective in vec4 f4_1;
+layout(location = 2) in vec4 f4_2;
+layout(location = 3) in vec4 f4_3;
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+    // Interpolation at the current sample uses the hardware sample I/J.
+    vec4 s = interpolateAtSample(f4_0, gl_SampleID) + interpolateAtSample(f4_1, gl_SampleID);
+
+    // The I/J adjusted by the same offset are evaluated once and shared by both inputs.
+    vec4 o = interpolateAtOffset(f4_2, vec2(0.25, -0.125)) + interpolateAtOffset(f4_3, vec2(0.25, -0.125));
+
+    fragColor = s + o;
+}
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline before-patching results
+; SHADERTEST-NOT: @lgc.input.import.builtin.SamplePosOffset
+; SHADERTEST-DAG: = call <2 x float> @lgc.input.import.builtin.InterpPerspSample.v2f32.i32(i32 268435456)
+; SHADERTEST-DAG: = call <2 x float> @lgc.input.import.builtin.InterpLinearSample.v2f32.i32(i32 268435460)
+; SHADERTEST: = call <3 x float> @lgc.input.import.builtin.InterpPullMode
+; SHADERTEST-COUNT-12: = call i32 @llvm.amdgcn.mov.dpp.i32(i32
+; SHADERTEST: = call <4 x float> @lgc.input.import.interpolant.v4f32{{.*}}v2f32(i32 2,
+; SHADERTEST-NOT: @lgc.input.import.builtin.InterpPullMode
+; SHADERTEST-NOT: = call i32 @llvm.amdgcn.mov.dpp.i32(i32
+; SHADERTEST: = call <4 x float> @lgc.input.import.interpolant.v4f32{{.*}}v2f32(i32 3,
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
@@ -0,0 +1,43 @@
+#version 450
+
+layout(location= 0) in vec4 input1;
+
+layout(location = 0) out vec4 output1;
+
+layout(binding = 0) uniform Uniforms
+{
+    int i;
+};
+
+float lookup(int idx)
+{
+    float table[4];
+    table[0] = 1;
+    table[1] = 2;
+    table[2] = 3;
+    table[3] = 4;
+    return table[idx];
+}
+
+void main()
+{
+    float table[4];
+    table[0] = 1;
+    table[1] = 2;
+    table[2] = 3;
+    table[3] = 4;
+    output1 = input1 + vec4(table[i], lookup(i + 1), 0, 0);
+}
+
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+; SHADERTEST-LABEL: {{^// LLPC}} SPIRV-to-LLVM translation results
+; SHADERTEST-LABEL: {{^// LLPC}} SPIR-V lowering results
+; SHADERTEST: @{{.*}} = {{.*}} addrspace(4) constant [4 x float] [float 1.000000e+00, float 2.000000e+00, float 3.000000e+00, float 4.000000e+00]
+; SHADERTEST-NOT: constant [4 x float]
+; SHADERTEST-NOT: alloca [4 x float]
+; SHADERTEST: getelementptr [4 x float], [4 x float] addrspace(4)* @{{.*}}, i64 0, i64 %{{[0-9]*}}
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
@@ -261,6 +261,7 @@ namespace cl {
 extern opt<bool> EnablePipelineDump;
 extern opt<std::string> PipelineDumpDir;
 extern opt<bool> EnableTimerProfile;
+extern opt<bool> EnableMemoryProfile;
 extern opt<bool> BuildShaderCache;
 
 } // namespace cl
@@ -462,7 +463,8 @@ static Error processInputs(ICompiler *compiler, InputSpecGroup &inputSpecs) {
   }
 
   std::unique_ptr<PipelineBuilder> builder =
-      createPipelineBuilder(*compiler, compileInfo, dumpOptions, TimePassesIsEnabled || cl::EnableTimerProfile);
+      createPipelineBuilder(*compiler, compileInfo, dumpOptions,
+                            TimePassesIsEnabled || cl::EnableTimerProfile || cl::EnableMemoryProfile);
   if (Error err = builder->build())
     return err;
 
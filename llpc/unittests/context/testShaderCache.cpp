@@ -235,5 +235,204 @@ TEST_F(ShaderCacheTest, InsertsShadersMultithreaded) {
   EXPECT_GE(cacheSize, sizeof(ShaderCacheSerializedHeader) + (numShaders * cacheEntry.size()));
 }
 
+TEST_F(ShaderCacheTest, ExportsHotSetAndPrewarms) {
+  ShaderCache &cache = getCache();
+  SmallVector<char> cacheEntry(64);
+  std::iota(cacheEntry.begin(), cacheEntry.end(), 0);
+
+  // Insert three entries and hit them 0, 2 and 1 times respectively.
+  constexpr unsigned numShaders = 3;
+  const unsigned numHits[numShaders] = {0, 2, 1};
+  SmallVector<MetroHash::Hash, 0> hashes;
+  for (unsigned i = 0; i < numShaders; ++i) {
+    hashes.push_back(hashFromDWords(i, 2, 3, 4));
+    CacheEntryHandle handle = nullptr;
+    EXPECT_EQ(cache.findShader(hashes.back(), true, &handle), ShaderEntryState::Compiling);
+    cache.insertShader(handle, cacheEntry.data(), cacheEntry.size());
+    for (unsigned hit = 0; hit < numHits[i]; ++hit)
+      EXPECT_EQ(cache.findShader(hashes.back(), false, &handle), ShaderEntryState::Ready);
+  }
+
+  std::vector<ShaderCacheEntryStats> stats;
+  cache.getEntryStats(stats);
+  EXPECT_EQ(stats.size(), numShaders);
+  for (const ShaderCacheEntryStats &entry : stats) {
+    for (unsigned i = 0; i < numShaders; ++i) {
+      if (entry.key == MetroHash::compact64(&hashes[i]))
+        EXPECT_EQ(entry.hitCount, numHits[i]);
+    }
+  }
+
+  // The manifest lists the entries that were hit, hottest first.
+  size_t hotSetSize = 0;
+  EXPECT_EQ(cache.exportHotSet(16, nullptr, &hotSetSize), Result::Success);
+  EXPECT_EQ(hotSetSize, sizeof(ShaderCacheHotSetHeader) + 2 * sizeof(uint64_t));
+  SmallVector<char> hotSet(hotSetSize);
+  EXPECT_EQ(cache.exportHotSet(16, hotSet.data(), &hotSetSize), Result::Success);
+  const auto *keys = reinterpret_cast<const uint64_t *>(hotSet.data() + sizeof(ShaderCacheHotSetHeader));
+  EXPECT_EQ(keys[0], MetroHash::compact64(&hashes[1]));
+  EXPECT_EQ(keys[1], MetroHash::compact64(&hashes[2]));
+
+  // Prewarming goes through the whole hot set.
+  EXPECT_EQ(cache.prewarm(hotSet.data(), hotSet.size()), Result::Success);
+  cache.waitForPrewarm();
+  size_t done = 0;
+  size_t total = 0;
+  cache.getPrewarmProgress(&done, &total);
+  EXPECT_EQ(total, 2);
+  EXPECT_EQ(done, total);
+
+  // A damaged manifest is rejected.
+  hotSet[0] ^= 1;
+  EXPECT_EQ(cache.prewarm(hotSet.data(), hotSet.size()), Result::ErrorInvalidValue);
+}
+
+TEST(ShaderCacheCompressionTest, CompressedEntryRoundTrips) {
+  ShaderCacheCreateInfo createInfo = {};
+  ShaderCacheAuxCreateInfo auxCreateInfo = {};
+  auxCreateInfo.shaderCacheMode = ShaderCacheMode::ShaderCacheEnableRuntime;
+  auxCreateInfo.gfxIp = GfxIp;
+  auxCreateInfo.compressEntries = true;
+
+  ShaderCache cache;
+  EXPECT_EQ(cache.init(&createInfo, &auxCreateInfo), Result::Success);
+
+  // A highly repetitive entry, similar to the zero padding found in pipeline ELFs.
+  SmallVector<char> cacheEntry(4096);
+  for (auto &byteAndIndex : enumerate(cacheEntry))
+    byteAndIndex.value() = static_cast<char>(byteAndIndex.index() % 64 < 48 ? 0 : byteAndIndex.index());
+
+  MetroHash::Hash hash = {};
+  hash.dwords[0] = 1;
+  CacheEntryHandle handle = nullptr;
+  EXPECT_EQ(cache.findShader(hash, true, &handle), ShaderEntryState::Compiling);
+  cache.insertShader(handle, cacheEntry.data(), cacheEntry.size());
+
+  // The entry is stored compressed.
+  size_t cacheSize = 0;
+  EXPECT_EQ(cache.Serialize(nullptr, &cacheSize), Result::Success);
+  EXPECT_LT(cacheSize, sizeof(ShaderCacheSerializedHeader) + sizeof(ShaderHeader) + cacheEntry.size());
+
+  // Retrieval returns the original data, and repeated lookups reuse the same decompressed copy while it is in use.
+  const void *blob = nullptr;
+  size_t blobSize = 0;
+  EXPECT_EQ(cache.retrieveShader(handle, &blob, &blobSize), Result::Success);
+  EXPECT_THAT(ArrayRef<char>(static_cast<const char *>(blob), blobSize), ElementsAreArray(cacheEntry));
+  const void *secondBlob = nullptr;
+  EXPECT_EQ(cache.retrieveShader(handle, &secondBlob, &blobSize), Result::Success);
+  EXPECT_EQ(blob, secondBlob);
+
+  // A cache loaded from the serialized data can decompress the entry, even with compression disabled.
+  SmallVector<char> serialized(cacheSize);
+  EXPECT_EQ(cache.Serialize(serialized.data(), &cacheSize), Result::Success);
+  createInfo.pInitialData = serialized.data();
+  createInfo.initialDataSize = serialized.size();
+  auxCreateInfo.compressEntries = false;
+  ShaderCache loadedCache;
+  EXPECT_EQ(loadedCache.init(&createInfo, &auxCreateInfo), Result::Success);
+  EXPECT_EQ(loadedCache.findShader(hash, false, &handle), ShaderEntryState::Ready);
+  EXPECT_EQ(loadedCache.retrieveShader(handle, &blob, &blobSize), Result::Success);
+  EXPECT_THAT(ArrayRef<char>(static_cast<const char *>(blob), blobSize), ElementsAreArray(cacheEntry));
+}
+
+TEST(ShaderCacheCompressionTest, DecompressedCopiesAreBounded) {
+  ShaderCacheCreateInfo createInfo = {};
+  ShaderCacheAuxCreateInfo auxCreateInfo = {};
+  auxCreateInfo.shaderCacheMode = ShaderCacheMode::ShaderCacheEnableRuntime;
+  auxCreateInfo.gfxIp = GfxIp;
+  auxCreateInfo.compressEntries = true;
+  // Room for the decompressed copy of a single entry.
+  constexpr size_t EntrySize = 4096;
+  auxCreateInfo.decompressedCacheSize = EntrySize;
+
+  ShaderCache cache;
+  EXPECT_EQ(cache.init(&createInfo, &auxCreateInfo), Result::Success);
+
+  constexpr unsigned NumEntries = 8;
+  SmallVector<char> cacheEntry(EntrySize);
+  CacheEntryHandle handles[NumEntries] = {};
+  for (unsigned i = 0; i < NumEntries; ++i) {
+    for (auto &byteAndIndex : enumerate(cacheEntry))
+      byteAndIndex.value() = static_cast<char>(byteAndIndex.index() % 64 < 48 ? i : byteAndIndex.index());
+    MetroHash::Hash hash = {};
+    hash.dwords[0] = i + 1;
+    EXPECT_EQ(cache.findShader(hash, true, &handles[i]), ShaderEntryState::Compiling);
+    cache.insertShader(handles[i], cacheEntry.data(), cacheEntry.size());
+  }
+  const size_t storedSize = cache.getResidentSize();
+  EXPECT_LT(storedSize, NumEntries * EntrySize);
+
+  // A retrieved copy stays resident until it is released.
+  const void *blob = nullptr;
+  size_t blobSize = 0;
+  EXPECT_EQ(cache.retrieveShader(handles[0], &blob, &blobSize), Result::Success);
+  EXPECT_EQ(blobSize, EntrySize);
+  EXPECT_EQ(cache.getResidentSize(), storedSize + EntrySize);
+
+  // Repeated hits on every entry keep at most one released copy resident.
+  cache.releaseShader(handles[0]);
+  for (unsigned round = 0; round < 4; ++round) {
+    for (unsigned i = 0; i < NumEntries; ++i) {
+      EXPECT_EQ(cache.retrieveShader(handles[i], &blob, &blobSize), Result::Success);
+      EXPECT_EQ(static_cast<const char *>(blob)[0], static_cast<char>(i));
+      EXPECT_LE(cache.getResidentSize(), storedSize + 2 * EntrySize);
+      cache.releaseShader(handles[i]);
+      EXPECT_LE(cache.getResidentSize(), storedSize + EntrySize);
+    }
+  }
+
+  // Repeated hits on the same entry reuse its copy.
+  const void *secondBlob = nullptr;
+  EXPECT_EQ(cache.retrieveShader(handles[NumEntries - 1], &secondBlob, &blobSize), Result::Success);
+  EXPECT_EQ(blob, secondBlob);
+  cache.releaseShader(handles[NumEntries - 1]);
+  EXPECT_EQ(cache.getResidentSize(), storedSize + EntrySize);
+}
+
+TEST(ShaderCacheCompressionTest, PrewarmLoadsOnlyWhatFits) {
+  ShaderCacheCreateInfo createInfo = {};
+  ShaderCacheAuxCreateInfo auxCreateInfo = {};
+  auxCreateInfo.shaderCacheMode = ShaderCacheMode::ShaderCacheEnableRuntime;
+  auxCreateInfo.gfxIp = GfxIp;
+  auxCreateInfo.compressEntries = true;
+  // Room for the decompressed copy of a single entry.
+  constexpr size_t EntrySize = 4096;
+  auxCreateInfo.decompressedCacheSize = EntrySize;
+
+  ShaderCache cache;
+  EXPECT_EQ(cache.init(&createInfo, &auxCreateInfo), Result::Success);
+
+  // Insert entries and hit each of them once, so that they are all in the hot set.
+  constexpr unsigned NumEntries = 4;
+  SmallVector<char> cacheEntry(EntrySize);
+  for (unsigned i = 0; i < NumEntries; ++i) {
+    for (auto &byteAndIndex : enumerate(cacheEntry))
+      byteAndIndex.value() = static_cast<char>(byteAndIndex.index() % 64 < 48 ? i : byteAndIndex.index());
+    MetroHash::Hash hash = {};
+    hash.dwords[0] = i + 1;
+    CacheEntryHandle handle = nullptr;
+    EXPECT_EQ(cache.findShader(hash, true, &handle), ShaderEntryState::Compiling);
+    cache.insertShader(handle, cacheEntry.data(), cacheEntry.size());
+    EXPECT_EQ(cache.findShader(hash, false, &handle), ShaderEntryState::Ready);
+  }
+
+  size_t hotSetSize = 0;
+  EXPECT_EQ(cache.exportHotSet(16, nullptr, &hotSetSize), Result::Success);
+  EXPECT_EQ(hotSetSize, sizeof(ShaderCacheHotSetHeader) + NumEntries * sizeof(uint64_t));
+  SmallVector<char> hotSet(hotSetSize);
+  EXPECT_EQ(cache.exportHotSet(16, hotSet.data(), &hotSetSize), Result::Success);
+
+  // Prewarming completes the whole hot set but keeps no more decompressed copies than fit in the size limit.
+  const size_t storedSize = cache.getResidentSize();
+  EXPECT_EQ(cache.prewarm(hotSet.data(), hotSet.size()), Result::Success);
+  cache.waitForPrewarm();
+  size_t done = 0;
+  size_t total = 0;
+  cache.getPrewarmProgress(&done, &total);
+  EXPECT_EQ(total, NumEntries);
+  EXPECT_EQ(done, total);
+  EXPECT_EQ(cache.getResidentSize(), storedSize + EntrySize);
+}
+
 } // namespace
 } // namespace Llpc
@@ -157,7 +157,7 @@ bool CacheAccessor::lookUpInShaderCache(const MetroHash::Hash &hash, bool alloca
   CacheEntryHandle currentEntry;
   ShaderEntryState cacheEntryState = cache->findShader(hash, allocateOnMiss, &currentEntry);
   if (cacheEntryState == ShaderEntryState::Ready) {
-    Result result = cache->retrieveShader(currentEntry, &m_elf.pCode, &m_elf.codeSize);
+    Result result = retrieveFromShaderCache(cache, currentEntry);
     if (result == Result::Success) {
       m_shaderCacheEntryState = ShaderEntryState::Ready;
       return true;
@@ -171,6 +171,30 @@ bool CacheAccessor::lookUpInShaderCache(const MetroHash::Hash &hash, bool alloca
   return false;
 }
 
+// =====================================================================================================================
+// Retrieves the ELF of a ready entry from the given shader cache. The retrieval is released when the cache accessor is
+// destroyed.
+//
+// @param cache : The shader cache holding the entry.
+// @param entry : The handle of the entry.
+Result CacheAccessor::retrieveFromShaderCache(ShaderCache *cache, CacheEntryHandle entry) {
+  releaseRetrievedShader();
+  Result result = cache->retrieveShader(entry, &m_elf.pCode, &m_elf.codeSize);
+  m_retrievedShaderCache = cache;
+  m_retrievedShaderCacheEntry = entry;
+  return result;
+}
+
+// =====================================================================================================================
+// Releases the retrieval of the ELF from the shader cache, if there is one.
+void CacheAccessor::releaseRetrievedShader() {
+  if (!m_retrievedShaderCache)
+    return;
+  m_retrievedShaderCache->releaseShader(m_retrievedShaderCacheEntry);
+  m_retrievedShaderCache = nullptr;
+  m_retrievedShaderCacheEntry = nullptr;
+}
+
 // =====================================================================================================================
 // Sets the ELF entry for the hash on a cache miss.  Does nothing if there was a cache hit or the ELF has already been
 // set.
@@ -179,8 +203,7 @@ bool CacheAccessor::lookUpInShaderCache(const MetroHash::Hash &hash, bool alloca
 void CacheAccessor::setElfInCache(BinaryData elf) {
   if (m_shaderCacheEntryState == ShaderEntryState::Compiling && m_shaderCacheEntry) {
     updateShaderCache(elf);
-    mustSucceed(m_shaderCache->retrieveShader(m_shaderCacheEntry, &m_elf.pCode, &m_elf.codeSize),
-                "Failed to retrieve shader");
+    mustSucceed(retrieveFromShaderCache(m_shaderCache, m_shaderCacheEntry), "Failed to retrieve shader");
     m_shaderCacheEntryState = ShaderEntryState::Ready;
   }
 
@@ -59,16 +59,21 @@ public:
   CacheAccessor(CacheAccessor &&ca) { *this = std::move(ca); }
 
   CacheAccessor &operator=(CacheAccessor &&ca) {
+    releaseRetrievedShader();
     m_applicationCaches = ca.m_applicationCaches;
     m_internalCaches = ca.m_internalCaches;
     m_shaderCacheEntryState = ca.m_shaderCacheEntryState;
     m_shaderCacheEntry = ca.m_shaderCacheEntry;
     m_shaderCache = ca.m_shaderCache;
+    m_retrievedShaderCache = ca.m_retrievedShaderCache;
+    m_retrievedShaderCacheEntry = ca.m_retrievedShaderCacheEntry;
     m_cacheResult = ca.m_cacheResult;
     m_cacheEntry = std::move(ca.m_cacheEntry);
     m_elf = ca.m_elf;
 
     // Reinitialize ca with not caches.  It needs to be in an appropriate state for the destructor.
+    ca.m_retrievedShaderCache = nullptr;
+    ca.m_retrievedShaderCacheEntry = nullptr;
     ca.initialize(nullptr, nullptr, {nullptr, nullptr});
     return *this;
   }
@@ -76,7 +81,10 @@ public:
   CacheAccessor(Context *context, MetroHash::Hash &cacheHash, CachePair internalCaches);
 
   // Finalizes the cache access by releasing any handles that need to be released.
-  ~CacheAccessor() { setElfInCache({0, nullptr}); }
+  ~CacheAccessor() {
+    setElfInCache({0, nullptr});
+    releaseRetrievedShader();
+  }
 
   // Returns true of the entry was in at least on of the caches or has been added to the cache.
   bool isInCache() const {
@@ -142,6 +150,8 @@ private:
   bool lookUpInShaderCache(const MetroHash::Hash &hash, bool allocateOnMiss, ShaderCache *cache);
   void updateShaderCache(BinaryData &elf);
   void resetShaderCacheTrackingData();
+  Result retrieveFromShaderCache(ShaderCache *cache, CacheEntryHandle entry);
+  void releaseRetrievedShader();
 
   CachePair m_applicationCaches;
   CachePair m_internalCaches;
@@ -155,6 +165,10 @@ private:
   // The shader cache that the entry refers to.
   ShaderCache *m_shaderCache = nullptr;
 
+  // The shader cache and entry that the ELF was retrieved from. The ELF stays valid until the retrieval is released.
+  ShaderCache *m_retrievedShaderCache = nullptr;
+  CacheEntryHandle m_retrievedShaderCacheEntry = nullptr;
+
   // The result of checking the ICache.
   Result m_cacheResult = Result::ErrorUnknown;
 
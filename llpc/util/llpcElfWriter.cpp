@@ -252,6 +252,25 @@ static void updateRootDescriptorRegisters(Context *context, msgpack::Document &d
 // @param [out] pNewNote : Merged note section
 template <class Elf>
 void ElfWriter<Elf>::mergeMetaNote(Context *pContext, const ElfNote *pNote1, const ElfNote *pNote2, ElfNote *pNewNote) {
+  mergeHwStageMetaNote(pContext, pNote1, pNote2, 1U << static_cast<unsigned>(Util::Abi::HardwareStage::Ps),
+                       1U << ShaderStageFragment, 0, pNewNote);
+}
+
+// =====================================================================================================================
+// Merges the info of the given hardware stages and API shader stages for meta notes.
+//
+// @param pContext : Context related to the notes
+// @param pNote1 : The note section to merge into
+// @param pNote2 : Note section that contains the info of the hardware stages to merge
+// @param hwStageMask : Mask of hardware stages (Util::Abi::HardwareStage) to take from pNote2
+// @param apiStageMask : Mask of API shader stages (ShaderStage) to take from pNote2
+// @param removeHwStageMask : Mask of hardware stages (Util::Abi::HardwareStage) to remove from pNote1
+// @param [out] pNewNote : Merged note section
+template <class Elf>
+void ElfWriter<Elf>::mergeHwStageMetaNote(Context *pContext, const ElfNote *pNote1, const ElfNote *pNote2,
+                                          unsigned hwStageMask, unsigned apiStageMask, unsigned removeHwStageMask,
+                                          ElfNote *pNewNote) {
+  assert((hwStageMask & removeHwStageMask) == 0);
   msgpack::Document destDocument;
   msgpack::Document srcDocument;
 
@@ -268,11 +287,14 @@ void ElfWriter<Elf>::mergeMetaNote(Context *pContext, const ElfNote *pNote1, con
       destDocument.getRoot().getMap(true)[PalAbi::CodeObjectMetadataKey::Pipelines].getArray(true)[0];
   auto srcPipeline =
       srcDocument.getRoot().getMap(true)[PalAbi::CodeObjectMetadataKey::Pipelines].getArray(true)[0];
+  const bool mergePs = (hwStageMask & (1U << static_cast<unsigned>(Util::Abi::HardwareStage::Ps))) != 0;
 
   // Copy .num_interpolants
-  auto srcNumIterpIt = srcPipeline.getMap(true).find(StringRef(PalAbi::PipelineMetadataKey::NumInterpolants));
-  if (srcNumIterpIt != srcPipeline.getMap(true).end())
-    destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::NumInterpolants] = srcNumIterpIt->second;
+  if (mergePs) {
+    auto srcNumIterpIt = srcPipeline.getMap(true).find(StringRef(PalAbi::PipelineMetadataKey::NumInterpolants));
+    if (srcNumIterpIt != srcPipeline.getMap(true).end())
+      destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::NumInterpolants] = srcNumIterpIt->second;
+  }
 
   // Copy .spill_threshold
   auto destSpillThreshold = destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::SpillThreshold].getUInt();
@@ -286,16 +308,30 @@ void ElfWriter<Elf>::mergeMetaNote(Context *pContext, const ElfNote *pNote1, con
   destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::UserDataLimit] =
       destDocument.getNode(std::max(destUserDataLimit, srcUserDataLimit));
 
-  // Copy whole .ps hw stage
+  // Copy whole hw stages
   auto destHwStages = destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::HardwareStages].getMap(true);
   auto srcHwStages = srcPipeline.getMap(true)[PalAbi::PipelineMetadataKey::HardwareStages].getMap(true);
-  auto hwPsStageName = HwStageNames[static_cast<unsigned>(Util::Abi::HardwareStage::Ps)];
-  destHwStages[hwPsStageName] = srcHwStages[hwPsStageName];
+  for (unsigned hwStage = 0; hwStage < static_cast<unsigned>(Util::Abi::HardwareStage::Count); ++hwStage) {
+    if (((hwStageMask | removeHwStageMask) & (1U << hwStage)) == 0)
+      continue;
+    auto srcHwStageIt = (hwStageMask & (1U << hwStage)) ? srcHwStages.find(StringRef(HwStageNames[hwStage]))
+                                                        : srcHwStages.end();
+    if (srcHwStageIt != srcHwStages.end()) {
+      destHwStages[HwStageNames[hwStage]] = srcHwStageIt->second;
+    } else {
+      auto destHwStageIt = destHwStages.find(StringRef(HwStageNames[hwStage]));
+      if (destHwStageIt != destHwStages.end())
+        destHwStages.erase(destHwStageIt);
+    }
+  }
 
-  // Copy whole .pixel shader
+  // Copy whole API shaders
   auto destShaders = destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::Shaders].getMap(true);
   auto srcShaders = srcPipeline.getMap(true)[PalAbi::PipelineMetadataKey::Shaders].getMap(true);
-  destShaders[ApiStageNames[ShaderStageFragment]] = srcShaders[ApiStageNames[ShaderStageFragment]];
+  for (unsigned stage = 0; stage < ShaderStageGfxCount; ++stage) {
+    if (apiStageMask & (1U << stage))
+      destShaders[ApiStageNames[stage]] = srcShaders[ApiStageNames[stage]];
+  }
 
   // Update pipeline hash
   auto pipelineHash = destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::InternalPipelineHash].getArray(true);
@@ -330,24 +366,104 @@ void ElfWriter<Elf>::mergeMetaNote(Context *pContext, const ElfNote *pNote1, con
       0x2C35, // mmSPI_SHADER_USER_ACCUM_PS_3
   };
 
-  // Merge fragment shader related registers. For each of the registers listed above, plus the input
+  // Lists of the program registers of the GFX9+ merged hardware stages. The remaining registers of these stages are
+  // derived from the whole pipeline state, so they are the same in both notes.
+  static const unsigned HsRegNumbers[] = {
+      0x2D0A, // mmSPI_SHADER_PGM_RSRC1_HS
+      0x2D0B, // mmSPI_SHADER_PGM_RSRC2_HS
+      0x2D07, // mmSPI_SHADER_PGM_RSRC3_HS
+      0x2D01, // mmSPI_SHADER_PGM_RSRC4_HS
+      0x2D00, // mmSPI_SHADER_PGM_CHKSUM_HS
+      0x2D32, // mmSPI_SHADER_USER_ACCUM_LSHS_0
+      0x2D33, // mmSPI_SHADER_USER_ACCUM_LSHS_1
+      0x2D34, // mmSPI_SHADER_USER_ACCUM_LSHS_2
+      0x2D35, // mmSPI_SHADER_USER_ACCUM_LSHS_3
+  };
+  static const unsigned GsRegNumbers[] = {
+      0x2C8A, // mmSPI_SHADER_PGM_RSRC1_GS
+      0x2C8B, // mmSPI_SHADER_PGM_RSRC2_GS
+      0x2C87, // mmSPI_SHADER_PGM_RSRC3_GS
+      0x2C81, // mmSPI_SHADER_PGM_RSRC4_GS
+      0x2C80, // mmSPI_SHADER_PGM_CHKSUM_GS
+      0x2CB2, // mmSPI_SHADER_USER_ACCUM_ESGS_0
+      0x2CB3, // mmSPI_SHADER_USER_ACCUM_ESGS_1
+      0x2CB4, // mmSPI_SHADER_USER_ACCUM_ESGS_2
+      0x2CB5, // mmSPI_SHADER_USER_ACCUM_ESGS_3
+  };
+  static const unsigned VsRegNumbers[] = {
+      0x2C4A, // mmSPI_SHADER_PGM_RSRC1_VS
+      0x2C4B, // mmSPI_SHADER_PGM_RSRC2_VS
+      0x2C46, // mmSPI_SHADER_PGM_RSRC3_VS
+      0x2C41, // mmSPI_SHADER_PGM_RSRC4_VS
+      0x2C45, // mmSPI_SHADER_PGM_CHKSUM_VS
+      0x2C72, // mmSPI_SHADER_USER_ACCUM_VS_0
+      0x2C73, // mmSPI_SHADER_USER_ACCUM_VS_1
+      0x2C74, // mmSPI_SHADER_USER_ACCUM_VS_2
+      0x2C75, // mmSPI_SHADER_USER_ACCUM_VS_3
+  };
+
+  // Merge the registers of each hardware stage. For each of the registers listed above, plus the input
   // control registers and the user data registers, copy the value from srcRegisters to destRegisters.
-  // Where the register is set in destRegisters but not srcRegisters, clear it.
+  // Where the register is set in destRegisters but not srcRegisters, clear it. The registers of a hardware stage to
+  // remove are merged from an empty map, which clears them all.
   auto destRegisters = destPipeline.getMap(true)[PalAbi::PipelineMetadataKey::Registers].getMap(true);
   auto srcRegisters = srcPipeline.getMap(true)[PalAbi::PipelineMetadataKey::Registers].getMap(true);
-
-  for (unsigned regNumber : ArrayRef<unsigned>(PsRegNumbers))
-    mergeMapItem(destRegisters, srcRegisters, regNumber);
-
-  const unsigned mmSpiPsInputCntl0 = 0xa191;
-  const unsigned mmSpiPsInputCntl31 = 0xa1b0;
-  for (unsigned regNumber = mmSpiPsInputCntl0; regNumber != mmSpiPsInputCntl31 + 1; ++regNumber)
-    mergeMapItem(destRegisters, srcRegisters, regNumber);
-
-  const unsigned mmSpiShaderUserDataPs0 = 0x2c0c;
-  unsigned psUserDataCount = pContext->getGfxIpVersion().major < 9 ? 16 : 32;
-  for (unsigned regNumber = mmSpiShaderUserDataPs0; regNumber != mmSpiShaderUserDataPs0 + psUserDataCount; ++regNumber)
-    mergeMapItem(destRegisters, srcRegisters, regNumber);
+  auto noRegisters = srcDocument.getMapNode().getMap();
+  const unsigned userDataCount = pContext->getGfxIpVersion().major < 9 ? 16 : 32;
+  for (unsigned hwStage = 0; hwStage < static_cast<unsigned>(Util::Abi::HardwareStage::Count); ++hwStage) {
+    if (((hwStageMask | removeHwStageMask) & (1U << hwStage)) == 0)
+      continue;
+    msgpack::MapDocNode &fromRegisters = (hwStageMask & (1U << hwStage)) ? srcRegisters : noRegisters;
+    auto mergeRegs = [&](ArrayRef<unsigned> regNumbers) {
+      for (unsigned regNumber : regNumbers)
+        mergeMapItem(destRegisters, fromRegisters, regNumber);
+    };
+    auto mergeRegRange = [&](unsigned firstRegNumber, unsigned regCount) {
+      for (unsigned regNumber = firstRegNumber; regNumber != firstRegNumber + regCount; ++regNumber)
+        mergeMapItem(destRegisters, fromRegisters, regNumber);
+    };
+
+    switch (static_cast<Util::Abi::HardwareStage>(hwStage)) {
+    case Util::Abi::HardwareStage::Ps: {
+      mergeRegs(PsRegNumbers);
+
+      const unsigned mmSpiPsInputCntl0 = 0xa191;
+      const unsigned mmSpiPsInputCntl31 = 0xa1b0;
+      mergeRegRange(mmSpiPsInputCntl0, mmSpiPsInputCntl31 + 1 - mmSpiPsInputCntl0);
+
+      const unsigned mmSpiShaderUserDataPs0 = 0x2c0c;
+      mergeRegRange(mmSpiShaderUserDataPs0, userDataCount);
+      break;
+    }
+    case Util::Abi::HardwareStage::Hs: {
+      assert(pContext->getGfxIpVersion().major >= 9);
+      mergeRegs(HsRegNumbers);
+      const unsigned mmSpiShaderUserDataHs0 = 0x2D0C;
+      mergeRegRange(mmSpiShaderUserDataHs0, userDataCount);
+      break;
+    }
+    case Util::Abi::HardwareStage::Gs: {
+      assert(pContext->getGfxIpVersion().major >= 9);
+      mergeRegs(GsRegNumbers);
+      // GFX9 puts the user data of merged ES-GS into the ES registers, GFX10+ into the GS registers.
+      const unsigned mmSpiShaderUserDataGs0 = 0x2C8C;
+      const unsigned mmSpiShaderUserDataEs0 = 0x2CCC;
+      mergeRegRange(mmSpiShaderUserDataGs0, userDataCount);
+      mergeRegRange(mmSpiShaderUserDataEs0, userDataCount);
+      break;
+    }
+    case Util::Abi::HardwareStage::Vs: {
+      assert(pContext->getGfxIpVersion().major >= 9);
+      mergeRegs(VsRegNumbers);
+      const unsigned mmSpiShaderUserDataVs0 = 0x2C4C;
+      mergeRegRange(mmSpiShaderUserDataVs0, userDataCount);
+      break;
+    }
+    default:
+      // GFX9+ doesn't use LS and ES, so they have no registers of their own.
+      break;
+    }
+  }
 
   updateRootDescriptorRegisters(pContext, destDocument);
 
@@ -819,12 +935,9 @@ template <class Elf> void ElfWriter<Elf>::addRelocSymbols(const ElfReader<Elf> &
 
   // Create a section named origSectionName.cached.
   // If the section does not exist, the memory will be freed in ElfWrith destructor.
-  const size_t inputSecNameLen = strlen(relocSym.secName);
-  const size_t newSecNameSize = inputSecNameLen + strlen(CachedRodataSectionSuffix) + 1;
-  char *secName = new char[newSecNameSize];
-  memset(secName, 0, newSecNameSize);
-  memcpy(secName, relocSym.secName, inputSecNameLen);
-  memcpy(secName + inputSecNameLen, CachedRodataSectionSuffix, newSecNameSize - inputSecNameLen);
+  const std::string newSecName = std::string(relocSym.secName) + CachedRodataSectionSuffix + m_cachedRodataTag;
+  char *secName = new char[newSecName.size() + 1];
+  memcpy(secName, newSecName.c_str(), newSecName.size() + 1);
 
   for (auto section : m_sections) {
     if (strcmp(section.name, secName) == 0) {
@@ -858,12 +971,9 @@ template <class Elf> void ElfWriter<Elf>::addRelocSymbols(const ElfReader<Elf> &
     ElfSymbol symbol = {};
     // Create a new symbol named origSymbolName_cached.
     // The memory will be freed in ElfWrith destructor.
-    const size_t inputSymbolNameLen = strlen(rodataSymbol.pSymName);
-    const size_t newSymSize = inputSymbolNameLen + strlen(CachedRodataSymbolSuffix) + 1;
-    char *newSymName = new char[newSymSize];
-    memset(newSymName, 0, newSymSize);
-    memcpy(newSymName, rodataSymbol.pSymName, inputSymbolNameLen);
-    memcpy(newSymName + inputSymbolNameLen, CachedRodataSymbolSuffix, newSymSize - inputSymbolNameLen);
+    const std::string newSymbolName = std::string(rodataSymbol.pSymName) + CachedRodataSymbolSuffix + m_cachedRodataTag;
+    char *newSymName = new char[newSymbolName.size() + 1];
+    memcpy(newSymName, newSymbolName.c_str(), newSymbolName.size() + 1);
     symbol.secIdx = m_sections.size() - 1;
     symbol.secName = secName;
     symbol.size = rodataSymbol.size;
@@ -881,24 +991,17 @@ template <class Elf> void ElfWriter<Elf>::addRelocSymbols(const ElfReader<Elf> &
 // @param inputSymbolName : The input reloc symbol name
 // @returns : Reloc symbol index
 template <class Elf> uint32_t ElfWriter<Elf>::getRelocSymbolIndex(const char *inputSymbolName) {
-  const size_t inputSymbolNameLen = strlen(inputSymbolName);
-  const size_t newSymSize = inputSymbolNameLen + strlen(CachedRodataSymbolSuffix) + 1;
-  char *newSymName = new char[newSymSize];
-  memset(newSymName, 0, newSymSize);
-  memcpy(newSymName, inputSymbolName, inputSymbolNameLen);
-  memcpy(newSymName + inputSymbolNameLen, CachedRodataSymbolSuffix, newSymSize - inputSymbolNameLen);
+  const std::string newSymName = std::string(inputSymbolName) + CachedRodataSymbolSuffix + m_cachedRodataTag;
 
   uint32_t index = 0;
   for (auto symbol : m_symbols) {
     if (symbol.secIdx == InvalidValue)
       continue;
-    if (symbol.nameOffset == InvalidValue && strcmp(newSymName, symbol.pSymName) == 0)
+    if (symbol.nameOffset == InvalidValue && strcmp(newSymName.c_str(), symbol.pSymName) == 0)
       break;
     ++index;
   }
 
-  delete[] newSymName;
-
   return index;
 }
 
@@ -1129,6 +1232,66 @@ template <class Elf> void ElfWriter<Elf>::updateElfBinary(Context *pContext, Elf
   writeToBuffer(pPipelineElf);
 }
 
+// =====================================================================================================================
+// Update the registers that depend only on register-only graphics pipeline state (state left out of the cache hash),
+// so that an ELF built for a pipeline differing from this one only in such state can be reused for it.
+//
+// @param pipelineInfo : Info of the graphics pipeline the ELF is reused for
+// @param pipelineHash : Pipeline hash of the graphics pipeline the ELF is reused for
+// @param [out] pipelineElf : Final ELF binary
+template <class Elf>
+void ElfWriter<Elf>::updateRegisterOnlyState(const GraphicsPipelineBuildInfo *pipelineInfo, uint64_t pipelineHash,
+                                             ElfPackage *pipelineElf) {
+  ElfNote metaNote = getNote(Util::Abi::MetadataNoteType);
+  assert(metaNote.data);
+
+  msgpack::Document document;
+  auto success =
+      document.readFromBlob(StringRef(reinterpret_cast<const char *>(metaNote.data), metaNote.hdr.descSize), false);
+  assert(success);
+  (void(success)); // unused
+
+  auto pipeline = document.getRoot().getMap(true)[PalAbi::CodeObjectMetadataKey::Pipelines].getArray(true)[0];
+  auto registers = pipeline.getMap(true)[PalAbi::PipelineMetadataKey::Registers].getMap(true);
+
+  // Replace the masked bits of a register, if the pipeline sets that register at all.
+  auto updateRegisterBits = [&](unsigned key, unsigned mask, unsigned value) {
+    auto keyIt = registers.find(registers.getDocument()->getNode(key));
+    if (keyIt != registers.end()) {
+      unsigned regValue = (keyIt->second.getUInt() & ~mask) | (value & mask);
+      keyIt->second = registers.getDocument()->getNode(regValue);
+    }
+  };
+
+  // PA_CL_CLIP_CNTL.DX_RASTERIZATION_KILL
+  const unsigned mmPaClClipCntl = 0xA204;
+  const unsigned dxRasterizationKillMask = 1u << 22;
+  updateRegisterBits(mmPaClClipCntl, dxRasterizationKillMask,
+                     pipelineInfo->rsState.rasterizerDiscardEnable ? dxRasterizationKillMask : 0);
+
+  // PA_SC_AA_CONFIG.COVERAGE_TO_SHADER_SELECT (GFX9+ only; the register is absent on older hardware)
+  const unsigned mmPaScAaConfig = 0xA2F8;
+  const unsigned coverageToShaderSelectShift = 26;
+  const unsigned inputInnerCoverage = 1;
+  updateRegisterBits(mmPaScAaConfig, 3u << coverageToShaderSelectShift,
+                     (pipelineInfo->rsState.innerCoverage ? inputInnerCoverage : 0) << coverageToShaderSelectShift);
+
+  // Update pipeline hash
+  auto internalPipelineHash = pipeline.getMap(true)[PalAbi::PipelineMetadataKey::InternalPipelineHash].getArray(true);
+  internalPipelineHash[0] = document.getNode(pipelineHash);
+
+  std::string blob;
+  document.writeToBlob(blob);
+  ElfNote newMetaNote = metaNote;
+  auto data = new uint8_t[blob.size()];
+  memcpy(data, blob.data(), blob.size());
+  newMetaNote.hdr.descSize = blob.size();
+  newMetaNote.data = data;
+  setNote(&newMetaNote);
+
+  writeToBuffer(pipelineElf);
+}
+
 // =====================================================================================================================
 // Merge ELF binary of fragment shader and ELF binary of non-fragment shaders into single ELF binary
 //
@@ -1320,6 +1483,205 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   writeToBuffer(pPipelineElf);
 }
 
+// =====================================================================================================================
+// Merge the given hardware stages from another ELF binary of the same pipeline into this ELF binary. The ISA of each
+// hardware stage is appended to the .text section and the stage's symbols are re-pointed at the appended copy, so any
+// code this ELF already had for the stage is left unreferenced.
+//
+// NOTE: It is only used for GFX9+, where the hardware stages we split a pipeline into are self-contained.
+//
+// @param pContext : Pipeline context
+// @param pSrcElf : ELF binary that contains the hardware stages to merge
+// @param hwStageMask : Mask of hardware stages (Util::Abi::HardwareStage) to take from pSrcElf
+// @param apiStageMask : Mask of API shader stages (ShaderStage) that are compiled into those hardware stages
+// @param removeHwStageMask : Mask of hardware stages (Util::Abi::HardwareStage) the pipeline doesn't have, to remove
+//                            from this ELF
+// @param [out] pPipelineElf : Final ELF binary
+template <class Elf>
+void ElfWriter<Elf>::mergeHwStageElf(Context *pContext, const BinaryData *pSrcElf, unsigned hwStageMask,
+                                     unsigned apiStageMask, unsigned removeHwStageMask, ElfPackage *pPipelineElf) {
+  // Entry point symbols of the hardware stages, in Util::Abi::HardwareStage order.
+  static const Util::Abi::PipelineSymbolType HwStageEntrySymbols[] = {
+      Util::Abi::PipelineSymbolType::LsMainEntry, Util::Abi::PipelineSymbolType::HsMainEntry,
+      Util::Abi::PipelineSymbolType::EsMainEntry, Util::Abi::PipelineSymbolType::GsMainEntry,
+      Util::Abi::PipelineSymbolType::VsMainEntry, Util::Abi::PipelineSymbolType::PsMainEntry,
+      Util::Abi::PipelineSymbolType::CsMainEntry,
+  };
+
+  ElfReader<Elf64> reader(m_gfxIp);
+
+  auto srcCodeSize = pSrcElf->codeSize;
+  mustSucceed(reader.ReadFromBuffer(pSrcElf->pCode, &srcCodeSize));
+
+  ElfSectionBuffer<Elf64::SectionHeader> *srcTextSection = nullptr;
+  std::vector<ElfSymbol> srcSymbols;
+  auto srcTextSecIndex = reader.GetSectionIndex(TextName);
+  auto textSecIndex = GetSectionIndex(TextName);
+  Result result = reader.getSectionDataBySectionIndex(srcTextSecIndex, &srcTextSection);
+  assert(result == Result::Success || result == Result::ErrorInvalidValue);
+  (void)result;
+  if (!srcTextSection)
+    return;
+  reader.GetSymbolsBySectionIndex(srcTextSecIndex, srcSymbols);
+
+  // NOTE: Entry name of the first shader stage is missed in disassembly section, we have to add it back when merge
+  // disassembly sections.
+  std::string firstIsaSymbolName;
+  std::vector<ElfSymbol *> symbols;
+  GetSymbolsBySectionIndex(textSecIndex, symbols);
+  for (auto symbol : symbols) {
+    if (strncmp(symbol->pSymName, "_amdgpu_", strlen("_amdgpu_")) == 0) {
+      firstIsaSymbolName = symbol->pSymName;
+      break;
+    }
+  }
+
+  // Keep the rodata taken from this ELF apart from any rodata merged into this ELF before.
+  m_cachedRodataTag = std::to_string(m_sections.size());
+
+  const std::string llvmIrSectionName = std::string(Util::Abi::AmdGpuCommentLlvmIrName);
+  for (unsigned hwStage = 0; hwStage < static_cast<unsigned>(Util::Abi::HardwareStage::Count); ++hwStage) {
+    if (((hwStageMask | removeHwStageMask) & (1U << hwStage)) == 0)
+      continue;
+    auto entryName = Util::Abi::PipelineAbiSymbolNameStrings[static_cast<unsigned>(HwStageEntrySymbols[hwStage])];
+
+    // The ISA of the hardware stage runs from its entry point up to the next entry point.
+    const ElfSymbol *srcEntrySymbol = nullptr;
+    if (hwStageMask & (1U << hwStage)) {
+      for (auto &srcSymbol : srcSymbols) {
+        if (strcmp(srcSymbol.pSymName, entryName) == 0)
+          srcEntrySymbol = &srcSymbol;
+      }
+    }
+    if (!srcEntrySymbol) {
+      // The pipeline doesn't use the hardware stage, so drop any entry point this ELF has for it.
+      for (auto &symbol : m_symbols) {
+        if (strcmp(symbol.pSymName, entryName) == 0)
+          symbol.secIdx = InvalidValue;
+      }
+      continue;
+    }
+
+    size_t srcIsaStart = srcEntrySymbol->value;
+    size_t srcIsaEnd = srcTextSection->secHead.sh_size;
+    for (auto &srcSymbol : srcSymbols) {
+      if (srcSymbol.value > srcIsaStart && srcSymbol.value < srcIsaEnd &&
+          strncmp(srcSymbol.pSymName, "_amdgpu_", strlen("_amdgpu_")) == 0)
+        srcIsaEnd = srcSymbol.value;
+    }
+
+    // Merge GPU ISA code
+    const SectionBuffer *textSection = nullptr;
+    mustSucceed(getSectionDataBySectionIndex(textSecIndex, &textSection));
+    size_t isaOffset = alignTo(textSection->secHead.sh_size, 0x100);
+
+    SectionBuffer srcIsa = *srcTextSection;
+    srcIsa.secHead.sh_size = srcIsaEnd;
+    SectionBuffer newTextSection = {};
+    mergeSection(textSection, isaOffset, nullptr, &srcIsa, srcIsaStart, nullptr, &newTextSection);
+    setSection(textSecIndex, &newTextSection);
+
+    for (auto &srcSymbol : srcSymbols) {
+      if (srcSymbol.value < srcIsaStart || srcSymbol.value >= srcIsaEnd)
+        continue;
+      ElfSymbol *symbol = getSymbol(srcSymbol.pSymName);
+      symbol->secIdx = textSecIndex;
+      symbol->secName = nullptr;
+      symbol->value = isaOffset + srcSymbol.value - srcIsaStart;
+      symbol->size = srcSymbol.size;
+    }
+
+    // Merge the relocs that patch the ISA of the hardware stage.
+    SectionBuffer *srcRelocSection = nullptr;
+    result = reader.getSectionDataBySectionIndex(reader.GetSectionIndex(RelocName), &srcRelocSection);
+    assert(result == Result::Success || result == Result::ErrorInvalidValue);
+    (void)result;
+    size_t srcRelocStart = srcRelocSection ? getRelocPsStartPos(srcRelocSection, srcIsaStart) : 0;
+    size_t srcRelocEnd = srcRelocSection ? getRelocPsStartPos(srcRelocSection, srcIsaEnd) : 0;
+    if (srcRelocStart < srcRelocEnd) {
+      const SectionBuffer *relocSection = nullptr;
+      auto relocSecIndex = GetSectionIndex(RelocName);
+      if (getSectionDataBySectionIndex(relocSecIndex, &relocSection) != Result::Success) {
+        // This ELF does not have reloc section, then a reloc section need to be created.
+        SectionBuffer newRelocSection = createNewSection(RelocName, srcRelocSection);
+        m_sections.push_back(newRelocSection);
+        m_relocSecIdx = m_sections.size() - 1;
+        m_map[RelocName] = m_relocSecIdx;
+        relocSecIndex = m_relocSecIdx;
+        mustSucceed(getSectionDataBySectionIndex(relocSecIndex, &relocSection));
+      }
+
+      SectionBuffer srcRelocs = *srcRelocSection;
+      srcRelocs.secHead.sh_size = srcRelocEnd * srcRelocSection->secHead.sh_entsize;
+      int64_t diffOfIsaOffset = isaOffset - srcIsaStart;
+      SectionBuffer newRelocSection = mergeRelocSection(reader, relocSection, numRelocs(relocSection), &srcRelocs,
+                                                        srcRelocStart, diffOfIsaOffset);
+      setSection(relocSecIndex, &newRelocSection);
+    }
+
+    // Merge ISA disassemble and LLVM IR disassemble
+    appendTextSectionRange(reader, Util::Abi::AmdGpuDisassemblyName, entryName, firstIsaSymbolName.c_str());
+    appendTextSectionRange(reader, llvmIrSectionName.c_str(), entryName, firstIsaSymbolName.c_str());
+    firstIsaSymbolName.clear();
+  }
+
+  m_cachedRodataTag.clear();
+
+  // Merge PAL metadata
+  ElfNote metaNote = {};
+  metaNote = getNote(Util::Abi::MetadataNoteType);
+
+  assert(metaNote.data);
+  ElfNote srcMetaNote = {};
+  ElfNote newMetaNote = {};
+  srcMetaNote = reader.getNote(Util::Abi::MetadataNoteType);
+  mergeHwStageMetaNote(pContext, &metaNote, &srcMetaNote, hwStageMask, apiStageMask, removeHwStageMask, &newMetaNote);
+  setNote(&newMetaNote);
+
+  writeToBuffer(pPipelineElf);
+}
+
+// =====================================================================================================================
+// Append the part of a text section of another ELF binary that belongs to the given entry point to the same section of
+// this ELF binary. The part runs from the name of the entry point up to the name of the next entry point.
+//
+// @param reader : The ElfReader to the other ELF binary
+// @param sectionName : Name of the text section
+// @param entryName : Name of the entry point
+// @param firstEntryName : Name to put before the existing contents of the section if they don't start with it, or empty
+template <class Elf>
+void ElfWriter<Elf>::appendTextSectionRange(const ElfReader<Elf> &reader, const char *sectionName,
+                                            const char *entryName, const char *firstEntryName) {
+  ElfSectionBuffer<Elf64::SectionHeader> *srcSection = nullptr;
+  const ElfSectionBuffer<Elf64::SectionHeader> *section = nullptr;
+  auto srcSecIndex = reader.GetSectionIndex(sectionName);
+  auto secIndex = GetSectionIndex(sectionName);
+  Result result = reader.getSectionDataBySectionIndex(srcSecIndex, &srcSection);
+  assert(result == Result::Success || result == Result::ErrorInvalidValue);
+  (void)result;
+  result = getSectionDataBySectionIndex(secIndex, &section);
+  assert(result == Result::Success || result == Result::NotFound);
+  (void)result;
+  if (!srcSection || !section || srcSection->secHead.sh_size == 0)
+    return;
+
+  // NOTE: The section data of ElfReader isn't null terminated, so search it through a StringRef.
+  StringRef srcText(reinterpret_cast<const char *>(srcSection->data), srcSection->secHead.sh_size);
+  size_t start = srcText.find(entryName);
+  if (start == StringRef::npos) {
+    // The entry name of the first shader stage is missed, so it starts the section.
+    start = 0;
+  }
+  size_t end = std::min(srcText.find("_amdgpu_", start + strlen(entryName)), srcText.size());
+
+  SectionBuffer srcRange = *srcSection;
+  srcRange.secHead.sh_size = end;
+  SectionBuffer newSection = {};
+  mergeSection(section, section->secHead.sh_size, *firstEntryName != '\0' ? firstEntryName : nullptr, &srcRange,
+               start, entryName, &newSection);
+  setSection(secIndex, &newSection);
+}
+
 // =====================================================================================================================
 // Reset the contents to an empty ELF file.
 template <class Elf> void ElfWriter<Elf>::reinitialize() {
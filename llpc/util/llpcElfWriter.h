@@ -74,6 +74,9 @@ public:
 
   static void mergeMetaNote(Context *context, const ElfNote *note1, const ElfNote *note2, ElfNote *newNote);
 
+  static void mergeHwStageMetaNote(Context *context, const ElfNote *note1, const ElfNote *note2, unsigned hwStageMask,
+                                   unsigned apiStageMask, unsigned removeHwStageMask, ElfNote *newNote);
+
   static void updateMetaNote(Context *context, const ElfNote *note, ElfNote *newNote);
 
   LLPC_NODISCARD static size_t numRelocs(const SectionBuffer *relocSection);
@@ -97,8 +100,14 @@ public:
 
   void updateElfBinary(Context *context, ElfPackage *pipelineElf);
 
+  void updateRegisterOnlyState(const Vkgc::GraphicsPipelineBuildInfo *pipelineInfo, uint64_t pipelineHash,
+                               ElfPackage *pipelineElf);
+
   void mergeElfBinary(Context *context, const BinaryData *fragmentElf, ElfPackage *pipelineElf);
 
+  void mergeHwStageElf(Context *context, const BinaryData *srcElf, unsigned hwStageMask, unsigned apiStageMask,
+                       unsigned removeHwStageMask, ElfPackage *pipelineElf);
+
   // Gets the section index for the specified section name.
   LLPC_NODISCARD int GetSectionIndex(const char *name) const {
     auto entry = m_map.find(name);
@@ -139,6 +148,9 @@ private:
 
   void assembleSymbols();
 
+  void appendTextSectionRange(const ElfReader<Elf> &reader, const char *sectionName, const char *entryName,
+                              const char *firstEntryName);
+
   void reinitialize();
 
   GfxIpVersion m_gfxIp;                  // Graphics IP version info (used by ELF dump only)
@@ -154,6 +166,9 @@ private:
   int m_relocSecIdx;  // Section index of relocation section
   int m_symSecIdx;    // Section index of symbol table section
   int m_strtabSecIdx; // Section index of string table section
+
+  std::string m_cachedRodataTag; // Tag appended to the names of rodata sections and symbols taken from another ELF,
+                                 // to keep those of different merged ELFs apart
 };
 
 } // namespace Llpc
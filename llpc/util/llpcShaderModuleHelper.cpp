@@ -35,6 +35,7 @@
 #include "vkgcUtil.h"
 #include "llvm/Support/raw_ostream.h"
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 using namespace llvm;
 
@@ -64,6 +65,18 @@ Result ShaderModuleHelper::collectInfoFromSpirvBinary(const BinaryData *spvBinCo
   // Parse SPIR-V instructions
   std::unordered_set<unsigned> capabilities;
 
+  // Information to find which generic input/output locations are used. A type missing from locationCounts takes an
+  // unknown number of locations.
+  std::unordered_map<unsigned, unsigned> locations;         // Location decoration of each ID
+  std::unordered_set<unsigned> structsWithMemberLocation;   // Struct types with member location decorations
+  std::unordered_map<unsigned, unsigned> scalarWidths;      // Bit width of each scalar type
+  std::unordered_map<unsigned, unsigned> locationCounts;    // Count of locations taken by each type
+  std::unordered_map<unsigned, unsigned> arrayElementTypes; // Element type of each array type
+  std::unordered_map<unsigned, unsigned> constants;         // Low word of each constant
+  std::unordered_map<unsigned, unsigned> pointeeTypes;      // Pointee type of each pointer type
+  shaderModuleUsage->inputLocationMask = 0;
+  shaderModuleUsage->outputLocationMask = 0;
+
   while (codePos < end) {
     unsigned opCode = (codePos[0] & OpCodeMask);
     unsigned wordCount = (codePos[0] >> WordCountShift);
@@ -95,7 +108,76 @@ Result ShaderModuleHelper::collectInfoFromSpirvBinary(const BinaryData *spvBinCo
           (opCode == OpDecorate) ? static_cast<Decoration>(codePos[2]) : static_cast<Decoration>(codePos[3]);
       if (decoration == DecorationInvariant) {
         shaderModuleUsage->useInvariant = true;
+      } else if (decoration == DecorationLocation) {
+        if (opCode == OpDecorate)
+          locations[codePos[1]] = codePos[3];
+        else
+          structsWithMemberLocation.insert(codePos[1]);
+      }
+      break;
+    }
+    case OpTypeBool:
+      scalarWidths[codePos[1]] = 32;
+      locationCounts[codePos[1]] = 1;
+      break;
+    case OpTypeInt:
+    case OpTypeFloat:
+      scalarWidths[codePos[1]] = codePos[2];
+      locationCounts[codePos[1]] = 1;
+      break;
+    case OpTypeVector: {
+      // 64-bit vectors with more than two components take two locations.
+      auto widthIt = scalarWidths.find(codePos[2]);
+      if (widthIt != scalarWidths.end())
+        locationCounts[codePos[1]] = (widthIt->second == 64 && codePos[3] > 2) ? 2 : 1;
+      break;
+    }
+    case OpTypeMatrix: {
+      auto countIt = locationCounts.find(codePos[2]);
+      if (countIt != locationCounts.end())
+        locationCounts[codePos[1]] = countIt->second * codePos[3];
+      break;
+    }
+    case OpTypeArray: {
+      arrayElementTypes[codePos[1]] = codePos[2];
+      auto countIt = locationCounts.find(codePos[2]);
+      auto lengthIt = constants.find(codePos[3]);
+      if (countIt != locationCounts.end() && lengthIt != constants.end())
+        locationCounts[codePos[1]] = countIt->second * lengthIt->second;
+      break;
+    }
+    case OpConstant:
+      constants[codePos[2]] = codePos[3];
+      break;
+    case OpTypePointer:
+      pointeeTypes[codePos[1]] = codePos[3];
+      break;
+    case OpVariable: {
+      auto storageClass = static_cast<StorageClass>(codePos[3]);
+      if (storageClass != StorageClassInput && storageClass != StorageClassOutput)
+        break;
+      uint64_t &locationMask = storageClass == StorageClassInput ? shaderModuleUsage->inputLocationMask
+                                                                 : shaderModuleUsage->outputLocationMask;
+      unsigned pointeeType = pointeeTypes[codePos[1]];
+      auto locationIt = locations.find(codePos[2]);
+      if (locationIt == locations.end()) {
+        // Either a built-in, or a block whose members carry the locations.
+        unsigned elementType = pointeeType;
+        for (auto arrayIt = arrayElementTypes.find(elementType); arrayIt != arrayElementTypes.end();
+             arrayIt = arrayElementTypes.find(elementType))
+          elementType = arrayIt->second;
+        if (structsWithMemberLocation.count(elementType) > 0)
+          locationMask = UINT64_MAX;
+        break;
+      }
+      auto countIt = locationCounts.find(pointeeType);
+      if (countIt == locationCounts.end()) {
+        locationMask = UINT64_MAX;
+        break;
       }
+      for (unsigned location = locationIt->second; location < locationIt->second + countIt->second && location < 64;
+           ++location)
+        locationMask |= 1ull << location;
       break;
     }
     case OpDPdx:
@@ -31,13 +31,19 @@
 
 #include "llpcTimerProfiler.h"
 #include "llpc.h"
+#include "llpcDebug.h"
 #include "lgc/LgcContext.h"
 #include "lgc/PassManager.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
 
 using namespace llvm;
 
@@ -48,12 +54,33 @@ namespace cl {
 // -enable-time-profile : profile the compile time of pipeline
 opt<bool> EnableTimerProfile("enable-timer-profile", desc("profile the compile time of pipeline"), init(false));
 
+// -enable-memory-profile : profile the memory usage of pipeline compile phases
+opt<bool> EnableMemoryProfile("enable-memory-profile", desc("profile the memory usage of pipeline compile phases"),
+                              init(false));
+
 } // namespace cl
 
 } // namespace llvm
 
 namespace Llpc {
 
+// =====================================================================================================================
+// Returns whether time or memory profiling is enabled.
+static bool isProfilingEnabled() {
+  return TimePassesIsEnabled || cl::EnableTimerProfile || cl::EnableMemoryProfile;
+}
+
+// =====================================================================================================================
+// Gets the peak resident set size of the process in bytes, or 0 if it is not known on this platform.
+static uint64_t getPeakRss() {
+#if defined(__linux__)
+  struct rusage usage = {};
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+  return 0;
+}
+
 // =====================================================================================================================
 //
 // @param hash64 : Hash code
@@ -61,7 +88,7 @@ namespace Llpc {
 // @param enableMask : Mask of enabled phase timers
 TimerProfiler::TimerProfiler(uint64_t hash64, const char *descriptionPrefix, unsigned enableMask)
     : m_total("", "", getDummyTimeRecords()), m_phases("", "", getDummyTimeRecords()) {
-  if (TimePassesIsEnabled || cl::EnableTimerProfile) {
+  if (isProfilingEnabled()) {
     std::string hashString;
     raw_string_ostream ostream(hashString);
     ostream << format("0x%016" PRIX64, hash64);
@@ -100,17 +127,93 @@ TimerProfiler::TimerProfiler(uint64_t hash64, const char *descriptionPrefix, uns
                                        (Twine(descriptionPrefix) + Twine(" CodeGen ") + hashString).str(), m_phases);
     }
 
+    if (cl::EnableMemoryProfile) {
+      m_description = (Twine(descriptionPrefix) + Twine(" ") + hashString).str();
+      m_startHeapUsage = sys::Process::GetMallocUsage();
+      m_startPeakRss = getPeakRss();
+    }
+
     // Start whole timer
     m_wholeTimer.startTimer();
   }
 }
 
+// =====================================================================================================================
+// Applies the profiling options after the command-line options have been parsed.
+//
+// With -enable-memory-profile, the LLVM timers are made to track heap usage too, so each phase timer records the heap
+// growth of its phase. That covers the phases run inside the middle-end, which only sees the timers. This is done
+// once here, under the lock of compiler creation, as the LLVM option is global. If LLVM has no -track-memory option,
+// memory profiling is disabled.
+void TimerProfiler::initOptions() {
+  if (!cl::EnableMemoryProfile)
+    return;
+
+  auto &registeredOptions = cl::getRegisteredOptions();
+  auto optIterator = registeredOptions.find("track-memory");
+  if (optIterator == registeredOptions.end()) {
+    LLPC_ERRS("Memory profile is disabled: option -track-memory is not available\n");
+    cl::EnableMemoryProfile = false;
+    return;
+  }
+  static_cast<cl::opt<bool> *>(optIterator->second)->setValue(true);
+}
+
 // =====================================================================================================================
 TimerProfiler::~TimerProfiler() {
-  if (TimePassesIsEnabled || cl::EnableTimerProfile) {
+  if (isProfilingEnabled()) {
     // Stop whole timer
     m_wholeTimer.stopTimer();
+
+    if (cl::EnableMemoryProfile)
+      printMemoryProfile();
+  }
+}
+
+// =====================================================================================================================
+// Records the module and instruction counts of a module that is part of the profiled compile.
+//
+// @param module : Module to record
+void TimerProfiler::recordModule(const Module &module) {
+  if (cl::EnableMemoryProfile) {
+    ++m_moduleCount;
+    m_instructionCount += module.getInstructionCount();
+  }
+}
+
+// =====================================================================================================================
+// Prints the memory profile of the compile to stderr, where the timer reports go by default.
+// The heap growth of each phase comes from its timer. The heap still in use at the end of the compile, after the
+// modules of the compile have been freed, is mostly growth of the pooled LLVMContext.
+void TimerProfiler::printMemoryProfile() {
+  static const char *const PhaseNames[TimerCount] = {"Translate", "Lower", "Load", "Patch", "Optimization", "CodeGen"};
+
+  raw_ostream &outStream = errs();
+  auto printLine = [&](const Twine &name, int64_t value, StringRef unit) {
+    outStream << "  " << left_justify((name + ":").str(), 24) << format("%12" PRId64, value) << unit << "\n";
+  };
+
+  outStream << "===" << std::string(73, '-') << "===\n";
+  outStream << "  " << m_description << " Memory Profile\n";
+  outStream << "===" << std::string(73, '-') << "===\n";
+  for (unsigned timerKind = 0; timerKind < TimerCount; ++timerKind) {
+    const Timer &timer = m_phaseTimers[timerKind];
+    if (timer.isInitialized() && timer.hasTriggered())
+      printLine(Twine(PhaseNames[timerKind]) + " heap delta", timer.getTotalTime().getMemUsed(), " bytes");
+  }
+
+  const int64_t retainedHeap =
+      static_cast<int64_t>(sys::Process::GetMallocUsage()) - static_cast<int64_t>(m_startHeapUsage);
+  printLine("Total heap delta", m_wholeTimer.getTotalTime().getMemUsed(), " bytes");
+  printLine("Retained heap", retainedHeap, " bytes");
+  const uint64_t endPeakRss = getPeakRss();
+  if (endPeakRss != 0) {
+    printLine("Peak RSS", endPeakRss, " bytes");
+    printLine("Peak RSS growth", endPeakRss - m_startPeakRss, " bytes");
   }
+  printLine("Modules", m_moduleCount, "");
+  printLine("Instructions", m_instructionCount, "");
+  outStream << "\n";
 }
 
 // =====================================================================================================================
@@ -120,7 +223,7 @@ TimerProfiler::~TimerProfiler() {
 // @param timerKind : Kind of phase timer
 // @param start : Start or  stop timer
 void TimerProfiler::addTimerStartStopPass(lgc::LegacyPassManager *passMgr, TimerKind timerKind, bool start) {
-  if (TimePassesIsEnabled || cl::EnableTimerProfile)
+  if (isProfilingEnabled())
     passMgr->add(lgc::LgcContext::createStartStopTimer(&m_phaseTimers[timerKind], start));
 }
 
@@ -131,7 +234,7 @@ void TimerProfiler::addTimerStartStopPass(lgc::LegacyPassManager *passMgr, Timer
 // @param timerKind : Kind of phase timer
 // @param start : Start or  stop timer
 void TimerProfiler::addTimerStartStopPass(lgc::PassManager &passMgr, TimerKind timerKind, bool start) {
-  if (TimePassesIsEnabled || cl::EnableTimerProfile)
+  if (isProfilingEnabled())
     lgc::LgcContext::createAndAddStartStopTimer(passMgr, &m_phaseTimers[timerKind], start);
 }
 
@@ -141,7 +244,7 @@ void TimerProfiler::addTimerStartStopPass(lgc::PassManager &passMgr, TimerKind t
 // @param timerKind : Kind of phase timer
 // @param start : Start or  stop timer
 void TimerProfiler::startStopTimer(TimerKind timerKind, bool start) {
-  if (TimePassesIsEnabled || cl::EnableTimerProfile) {
+  if (isProfilingEnabled()) {
     if (start)
       m_phaseTimers[timerKind].startTimer();
     else
@@ -150,18 +253,18 @@ void TimerProfiler::startStopTimer(TimerKind timerKind, bool start) {
 }
 
 // =====================================================================================================================
-// Gets a specific timer. Returns nullptr if TimePassesIsEnabled isn't enabled.
+// Gets a specific timer. Returns nullptr if profiling isn't enabled.
 //
 // @param timerKind : Kind of phase timer
 Timer *TimerProfiler::getTimer(TimerKind timerKind) {
-  return TimePassesIsEnabled || cl::EnableTimerProfile ? &m_phaseTimers[timerKind] : nullptr;
+  return isProfilingEnabled() ? &m_phaseTimers[timerKind] : nullptr;
 }
 
 // =====================================================================================================================
 // Gets dummy TimeRecords.
 const StringMap<TimeRecord> &TimerProfiler::getDummyTimeRecords() {
   static StringMap<TimeRecord> DummyTimeRecords;
-  if ((TimePassesIsEnabled || cl::EnableTimerProfile) && DummyTimeRecords.empty()) {
+  if (isProfilingEnabled() && DummyTimeRecords.empty()) {
     // NOTE: It is a workaround to get fixed layout in timer reports. Please remove it if we find a better solution.
     // LLVM timer skips the field if it is zero in all timers, it causes the layout of the report isn't stable when
     // compile multiple pipelines. so we add a dummy record to force all fields is shown.
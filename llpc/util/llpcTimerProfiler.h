@@ -35,6 +35,12 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Timer.h"
 
+namespace llvm {
+
+class Module;
+
+} // namespace llvm
+
 namespace lgc {
 
 class LegacyPassManager;
@@ -72,8 +78,12 @@ public:
 
   llvm::Timer *getTimer(TimerKind timerKind);
 
+  void recordModule(const llvm::Module &module);
+
   static const llvm::StringMap<llvm::TimeRecord> &getDummyTimeRecords();
 
+  static void initOptions();
+
   static const unsigned PipelineTimerEnableMask = ((1 << TimerCount) - 1);
   static const unsigned ShaderModuleTimerEnableMask = ((1 << TimerTranslate) | (1 << TimerLower));
 
@@ -81,10 +91,18 @@ private:
   TimerProfiler(const TimerProfiler &) = delete;
   TimerProfiler &operator=(const TimerProfiler &) = delete;
 
+  void printMemoryProfile();
+
   llvm::TimerGroup m_total;              // TimeGroup for total time
   llvm::TimerGroup m_phases;             // TimeGroup for each phase
   llvm::Timer m_wholeTimer;              // Whole timer
   llvm::Timer m_phaseTimers[TimerCount]; // Phase timer
+
+  std::string m_description;       // Description of the profiled compile, used in the memory report
+  size_t m_startHeapUsage = 0;     // Heap usage when the compile started
+  uint64_t m_startPeakRss = 0;     // Peak RSS of the process when the compile started
+  unsigned m_moduleCount = 0;      // Count of modules recorded by recordModule()
+  uint64_t m_instructionCount = 0; // Count of instructions in the modules recorded by recordModule()
 };
 
 } // namespace Llpc
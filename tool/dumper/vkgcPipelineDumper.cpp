@@ -741,6 +741,12 @@ void PipelineDumper::dumpGraphicsStateInfo(const GraphicsPipelineBuildInfo *pipe
   dumpFile << "usrClipPlaneMask = " << static_cast<unsigned>(pipelineInfo->rsState.usrClipPlaneMask) << "\n";
   dumpFile << "alphaToCoverageEnable = " << pipelineInfo->cbState.alphaToCoverageEnable << "\n";
   dumpFile << "dualSourceBlendEnable = " << pipelineInfo->cbState.dualSourceBlendEnable << "\n";
+  dumpFile << "depthTestEnable = " << pipelineInfo->dsState.depthTestEnable << "\n";
+  dumpFile << "depthCompareOp = " << pipelineInfo->dsState.depthCompareOp << "\n";
+  dumpFile << "stencilTestEnable = " << pipelineInfo->dsState.stencilTestEnable << "\n";
+  dumpFile << "stencilCompareOpFront = " << pipelineInfo->dsState.front.compareOp << "\n";
+  dumpFile << "stencilCompareOpBack = " << pipelineInfo->dsState.back.compareOp << "\n";
+  dumpFile << "depthBoundsTestEnable = " << pipelineInfo->dsState.depthBoundsTestEnable << "\n";
 
   for (unsigned i = 0; i < MaxColorTargets; ++i) {
     if (pipelineInfo->cbState.target[i].format != VK_FORMAT_UNDEFINED) {
@@ -881,16 +887,21 @@ MetroHash::Hash PipelineDumper::generateHashForGraphicsPipeline(const GraphicsPi
 
   // Relocatable shaders force an unlinked compilation.
   hasher.Update(pipeline->unlinked || isRelocatableShader);
-  hasher.Update(pipeline->enableEarlyCompile);
+
+  // A relocatable shader is built the same way whether or not it was compiled early, so leave the flag out of its
+  // hash. This lets a pipeline build find the shaders that an early compile put in the cache.
+  if (!isRelocatableShader)
+    hasher.Update(pipeline->enableEarlyCompile);
 
   if (unlinkedShaderType != UnlinkedStageFragment) {
     if (!isRelocatableShader && !pipeline->enableUberFetchShader)
-      updateHashForVertexInputState(pipeline->pVertexInput, pipeline->dynamicVertexStride, &hasher);
+      updateHashForVertexInputState(pipeline->pVertexInput, pipeline->dynamicVertexStride,
+                                    isCacheHash ? getUsedLocationMask(&pipeline->vs, true) : UINT64_MAX, &hasher);
     updateHashForNonFragmentState(pipeline, isCacheHash, &hasher, isRelocatableShader);
   }
 
   if (unlinkedShaderType != UnlinkedStageVertexProcess)
-    updateHashForFragmentState(pipeline, &hasher, isRelocatableShader);
+    updateHashForFragmentState(pipeline, isCacheHash, &hasher, isRelocatableShader);
 
   MetroHash::Hash hash = {};
   hasher.Finalize(hash.bytes);
@@ -927,37 +938,87 @@ MetroHash::Hash PipelineDumper::generateHashForComputePipeline(const ComputePipe
 }
 
 // =====================================================================================================================
-// Updates hash code context for vertex input state
+// Gets the mask of generic input or output locations that a shader may use, as collected from its shader module.
+// All locations are treated as used if the stage has no shader module.
+//
+// @param shaderInfo : Shader info of a pipeline stage
+// @param isInput : TRUE to get the mask of input locations, FALSE to get the mask of output locations
+uint64_t PipelineDumper::getUsedLocationMask(const PipelineShaderInfo *shaderInfo, bool isInput) {
+  auto moduleData = reinterpret_cast<const ShaderModuleData *>(shaderInfo->pModuleData);
+  if (!moduleData)
+    return UINT64_MAX;
+  return isInput ? moduleData->usage.inputLocationMask : moduleData->usage.outputLocationMask;
+}
+
+// =====================================================================================================================
+// Updates hash code context for vertex input state. Only the attributes at locations the vertex shader may read, and
+// the bindings they are fetched from, are included. If all locations are used, the whole state is included, including
+// bindings no attribute is fetched from.
 //
 // @param vertexInput : Vertex input state
+// @param dynamicVertexStride : Whether the vertex strides are dynamic state
+// @param usedLocationMask : Mask of input locations the vertex shader may read
 // @param [in/out] hasher : Haher to generate hash code
 void PipelineDumper::updateHashForVertexInputState(const VkPipelineVertexInputStateCreateInfo *vertexInput,
-                                                   bool dynamicVertexStride, MetroHash64 *hasher) {
+                                                   bool dynamicVertexStride, uint64_t usedLocationMask,
+                                                   MetroHash64 *hasher) {
   if (vertexInput && vertexInput->vertexBindingDescriptionCount > 0) {
-    hasher->Update(vertexInput->vertexBindingDescriptionCount);
-    if (dynamicVertexStride) {
-      for (uint32_t i = 0; i < vertexInput->vertexBindingDescriptionCount; i++) {
-        auto attribBinding = vertexInput->pVertexBindingDescriptions[i];
-        attribBinding.stride = 0;
-        hasher->Update(attribBinding);
+    auto isAttribUsed = [=](const VkVertexInputAttributeDescription &attrib) {
+      return attrib.location >= 64 || ((usedLocationMask >> attrib.location) & 1) != 0;
+    };
+    auto isBindingUsed = [&](uint32_t binding) {
+      if (usedLocationMask == UINT64_MAX)
+        return true;
+      for (uint32_t i = 0; i < vertexInput->vertexAttributeDescriptionCount; i++) {
+        const auto &attrib = vertexInput->pVertexAttributeDescriptions[i];
+        if (attrib.binding == binding && isAttribUsed(attrib))
+          return true;
       }
-    } else {
-      hasher->Update(reinterpret_cast<const uint8_t *>(vertexInput->pVertexBindingDescriptions),
-                     sizeof(VkVertexInputBindingDescription) * vertexInput->vertexBindingDescriptionCount);
+      return false;
+    };
+
+    // Hash the number of included entries ahead of each run, so that the entries of different runs cannot be mistaken
+    // for one another.
+    uint32_t usedBindingCount = 0;
+    for (uint32_t i = 0; i < vertexInput->vertexBindingDescriptionCount; i++) {
+      if (isBindingUsed(vertexInput->pVertexBindingDescriptions[i].binding))
+        ++usedBindingCount;
     }
-    hasher->Update(vertexInput->vertexAttributeDescriptionCount);
-    if (vertexInput->vertexAttributeDescriptionCount > 0) {
-      hasher->Update(reinterpret_cast<const uint8_t *>(vertexInput->pVertexAttributeDescriptions),
-                     sizeof(VkVertexInputAttributeDescription) * vertexInput->vertexAttributeDescriptionCount);
+    hasher->Update(usedBindingCount);
+    for (uint32_t i = 0; i < vertexInput->vertexBindingDescriptionCount; i++) {
+      auto attribBinding = vertexInput->pVertexBindingDescriptions[i];
+      if (!isBindingUsed(attribBinding.binding))
+        continue;
+      if (dynamicVertexStride)
+        attribBinding.stride = 0;
+      hasher->Update(attribBinding);
+    }
+
+    uint32_t usedAttribCount = 0;
+    for (uint32_t i = 0; i < vertexInput->vertexAttributeDescriptionCount; i++) {
+      if (isAttribUsed(vertexInput->pVertexAttributeDescriptions[i]))
+        ++usedAttribCount;
+    }
+    hasher->Update(usedAttribCount);
+    for (uint32_t i = 0; i < vertexInput->vertexAttributeDescriptionCount; i++) {
+      const auto &attrib = vertexInput->pVertexAttributeDescriptions[i];
+      if (isAttribUsed(attrib))
+        hasher->Update(attrib);
     }
 
     auto vertexDivisor = findVkStructInChain<VkPipelineVertexInputDivisorStateCreateInfoEXT>(
         VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT, vertexInput->pNext);
     unsigned divisorCount = vertexDivisor ? vertexDivisor->vertexBindingDivisorCount : 0;
-    hasher->Update(divisorCount);
-    if (divisorCount > 0) {
-      hasher->Update(reinterpret_cast<const uint8_t *>(vertexDivisor->pVertexBindingDivisors),
-                     sizeof(VkVertexInputBindingDivisorDescriptionEXT) * divisorCount);
+    unsigned usedDivisorCount = 0;
+    for (unsigned i = 0; i < divisorCount; i++) {
+      if (isBindingUsed(vertexDivisor->pVertexBindingDivisors[i].binding))
+        ++usedDivisorCount;
+    }
+    hasher->Update(usedDivisorCount);
+    for (unsigned i = 0; i < divisorCount; i++) {
+      const auto &divisor = vertexDivisor->pVertexBindingDivisors[i];
+      if (isBindingUsed(divisor.binding))
+        hasher->Update(divisor);
     }
   }
 }
@@ -983,7 +1044,9 @@ void PipelineDumper::updateHashForNonFragmentState(const GraphicsPipelineBuildIn
   hasher->Update(iaState->switchWinding);
   hasher->Update(iaState->enableMultiView);
 
-  if (!isRelocatableShader) {
+  // Depth clip enable is not consumed by the compiler, and rasterizer discard only ends up in PA_CL_CLIP_CNTL, so
+  // they are left out of the cache hash. A cached ELF is reused for them after patching its registers.
+  if (!isRelocatableShader && !isCacheHash) {
     auto vpState = &pipeline->vpState;
     hasher->Update(vpState->depthClipEnable);
 
@@ -1034,24 +1097,42 @@ void PipelineDumper::updateHashForNonFragmentState(const GraphicsPipelineBuildIn
 // Update hash code from fragment pipeline state
 //
 // @param pipeline : Info to build a graphics pipeline
+// @param isCacheHash : TRUE if the hash is used by shader cache
 // @param [in/out] hasher : Hasher to generate hash code
 // @param isRelocatableShader : TRUE if we are building relocatable shader
-void PipelineDumper::updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, MetroHash64 *hasher,
-                                                bool isRelocatableShader) {
+void PipelineDumper::updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
+                                                MetroHash64 *hasher, bool isRelocatableShader) {
   auto rsState = &pipeline->rsState;
   hasher->Update(rsState->perSampleShading);
 
   if (!isRelocatableShader) {
-    hasher->Update(rsState->innerCoverage);
+    // Inner coverage only selects PA_SC_AA_CONFIG.COVERAGE_TO_SHADER_SELECT, which is patched into a cached ELF.
+    if (!isCacheHash)
+      hasher->Update(rsState->innerCoverage);
     hasher->Update(rsState->numSamples);
     hasher->Update(rsState->samplePatternIdx);
 
+    // Only whether the depth, stencil or depth bounds tests can reject a fragment affects the compiled pipeline (the Z
+    // order chosen for a fragment shader with resource writes), so hash that rather than the individual depth/stencil
+    // state fields.
+    auto dsState = &pipeline->dsState;
+    bool depthStencilCanFail =
+        dsState->depthBoundsTestEnable ||
+        (dsState->depthTestEnable && dsState->depthCompareOp != VK_COMPARE_OP_ALWAYS) ||
+        (dsState->stencilTestEnable &&
+         (dsState->front.compareOp != VK_COMPARE_OP_ALWAYS || dsState->back.compareOp != VK_COMPARE_OP_ALWAYS));
+    hasher->Update(depthStencilCanFail);
+
     auto cbState = &pipeline->cbState;
     hasher->Update(cbState->alphaToCoverageEnable);
     hasher->Update(cbState->dualSourceBlendEnable);
+    // Color targets at locations the fragment shader never writes do not affect the code.
+    uint64_t usedLocationMask = isCacheHash ? getUsedLocationMask(&pipeline->fs, false) : UINT64_MAX;
     for (unsigned i = 0; i < MaxColorTargets; ++i) {
-      if (cbState->target[i].format != VK_FORMAT_UNDEFINED) {
-        hasher->Update(cbState->target[i].channelWriteMask);
+      if (cbState->target[i].format != VK_FORMAT_UNDEFINED && ((usedLocationMask >> i) & 1) != 0) {
+        // The channel write mask is only programmed by the driver (CB_TARGET_MASK) and never affects the code.
+        if (!isCacheHash)
+          hasher->Update(cbState->target[i].channelWriteMask);
         hasher->Update(cbState->target[i].blendEnable);
         hasher->Update(cbState->target[i].blendSrcAlphaToColor);
         hasher->Update(cbState->target[i].format);
@@ -81,8 +81,10 @@ public:
   static void updateHashForResourceMappingInfo(const ResourceMappingData *pResourceMapping, MetroHash64 *hasher,
                                                ShaderStage stage = ShaderStageInvalid);
 
+  static uint64_t getUsedLocationMask(const PipelineShaderInfo *shaderInfo, bool isInput);
+
   static void updateHashForVertexInputState(const VkPipelineVertexInputStateCreateInfo *vertexInput,
-                                            bool dynamicVertexStride, MetroHash64 *hasher);
+                                            bool dynamicVertexStride, uint64_t usedLocationMask, MetroHash64 *hasher);
 
   // Update hash for map object
   template <class MapType> static void updateHashForMap(MapType &m, MetroHash64 *hasher) {
@@ -96,8 +98,8 @@ public:
   static void updateHashForNonFragmentState(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
                                             MetroHash64 *hasher, bool isRelocatableShader);
 
-  static void updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, MetroHash64 *hasher,
-                                         bool isRelocatableShader);
+  static void updateHashForFragmentState(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
+                                         MetroHash64 *hasher, bool isRelocatableShader);
 
   static void updateHashForPipelineOptions(const PipelineOptions *options, MetroHash64 *hasher,
                                            bool isRelocatableShader);
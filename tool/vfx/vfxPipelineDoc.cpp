@@ -116,6 +116,12 @@ VfxPipelineStatePtr PipelineDocument::getDocument() {
 
     gfxPipelineInfo->cbState.alphaToCoverageEnable = graphicState.alphaToCoverageEnable != 0;
     gfxPipelineInfo->cbState.dualSourceBlendEnable = graphicState.dualSourceBlendEnable != 0;
+    gfxPipelineInfo->dsState.depthTestEnable = graphicState.depthTestEnable != 0;
+    gfxPipelineInfo->dsState.depthCompareOp = graphicState.depthCompareOp;
+    gfxPipelineInfo->dsState.stencilTestEnable = graphicState.stencilTestEnable != 0;
+    gfxPipelineInfo->dsState.front.compareOp = graphicState.stencilCompareOpFront;
+    gfxPipelineInfo->dsState.back.compareOp = graphicState.stencilCompareOpBack;
+    gfxPipelineInfo->dsState.depthBoundsTestEnable = graphicState.depthBoundsTestEnable != 0;
     for (unsigned i = 0; i < MaxColorTargets; ++i) {
       gfxPipelineInfo->cbState.target[i].format = graphicState.colorBuffer[i].format;
       gfxPipelineInfo->cbState.target[i].channelWriteMask =
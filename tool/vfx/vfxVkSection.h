@@ -426,6 +426,12 @@ public:
     INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, usrClipPlaneMask, MemberTypeInt, false);
     INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, alphaToCoverageEnable, MemberTypeInt, false);
     INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, dualSourceBlendEnable, MemberTypeInt, false);
+    INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, depthTestEnable, MemberTypeInt, false);
+    INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, depthCompareOp, MemberTypeEnum, false);
+    INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, stencilTestEnable, MemberTypeInt, false);
+    INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, stencilCompareOpFront, MemberTypeEnum, false);
+    INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, stencilCompareOpBack, MemberTypeEnum, false);
+    INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, depthBoundsTestEnable, MemberTypeInt, false);
     INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, switchWinding, MemberTypeInt, false);
     INIT_STATE_MEMBER_NAME_TO_ADDR(SectionGraphicsState, enableMultiView, MemberTypeInt, false);
     INIT_MEMBER_NAME_TO_ADDR(SectionGraphicsState, m_options, MemberTypePipelineOption, true);
@@ -451,7 +457,7 @@ public:
 
 private:
   SectionNggState m_nggState;
-  static const unsigned MemberCount = 27;
+  static const unsigned MemberCount = 32;
   static StrToMemberAddr m_addrTable[MemberCount];
   SubState m_state;
   SectionColorBuffer m_colorBuffer[Vkgc::MaxColorTargets]; // Color buffer